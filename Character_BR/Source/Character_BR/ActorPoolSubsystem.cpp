@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ActorPoolSubsystem.h"
+#include "Character_BR.h"
+#include "PoolableActor.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+
+namespace ActorPool
+{
+	static FAutoConsoleCommandWithWorld StatsCommand(
+		TEXT("ActorPool.Stats"),
+		TEXT("Prints hits, misses and high-water marks of every actor pool."),
+		FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+		{
+			if (UActorPoolSubsystem* Pool = World ? World->GetSubsystem<UActorPoolSubsystem>() : nullptr)
+			{
+				Pool->DumpStats();
+			}
+		}));
+}
+
+void UActorPoolSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	ActorsInitializedHandle = FWorldDelegates::OnWorldInitializedActors.AddUObject(this, &UActorPoolSubsystem::OnActorsInitialized);
+}
+
+void UActorPoolSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldInitializedActors.Remove(ActorsInitializedHandle);
+
+	Pools.Reset();
+
+	Super::Deinitialize();
+}
+
+void UActorPoolSubsystem::OnActorsInitialized(const UWorld::FActorsInitializedParams& Params)
+{
+	if (Params.World != GetWorld() || !Params.World->IsGameWorld())
+		return;
+
+	for (const FActorPoolPrewarm& Entry : PrewarmClasses)
+	{
+		if (UClass* ActorClass = Entry.ActorClass.LoadSynchronous())
+		{
+			Prewarm(ActorClass, Entry.Count);
+		}
+	}
+}
+
+AActor* UActorPoolSubsystem::Acquire(TSubclassOf<AActor> ActorClass, const FTransform& Transform, AActor* Owner, APawn* Instigator)
+{
+	if (!ActorClass)
+		return nullptr;
+
+	FActorPool& Pool = Pools.FindOrAdd(ActorClass);
+
+	AActor* Actor = nullptr;
+	while (!Actor && Pool.FreeActors.Num() > 0)
+	{
+		Actor = Pool.FreeActors.Pop(false);
+		if (Actor && Actor->IsPendingKillPending())
+		{
+			Actor = nullptr;
+		}
+	}
+
+	if (Actor)
+	{
+		++Pool.Stats.Hits;
+	}
+	else
+	{
+		++Pool.Stats.Misses;
+		Actor = SpawnPooled(ActorClass);
+		if (!Actor)
+			return nullptr;
+	}
+
+	Pool.Stats.InUse++;
+	Pool.Stats.HighWater = FMath::Max(Pool.Stats.HighWater, Pool.Stats.InUse);
+	Pool.Stats.Free = Pool.FreeActors.Num();
+
+	Actor->SetOwner(Owner);
+	Actor->SetInstigator(Instigator);
+	Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+	Actor->SetActorHiddenInGame(false);
+	Actor->SetActorEnableCollision(Actor->GetClass()->GetDefaultObject<AActor>()->GetActorEnableCollision());
+	Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+
+	if (Actor->Implements<UPoolableActor>())
+	{
+		IPoolableActor::Execute_OnAcquiredFromPool(Actor);
+	}
+
+	return Actor;
+}
+
+void UActorPoolSubsystem::Release(AActor* Actor)
+{
+	if (!Actor || Actor->IsPendingKillPending())
+		return;
+
+	FActorPool& Pool = Pools.FindOrAdd(Actor->GetClass());
+	if (Pool.FreeActors.Contains(Actor))
+		return;
+
+	if (Actor->Implements<UPoolableActor>())
+	{
+		IPoolableActor::Execute_OnReleasedToPool(Actor);
+	}
+
+	Deactivate(Actor);
+
+	Pool.FreeActors.Add(Actor);
+	Pool.Stats.InUse = FMath::Max(Pool.Stats.InUse - 1, 0);
+	Pool.Stats.Free = Pool.FreeActors.Num();
+}
+
+void UActorPoolSubsystem::Prewarm(TSubclassOf<AActor> ActorClass, int32 Count)
+{
+	if (!ActorClass)
+		return;
+
+	FActorPool& Pool = Pools.FindOrAdd(ActorClass);
+
+	while (Pool.FreeActors.Num() < Count)
+	{
+		AActor* Actor = SpawnPooled(ActorClass);
+		if (!Actor)
+			break;
+
+		if (Actor->Implements<UPoolableActor>())
+		{
+			IPoolableActor::Execute_OnReleasedToPool(Actor);
+		}
+
+		Deactivate(Actor);
+		Pool.FreeActors.Add(Actor);
+	}
+
+	Pool.Stats.Free = Pool.FreeActors.Num();
+}
+
+FActorPoolStats UActorPoolSubsystem::GetStats(TSubclassOf<AActor> ActorClass) const
+{
+	const FActorPool* Pool = Pools.Find(ActorClass);
+	return Pool ? Pool->Stats : FActorPoolStats();
+}
+
+void UActorPoolSubsystem::DumpStats() const
+{
+	for (const TPair<UClass*, FActorPool>& Pair : Pools)
+	{
+		const FActorPoolStats& Stats = Pair.Value.Stats;
+		UE_LOG(LogCharacterBR, Log, TEXT("%s: hits %d, misses %d, in use %d, high-water %d, free %d"),
+			*GetNameSafe(Pair.Key), Stats.Hits, Stats.Misses, Stats.InUse, Stats.HighWater, Stats.Free);
+	}
+}
+
+AActor* UActorPoolSubsystem::SpawnPooled(UClass* ActorClass)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	return GetWorld()->SpawnActor<AActor>(ActorClass, FTransform::Identity, SpawnParams);
+}
+
+void UActorPoolSubsystem::Deactivate(AActor* Actor)
+{
+	Actor->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+	Actor->SetOwner(nullptr);
+}
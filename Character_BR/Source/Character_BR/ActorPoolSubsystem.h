@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/World.h"
+#include "ActorPoolSubsystem.generated.h"
+
+USTRUCT()
+struct FActorPoolPrewarm
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Config)
+	TSoftClassPtr<AActor> ActorClass;
+
+	UPROPERTY(Config)
+	int32 Count = 0;
+};
+
+USTRUCT(BlueprintType)
+struct FActorPoolStats
+{
+	GENERATED_BODY()
+
+	/** Acquires served from the pool */
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 Hits = 0;
+
+	/** Acquires that had to spawn a new actor */
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 Misses = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 InUse = 0;
+
+	/** Most actors of the class in use at the same time */
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 HighWater = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pool")
+	int32 Free = 0;
+};
+
+USTRUCT()
+struct FActorPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TArray<AActor*> FreeActors;
+
+	FActorPoolStats Stats;
+};
+
+/**
+ * Reuses actors of the same class instead of spawning and destroying them,
+ * for pickups, casings, clips and bullet holes.
+ * Classes listed in [/Script/Character_BR.ActorPoolSubsystem] of DefaultGame.ini are prewarmed
+ * once the world has initialized its actors. Use ActorPool.Stats to print the counters.
+ */
+UCLASS(Config = Game)
+class CHARACTER_BR_API UActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	/** Takes a free actor of the class, or spawns one when the pool is empty */
+	UFUNCTION(BlueprintCallable, Category = "Pool", meta = (DeterminesOutputType = "ActorClass"))
+	AActor* Acquire(TSubclassOf<AActor> ActorClass, const FTransform& Transform, AActor* Owner = nullptr, APawn* Instigator = nullptr);
+
+	template<class T>
+	T* Acquire(TSubclassOf<T> ActorClass, const FTransform& Transform, AActor* Owner = nullptr, APawn* Instigator = nullptr)
+	{
+		return Cast<T>(Acquire(TSubclassOf<AActor>(*ActorClass), Transform, Owner, Instigator));
+	}
+
+	/** Hides the actor and keeps it for the next Acquire of its class */
+	UFUNCTION(BlueprintCallable, Category = "Pool")
+	void Release(AActor* Actor);
+
+	/** Spawns actors of the class until Count are free */
+	UFUNCTION(BlueprintCallable, Category = "Pool")
+	void Prewarm(TSubclassOf<AActor> ActorClass, int32 Count);
+
+	UFUNCTION(BlueprintCallable, Category = "Pool")
+	FActorPoolStats GetStats(TSubclassOf<AActor> ActorClass) const;
+
+	void DumpStats() const;
+
+protected:
+
+	UPROPERTY(Config)
+	TArray<FActorPoolPrewarm> PrewarmClasses;
+
+private:
+
+	void OnActorsInitialized(const UWorld::FActorsInitializedParams& Params);
+
+	AActor* SpawnPooled(UClass* ActorClass);
+
+	void Deactivate(AActor* Actor);
+
+	UPROPERTY(Transient)
+	TMap<UClass*, FActorPool> Pools;
+
+	FDelegateHandle ActorsInitializedHandle;
+};
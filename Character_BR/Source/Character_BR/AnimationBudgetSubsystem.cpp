@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AnimationBudgetSubsystem.h"
+#include "IAnimationBudgetAllocator.h"
+#include "AnimationBudgetAllocatorParameters.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/PlayerController.h"
+
+UAnimationBudgetSubsystem::UAnimationBudgetSubsystem()
+{
+	BudgetMs = 2.f;
+	MinQuality = 0.f;
+	MaxTickRate = 10;
+	MaxTickedOffscreenComponents = 4;
+	SignificanceDistance = 8000.f;
+	OffscreenSignificanceScale = 0.1f;
+}
+
+void UAnimationBudgetSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	ActorsInitializedHandle = FWorldDelegates::OnWorldInitializedActors.AddUObject(this, &UAnimationBudgetSubsystem::OnActorsInitialized);
+
+	if (!USkeletalMeshComponentBudgeted::OnCalculateSignificance().IsBound())
+	{
+		USkeletalMeshComponentBudgeted::OnCalculateSignificance().BindStatic(&UAnimationBudgetSubsystem::CalculateSignificance);
+	}
+}
+
+void UAnimationBudgetSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldInitializedActors.Remove(ActorsInitializedHandle);
+
+	Super::Deinitialize();
+}
+
+void UAnimationBudgetSubsystem::OnActorsInitialized(const UWorld::FActorsInitializedParams& Params)
+{
+	if (Params.World != GetWorld() || !Params.World->IsGameWorld())
+		return;
+
+	IAnimationBudgetAllocator* Allocator = IAnimationBudgetAllocator::Get(Params.World);
+	if (!Allocator)
+		return;
+
+	FAnimationBudgetAllocatorParameters Parameters;
+	Parameters.BudgetInMs = BudgetMs;
+	Parameters.MinQuality = MinQuality;
+	Parameters.MaxTickRate = MaxTickRate;
+	Parameters.MaxTickedOffsreenComponents = MaxTickedOffscreenComponents;
+
+	Allocator->SetParameters(Parameters);
+
+	//No local views on a dedicated server, every character keeps its full rate there
+	Allocator->SetEnabled(Params.World->GetNetMode() != NM_DedicatedServer);
+}
+
+void UAnimationBudgetSubsystem::ConfigureCharacterMesh(ACharacter* Character)
+{
+	USkeletalMeshComponent* Mesh = Character->GetMesh();
+
+	//The server needs the pose of every character for hitboxes and root motion, listen servers included
+	if (Character->HasAuthority())
+	{
+		Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+
+		//Nor may the budget skip the ticks of the characters it doesn't see
+		USkeletalMeshComponentBudgeted* BudgetedMesh = Cast<USkeletalMeshComponentBudgeted>(Mesh);
+		IAnimationBudgetAllocator* Allocator = IAnimationBudgetAllocator::Get(Character->GetWorld());
+		if (BudgetedMesh && Allocator && !Character->IsLocallyControlled())
+		{
+			Allocator->SetComponentSignificance(BudgetedMesh, 1.f, true, true);
+		}
+	}
+	else
+	{
+		//Off-screen characters of other players don't evaluate montages or move their physics bodies
+		Mesh->VisibilityBasedAnimTickOption = Character->IsLocallyControlled()
+			? EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones
+			: EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+	}
+
+	Mesh->bSkipKinematicUpdateWhenInterpolating = true;
+	Mesh->bSkipBoundsUpdateWhenInterpolating = true;
+}
+
+float UAnimationBudgetSubsystem::CalculateSignificance(USkeletalMeshComponentBudgeted* Component)
+{
+	UWorld* World = Component->GetWorld();
+	const UAnimationBudgetSubsystem* Budget = World ? World->GetSubsystem<UAnimationBudgetSubsystem>() : nullptr;
+	if (!Budget)
+		return 1.f;
+
+	//A carried weapon follows the mesh of the character holding it
+	const USceneComponent* Reference = Component;
+	const APawn* Pawn = Cast<APawn>(Component->GetOwner());
+	if (!Pawn && Component->GetOwner())
+	{
+		Pawn = Cast<APawn>(Component->GetOwner()->GetOwner());
+		if (const ACharacter* Character = Cast<ACharacter>(Pawn))
+		{
+			Reference = Character->GetMesh();
+		}
+	}
+
+	if (Pawn && Pawn->IsLocallyControlled())
+		return 1.f;
+
+	const FVector Location = Reference->GetComponentLocation();
+
+	float NearestSquared = MAX_flt;
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (!PlayerController || !PlayerController->IsLocalController())
+			continue;
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+		NearestSquared = FMath::Min(NearestSquared, FVector::DistSquared(ViewLocation, Location));
+	}
+
+	float Significance = 1.f - FMath::Clamp(FMath::Sqrt(NearestSquared) / Budget->SignificanceDistance, 0.f, 1.f);
+
+	const UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(Reference);
+	if (Primitive && !Primitive->WasRecentlyRendered(0.2f))
+	{
+		Significance *= Budget->OffscreenSignificanceScale;
+	}
+
+	return Significance;
+}
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/World.h"
+#include "AnimationBudgetSubsystem.generated.h"
+
+class USkeletalMeshComponentBudgeted;
+
+/**
+ * Caps the time spent on character and weapon animation each frame with the animation budget allocator.
+ * Meshes near a local view tick at full rate, farther or off-screen ones tick less often and interpolate in between,
+ * and a weapon takes the significance of the character carrying it so both update together.
+ * a.Budget.Debug.Enabled draws the tick rate of every budgeted mesh.
+ */
+UCLASS(Config = Game)
+class CHARACTER_BR_API UAnimationBudgetSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UAnimationBudgetSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	/** Sets how a character mesh ticks off-screen, call when the pawn's controller changes */
+	static void ConfigureCharacterMesh(class ACharacter* Character);
+
+protected:
+
+	/** Animation time allowed per frame (ms) */
+	UPROPERTY(Config)
+	float BudgetMs;
+
+	/** Lowest significance that is still updated every frame */
+	UPROPERTY(Config)
+	float MinQuality;
+
+	/** Most frames a mesh may skip */
+	UPROPERTY(Config)
+	int32 MaxTickRate;
+
+	UPROPERTY(Config)
+	int32 MaxTickedOffscreenComponents;
+
+	/** Meshes this far from every local view get the lowest significance */
+	UPROPERTY(Config)
+	float SignificanceDistance;
+
+	/** Significance is scaled by this while the mesh is off-screen */
+	UPROPERTY(Config)
+	float OffscreenSignificanceScale;
+
+private:
+
+	void OnActorsInitialized(const UWorld::FActorsInitializedParams& Params);
+
+	static float CalculateSignificance(USkeletalMeshComponentBudgeted* Component);
+
+	FDelegateHandle ActorsInitializedHandle;
+};
@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BotLoadTestGameMode.h"
+#include "Character_BR.h"
+#include "CharacterBRReplicationGraph.h"
+#include "PlayerBotController.h"
+#include "PlayerCharacter.h"
+#include "Weapon.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+ABotLoadTestGameMode::ABotLoadTestGameMode()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	BotControllerClass = APlayerBotController::StaticClass();
+	BotCount = 100;
+	Spacing = 300.f;
+	Seed = 1;
+	ReportInterval = 5.f;
+	SoakSeconds = 0.f;
+
+	Frames = 0;
+	TickMsSum = 0.0;
+	TickMsMax = 0.f;
+	NetMsSum = 0.0;
+	NetMsMax = 0.f;
+	NextReportTime = 0.0;
+	SoakEndTime = 0.0;
+}
+
+void ABotLoadTestGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	BotCount = FMath::Max(UGameplayStatics::GetIntOption(Options, TEXT("Bots"), BotCount), 0);
+	Seed = UGameplayStatics::GetIntOption(Options, TEXT("Seed"), Seed);
+	SoakSeconds = FMath::Max((float)UGameplayStatics::GetIntOption(Options, TEXT("Soak"), (int32)SoakSeconds), 0.f);
+
+	if (UGameplayStatics::HasOption(Options, TEXT("Behavior")))
+	{
+		Behavior = *UGameplayStatics::ParseOption(Options, TEXT("Behavior"));
+	}
+
+	OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("BotLoadTest_%d.csv"), BotCount);
+}
+
+void ABotLoadTestGameMode::StartPlay()
+{
+	Super::StartPlay();
+
+	SpawnBots();
+
+	FFileHelper::SaveStringToFile(TEXT("Time,Bots,Connections,TickMsAvg,TickMsMax,TickMsPerBot,NetMsAvg,NetMsMax,OutKBps,InKBps,OutBytesPerBot,OutBytesPerConnAvg,OutBytesPerConnMax,UsedMemoryMB,MemoryKBPerBot\n"), *OutputPath);
+	NextReportTime = FPlatformTime::Seconds() + ReportInterval;
+	SoakEndTime = SoakSeconds > 0.f ? FPlatformTime::Seconds() + SoakSeconds : 0.0;
+}
+
+void ABotLoadTestGameMode::SpawnBots()
+{
+	UClass* LoadedCharacterClass = BotCharacterClass.LoadSynchronous();
+	UClass* LoadedControllerClass = BotControllerClass.LoadSynchronous();
+	UClass* LoadedWeaponClass = WeaponClass.LoadSynchronous();
+	if (!LoadedCharacterClass || !LoadedControllerClass)
+	{
+		UE_LOG(LogCharacterBR, Error, TEXT("Bot load test has no BotCharacterClass or BotControllerClass"));
+		return;
+	}
+
+	const AActor* Start = FindPlayerStart(nullptr);
+	const FVector Origin = Start ? Start->GetActorLocation() : FVector::ZeroVector;
+	const int32 Columns = FMath::CeilToInt(FMath::Sqrt((float)BotCount));
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	Bots.Reserve(BotCount);
+	for (int32 Index = 0; Index < BotCount; ++Index)
+	{
+		const FVector Location = Origin + FVector((Index / Columns) * Spacing, (Index % Columns) * Spacing, 0.f);
+
+		APlayerCharacter* Character = GetWorld()->SpawnActor<APlayerCharacter>(LoadedCharacterClass, Location, FRotator::ZeroRotator, SpawnParams);
+		APlayerBotController* Bot = Character ? GetWorld()->SpawnActor<APlayerBotController>(LoadedControllerClass, Location, FRotator::ZeroRotator, SpawnParams) : nullptr;
+		if (!Bot)
+			continue;
+
+		Bot->InitBot(Seed + Index, Behavior.IsNone() ? INDEX_NONE : Bot->FindBehavior(Behavior));
+		Bot->Possess(Character);
+		Bots.Add(Bot);
+
+		if (LoadedWeaponClass)
+		{
+			GetWorld()->SpawnActor<AWeapon>(LoadedWeaponClass, Location, FRotator::ZeroRotator, SpawnParams);
+		}
+	}
+
+	UE_LOG(LogCharacterBR, Log, TEXT("Bot load test spawned %d bots"), Bots.Num());
+}
+
+void ABotLoadTestGameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	//Game thread time of the previous frame, the server's tick cost
+	const float TickMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+	TickMsSum += TickMs;
+	TickMsMax = FMath::Max(TickMsMax, TickMs);
+	++Frames;
+
+	//Replication of the previous frame, the net driver flushes after the world ticked
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	const UCharacterBRReplicationGraph* ReplicationGraph = NetDriver ? Cast<UCharacterBRReplicationGraph>(NetDriver->GetReplicationDriver()) : nullptr;
+	const float NetMs = ReplicationGraph ? ReplicationGraph->LastReplicateMs : 0.f;
+	NetMsSum += NetMs;
+	NetMsMax = FMath::Max(NetMsMax, NetMs);
+
+	if (SoakEndTime > 0.0 && FPlatformTime::Seconds() >= SoakEndTime)
+	{
+		Report();
+		UE_LOG(LogCharacterBR, Log, TEXT("Bot load test soak finished after %.0fs"), SoakSeconds);
+		FPlatformMisc::RequestExit(false);
+		SoakEndTime = 0.0;
+	}
+	else if (FPlatformTime::Seconds() >= NextReportTime)
+	{
+		Report();
+		NextReportTime = FPlatformTime::Seconds() + ReportInterval;
+	}
+}
+
+void ABotLoadTestGameMode::Report()
+{
+	const int32 BotNum = FMath::Max(Bots.Num(), 1);
+	const float TickMsAvg = Frames > 0 ? TickMsSum / Frames : 0.f;
+	const float NetMsAvg = Frames > 0 ? NetMsSum / Frames : 0.f;
+
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	const int32 Connections = NetDriver ? NetDriver->ClientConnections.Num() : 0;
+	const uint32 OutBytesPerSecond = NetDriver ? NetDriver->OutBytesPerSecond : 0;
+	const uint32 InBytesPerSecond = NetDriver ? NetDriver->InBytesPerSecond : 0;
+
+	int32 ConnectionOutMax = 0;
+	if (NetDriver)
+	{
+		for (const UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			ConnectionOutMax = FMath::Max(ConnectionOutMax, Connection ? Connection->OutBytesPerSecond : 0);
+		}
+	}
+	const uint32 ConnectionOutAvg = Connections > 0 ? OutBytesPerSecond / Connections : 0;
+
+	const float UsedMemoryMB = FPlatformMemory::GetStats().UsedPhysical / (1024.f * 1024.f);
+
+	UE_LOG(LogCharacterBR, Log, TEXT("Bot load test: %d bots, %d connections, tick %.2fms avg %.2fms max (%.3fms/bot), net %.2fms avg %.2fms max, out %.1fKB/s (%uB/s/bot, %uB/s/connection avg %dB/s max), in %.1fKB/s, memory %.0fMB (%.0fKB/bot)"),
+		Bots.Num(), Connections, TickMsAvg, TickMsMax, TickMsAvg / BotNum, NetMsAvg, NetMsMax,
+		OutBytesPerSecond / 1024.f, OutBytesPerSecond / BotNum, ConnectionOutAvg, ConnectionOutMax, InBytesPerSecond / 1024.f,
+		UsedMemoryMB, UsedMemoryMB * 1024.f / BotNum);
+
+	const FString Line = FString::Printf(TEXT("%.1f,%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.2f,%.2f,%u,%u,%d,%.2f,%.2f\n"),
+		GetWorld()->GetTimeSeconds(), Bots.Num(), Connections, TickMsAvg, TickMsMax, TickMsAvg / BotNum, NetMsAvg, NetMsMax,
+		OutBytesPerSecond / 1024.f, InBytesPerSecond / 1024.f, OutBytesPerSecond / BotNum, ConnectionOutAvg, ConnectionOutMax,
+		UsedMemoryMB, UsedMemoryMB * 1024.f / BotNum);
+	FFileHelper::SaveStringToFile(Line, *OutputPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	Frames = 0;
+	TickMsSum = 0.0;
+	TickMsMax = 0.f;
+	NetMsSum = 0.0;
+	NetMsMax = 0.f;
+}
@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameModeBase.h"
+#include "BotLoadTestGameMode.generated.h"
+
+class APlayerCharacter;
+class APlayerBotController;
+class AWeapon;
+
+/**
+ * Fills a server with bot-driven player characters and reports its cost every ReportInterval seconds,
+ * to the log and to Saved/Benchmarks/BotLoadTest_<Bots>.csv. Bandwidth and net tick time only count connected clients,
+ * so for a soak connect a few local clients and let it run for ?Soak= seconds, e.g.
+ * Character_BRServer ThirdPersonExampleMap?game=/Script/Character_BR.BotLoadTestGameMode?Bots=100?Soak=600 -log
+ * Character_BR 127.0.0.1 -game -nullrhi -nosound (once per client)
+ */
+UCLASS(Config = Game)
+class CHARACTER_BR_API ABotLoadTestGameMode : public AGameModeBase
+{
+	GENERATED_BODY()
+
+public:
+
+	ABotLoadTestGameMode();
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+
+	virtual void StartPlay() override;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+protected:
+
+	UPROPERTY(Config)
+	TSoftClassPtr<APlayerCharacter> BotCharacterClass;
+
+	UPROPERTY(Config)
+	TSoftClassPtr<APlayerBotController> BotControllerClass;
+
+	/** Dropped at every bot's feet for it to pick up and fire, bots stay unarmed when empty */
+	UPROPERTY(Config)
+	TSoftClassPtr<AWeapon> WeaponClass;
+
+	/** Overridden by ?Bots= */
+	UPROPERTY(Config)
+	int32 BotCount;
+
+	UPROPERTY(Config)
+	float Spacing;
+
+	/** Seed of the first bot, overridden by ?Seed= */
+	UPROPERTY(Config)
+	int32 Seed;
+
+	/** Every bot uses this behavior when set, overridden by ?Behavior= */
+	UPROPERTY(Config)
+	FName Behavior;
+
+	UPROPERTY(Config)
+	float ReportInterval;
+
+	/** Reports one last time and quits after this many seconds, 0 runs until closed. Overridden by ?Soak= */
+	UPROPERTY(Config)
+	float SoakSeconds;
+
+private:
+
+	void SpawnBots();
+
+	void Report();
+
+	UPROPERTY(Transient)
+	TArray<APlayerBotController*> Bots;
+
+	/** Since the last report */
+	int32 Frames;
+	double TickMsSum;
+	float TickMsMax;
+	double NetMsSum;
+	float NetMsMax;
+	double NextReportTime;
+	double SoakEndTime;
+
+	FString OutputPath;
+};
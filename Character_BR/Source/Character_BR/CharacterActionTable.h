@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Input actions gated by the character's state */
+enum class ECharacterAction : uint8
+{
+	Sprint,
+	Climb,
+	Dodge,
+	Aim,
+	Fire,
+	Reload,
+	Equip,
+	UnEquip,
+	SwitchCamera,
+
+	MAX
+};
+
+/** One bit per condition of the character's state, a combination of them indexes the action table */
+namespace ECharacterCondition
+{
+	enum Type : uint16
+	{
+		Climbing	= 1 << 0,
+		Dodging		= 1 << 1,
+		Swimming	= 1 << 2,
+		Jumping		= 1 << 3,
+		Falling		= 1 << 4,
+		Aiming		= 1 << 5,
+		Firing		= 1 << 6,
+		Reloading	= 1 << 7,
+		Equipping	= 1 << 8,
+		Armed		= 1 << 9,
+
+		NumBits		= 10,
+	};
+}
+
+/**
+ * Compile time table of which actions are allowed in which state.
+ * Every action lists the conditions that block it; the table expands them for every combination
+ * of conditions so a check is a single lookup and mask.
+ */
+namespace CharacterActionTable
+{
+	constexpr uint32 NumStates = 1 << ECharacterCondition::NumBits;
+	constexpr uint32 NumActions = (uint32)ECharacterAction::MAX;
+
+	constexpr uint16 NotCommon = ECharacterCondition::Climbing | ECharacterCondition::Dodging | ECharacterCondition::Swimming;
+
+	/** Conditions that block each action, in ECharacterAction order */
+	constexpr uint16 BlockedBy[NumActions] =
+	{
+		/* Sprint */		NotCommon | ECharacterCondition::Aiming,
+		/* Climb */			NotCommon | ECharacterCondition::Armed,
+		/* Dodge */			NotCommon | ECharacterCondition::Falling | ECharacterCondition::Reloading,
+		/* Aim */			NotCommon | ECharacterCondition::Reloading | ECharacterCondition::Equipping,
+		/* Fire */			ECharacterCondition::Reloading,
+		/* Reload */		ECharacterCondition::Climbing | ECharacterCondition::Dodging | ECharacterCondition::Jumping | ECharacterCondition::Falling | ECharacterCondition::Reloading,
+		/* Equip */			NotCommon | ECharacterCondition::Aiming | ECharacterCondition::Jumping | ECharacterCondition::Reloading | ECharacterCondition::Equipping,
+		/* UnEquip */		NotCommon | ECharacterCondition::Aiming | ECharacterCondition::Jumping | ECharacterCondition::Reloading | ECharacterCondition::Equipping,
+		/* SwitchCamera */	ECharacterCondition::Aiming | ECharacterCondition::Firing,
+	};
+
+	struct FTable
+	{
+		/** Allowed action bits for each state */
+		uint16 Allowed[NumStates];
+
+		constexpr FTable() : Allowed()
+		{
+			for (uint32 State = 0; State < NumStates; ++State)
+			{
+				uint16 Mask = 0;
+				for (uint32 Action = 0; Action < NumActions; ++Action)
+				{
+					Mask |= ((State & BlockedBy[Action]) == 0 ? 1 : 0) << Action;
+				}
+				Allowed[State] = Mask;
+			}
+		}
+	};
+
+	constexpr FTable Table;
+
+	constexpr bool CanPerform(uint16 State, ECharacterAction Action)
+	{
+		return (Table.Allowed[State & (NumStates - 1)] >> (uint32)Action) & 1;
+	}
+
+	static_assert(NumActions <= 16, "Allowed action masks are 16 bits");
+	static_assert(CanPerform(0, ECharacterAction::Equip), "Everything is allowed while idle");
+	static_assert(!CanPerform(ECharacterCondition::Reloading, ECharacterAction::Fire), "No firing while reloading");
+	static_assert(!CanPerform(ECharacterCondition::Armed, ECharacterAction::Climb), "Armed characters can't climb");
+	static_assert(CanPerform(ECharacterCondition::Swimming, ECharacterAction::Reload), "Reloading is allowed while swimming");
+	static_assert(!CanPerform(ECharacterCondition::Climbing, ECharacterAction::Reload), "Reloading is not allowed while climbing");
+	static_assert(!CanPerform(ECharacterCondition::Falling, ECharacterAction::Reload), "Reloading is not allowed in the air");
+	static_assert(!CanPerform(ECharacterCondition::Aiming | ECharacterCondition::Firing, ECharacterAction::SwitchCamera), "Camera stays while aiming or firing");
+}
@@ -0,0 +1,214 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CharacterBRReplicationGraph.h"
+#include "PlayerCharacter.h"
+#include "Weapon.h"
+#include "Engine/LevelScriptActor.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
+#include "ReplicationGraphTypes.h"
+
+UCharacterBRReplicationGraph::UCharacterBRReplicationGraph()
+{
+	CellSize = 10000.f;
+	SpatialBias = 150000.f;
+
+	GridNode = nullptr;
+	AlwaysRelevantNode = nullptr;
+
+	LastReplicateMs = 0.f;
+}
+
+int32 UCharacterBRReplicationGraph::ServerReplicateActors(float DeltaSeconds)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 Replicated = Super::ServerReplicateActors(DeltaSeconds);
+	LastReplicateMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	return Replicated;
+}
+
+void UCharacterBRReplicationGraph::BeginDestroy()
+{
+	AWeapon::OnWeaponOwnerChanged.Remove(WeaponOwnerChangedHandle);
+
+	Super::BeginDestroy();
+}
+
+void UCharacterBRReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	WeaponOwnerChangedHandle = AWeapon::OnWeaponOwnerChanged.AddUObject(this, &UCharacterBRReplicationGraph::OnWeaponOwnerChanged);
+
+	ClassRepNodePolicies.Set(AActor::StaticClass(), EClassRepNodeMapping::Spatialize_Static);
+	ClassRepNodePolicies.Set(AInfo::StaticClass(), EClassRepNodeMapping::RelevantAllConnections);
+	ClassRepNodePolicies.Set(AGameStateBase::StaticClass(), EClassRepNodeMapping::RelevantAllConnections);
+	ClassRepNodePolicies.Set(APlayerState::StaticClass(), EClassRepNodeMapping::RelevantAllConnections);
+	ClassRepNodePolicies.Set(ALevelScriptActor::StaticClass(), EClassRepNodeMapping::NotRouted);
+	ClassRepNodePolicies.Set(APawn::StaticClass(), EClassRepNodeMapping::Spatialize_Dynamic);
+	ClassRepNodePolicies.Set(APlayerCharacter::StaticClass(), EClassRepNodeMapping::Spatialize_Dynamic);
+	ClassRepNodePolicies.Set(AWeapon::StaticClass(), EClassRepNodeMapping::Spatialize_Dormancy);
+
+	FClassReplicationInfo ActorInfo;
+	InitClassInfo(AActor::StaticClass(), ActorInfo);
+	GlobalActorReplicationInfoMap.SetClassInfo(AActor::StaticClass(), ActorInfo);
+
+	FClassReplicationInfo CharacterInfo;
+	InitClassInfo(APlayerCharacter::StaticClass(), CharacterInfo);
+	GlobalActorReplicationInfoMap.SetClassInfo(APlayerCharacter::StaticClass(), CharacterInfo);
+
+	FClassReplicationInfo WeaponInfo;
+	InitClassInfo(AWeapon::StaticClass(), WeaponInfo);
+	GlobalActorReplicationInfoMap.SetClassInfo(AWeapon::StaticClass(), WeaponInfo);
+}
+
+void UCharacterBRReplicationGraph::InitClassInfo(UClass* Class, FClassReplicationInfo& Info) const
+{
+	const AActor* CDO = Class->GetDefaultObject<AActor>();
+
+	Info.ReplicationPeriodFrame = FMath::Max<uint32>((uint32)FMath::RoundToFloat(NetDriver->NetServerMaxTickRate / FMath::Max(CDO->NetUpdateFrequency, 1.f)), 1);
+	Info.SetCullDistanceSquared(CDO->NetCullDistanceSquared);
+	Info.DistancePriorityScale = 1.f;
+}
+
+void UCharacterBRReplicationGraph::InitGlobalGraphNodes()
+{
+	Super::InitGlobalGraphNodes();
+
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = CellSize;
+	GridNode->SpatialBias = FVector2D(-SpatialBias, -SpatialBias);
+
+	//Moving actors go through a dynamic frequency node, which sends far ones less often
+	GridNode->CreateCellNodeOverride = [](UReplicationGraphNode_GridSpatialization2D* Parent)
+	{
+		UReplicationGraphNode_GridCell* Cell = Parent->CreateChildNode<UReplicationGraphNode_GridCell>();
+		Cell->CreateDynamicNodeOverride = [](UReplicationGraphNode_GridCell* InCell) -> UReplicationGraphNode*
+		{
+			return InCell->CreateChildNode<UReplicationGraphNode_DynamicSpatialFrequency>();
+		};
+		return Cell;
+	};
+
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UCharacterBRReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	//Viewer and view target of the connection, and its owner-only actors
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* ConnectionNode = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+	AddConnectionGraphNode(ConnectionNode, RepGraphConnection);
+}
+
+EClassRepNodeMapping UCharacterBRReplicationGraph::GetMappingPolicy(const AActor* Actor) const
+{
+	//Equipped weapons replicate with their owner
+	if (const AWeapon* Weapon = Cast<AWeapon>(Actor))
+	{
+		return Weapon->GetOwner() ? EClassRepNodeMapping::NotRouted : EClassRepNodeMapping::Spatialize_Dormancy;
+	}
+
+	if (Actor->bAlwaysRelevant)
+		return EClassRepNodeMapping::RelevantAllConnections;
+
+	if (Actor->bOnlyRelevantToOwner)
+		return EClassRepNodeMapping::NotRouted;
+
+	const EClassRepNodeMapping* Policy = ClassRepNodePolicies.Get(Actor->GetClass());
+	return Policy ? *Policy : EClassRepNodeMapping::Spatialize_Static;
+}
+
+void UCharacterBRReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	switch (GetMappingPolicy(ActorInfo.Actor))
+	{
+	case EClassRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+	case EClassRepNodeMapping::Spatialize_Static:
+		GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+		break;
+	case EClassRepNodeMapping::Spatialize_Dynamic:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+	case EClassRepNodeMapping::Spatialize_Dormancy:
+		GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+		break;
+	default:
+		break;
+	}
+
+	if (ActorInfo.Actor->IsA<AWeapon>() && ActorInfo.Actor->GetOwner())
+	{
+		AddDependentActor(ActorInfo.Actor->GetOwner(), ActorInfo.Actor);
+	}
+}
+
+void UCharacterBRReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	switch (GetMappingPolicy(ActorInfo.Actor))
+	{
+	case EClassRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+	case EClassRepNodeMapping::Spatialize_Static:
+		GridNode->RemoveActor_Static(ActorInfo);
+		break;
+	case EClassRepNodeMapping::Spatialize_Dynamic:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+	case EClassRepNodeMapping::Spatialize_Dormancy:
+		GridNode->RemoveActor_Dormancy(ActorInfo);
+		break;
+	default:
+		break;
+	}
+
+	if (ActorInfo.Actor->IsA<AWeapon>() && ActorInfo.Actor->GetOwner())
+	{
+		RemoveDependentActor(ActorInfo.Actor->GetOwner(), ActorInfo.Actor);
+	}
+}
+
+void UCharacterBRReplicationGraph::OnWeaponOwnerChanged(AWeapon* Weapon, AActor* OldOwner, AActor* NewOwner)
+{
+	if (!Weapon || !Weapon->GetIsReplicated() || Weapon->GetWorld() != GetWorld() || !GlobalActorReplicationInfoMap.Find(Weapon))
+		return;
+
+	const FNewReplicatedActorInfo ActorInfo(Weapon);
+
+	if (OldOwner)
+		RemoveDependentActor(OldOwner, Weapon);
+	else
+		GridNode->RemoveActor_Dormancy(ActorInfo);
+
+	if (NewOwner)
+		AddDependentActor(NewOwner, Weapon);
+	else
+		GridNode->AddActor_Dormancy(ActorInfo, GlobalActorReplicationInfoMap.Get(Weapon));
+}
+
+void UCharacterBRReplicationGraph::AddDependentActor(AActor* Parent, AActor* Child)
+{
+	FGlobalActorReplicationInfo& ParentInfo = GlobalActorReplicationInfoMap.Get(Parent);
+	ParentInfo.DependentActorList.PrepareForWrite();
+	if (!ParentInfo.DependentActorList.Contains(Child))
+	{
+		ParentInfo.DependentActorList.Add(Child);
+	}
+}
+
+void UCharacterBRReplicationGraph::RemoveDependentActor(AActor* Parent, AActor* Child)
+{
+	if (FGlobalActorReplicationInfo* ParentInfo = GlobalActorReplicationInfoMap.Find(Parent))
+	{
+		ParentInfo->DependentActorList.PrepareForWrite();
+		ParentInfo->DependentActorList.Remove(Child);
+	}
+}
@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "CharacterBRReplicationGraph.generated.h"
+
+class AWeapon;
+
+enum class EClassRepNodeMapping : uint8
+{
+	NotRouted,				// Not added to any node, replicated through its owner or the connection's own node
+	RelevantAllConnections,	// Sent to every connection
+	Spatialize_Static,		// In the grid, never moves
+	Spatialize_Dynamic,		// In the grid, moves every frame
+	Spatialize_Dormancy,	// In the grid, moves only while awake
+};
+
+/**
+ * Replication graph for 100 player matches.
+ * Characters and pickups are bucketed into a 2D grid so each connection only gathers the cells around its viewer,
+ * and moving actors in far away parts of a cell are replicated less often.
+ * Ground weapons stay dormant until someone picks them up; equipped weapons leave the grid
+ * and replicate as dependents of the character holding them.
+ */
+UCLASS(Transient, Config = Engine)
+class CHARACTER_BR_API UCharacterBRReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+
+	UCharacterBRReplicationGraph();
+
+	virtual void BeginDestroy() override;
+
+	virtual void InitGlobalActorClassSettings() override;
+
+	virtual void InitGlobalGraphNodes() override;
+
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+
+	/** Time the last net tick spent gathering and sending actors, read by the load test */
+	float LastReplicateMs;
+
+	/** Size of a grid cell (cm) */
+	UPROPERTY(Config)
+	float CellSize;
+
+	/** Actors outside this box are all put in the border cells */
+	UPROPERTY(Config)
+	float SpatialBias;
+
+	UPROPERTY()
+	UReplicationGraphNode_GridSpatialization2D* GridNode;
+
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* AlwaysRelevantNode;
+
+private:
+
+	EClassRepNodeMapping GetMappingPolicy(const AActor* Actor) const;
+
+	void InitClassInfo(UClass* Class, FClassReplicationInfo& Info) const;
+
+	void OnWeaponOwnerChanged(AWeapon* Weapon, AActor* OldOwner, AActor* NewOwner);
+
+	void AddDependentActor(AActor* Parent, AActor* Child);
+
+	void RemoveDependentActor(AActor* Parent, AActor* Child);
+
+	TClassMap<EClassRepNodeMapping> ClassRepNodePolicies;
+
+	FDelegateHandle WeaponOwnerChangedHandle;
+};
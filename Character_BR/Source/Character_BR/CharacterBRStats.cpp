@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CharacterBRStats.h"
+#include "Character_BR.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+
+#define CHARACTERBR_DEFINE_TIMED_STATS(Name) \
+	DEFINE_STAT(STAT_CharacterBR_##Name); \
+	DEFINE_STAT(STAT_CharacterBR_##Name##Calls);
+#define CHARACTERBR_DEFINE_COUNTED_STATS(Name) \
+	DEFINE_STAT(STAT_CharacterBR_##Name##Calls);
+
+CHARACTERBR_TIMED_PATHS(CHARACTERBR_DEFINE_TIMED_STATS)
+CHARACTERBR_COUNTED_PATHS(CHARACTERBR_DEFINE_COUNTED_STATS)
+
+CSV_DEFINE_CATEGORY(CharacterBR, true);
+
+namespace CharacterBRProfiler
+{
+	constexpr int32 NumPaths = (int32)ECharacterBRPath::MAX;
+
+	struct FFrame
+	{
+		uint64 Cycles[NumPaths];
+		uint32 Calls[NumPaths];
+	};
+
+	/** Ring of finished frames, Current is the one being recorded */
+	FFrame History[FCharacterBRProfiler::HistoryFrames];
+	FFrame Current;
+	int32 NextFrame = 0;
+	int32 RecordedFrames = 0;
+	bool bRegistered = false;
+
+	const TCHAR* PathNames[] =
+	{
+#define CHARACTERBR_PATH_NAME(Name) TEXT(#Name),
+		CHARACTERBR_TIMED_PATHS(CHARACTERBR_PATH_NAME)
+		CHARACTERBR_COUNTED_PATHS(CHARACTERBR_PATH_NAME)
+#undef CHARACTERBR_PATH_NAME
+	};
+	static_assert(UE_ARRAY_COUNT(PathNames) == NumPaths, "Every path needs a name");
+
+	static FAutoConsoleCommand ProfileCommand(
+		TEXT("CharacterBR.Profile"),
+		TEXT("Prints the average and maximum time and calls per frame of every CharacterBR path. Usage: CharacterBR.Profile [Frames=120]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic([](const TArray<FString>& Args)
+		{
+			FCharacterBRProfiler::Dump(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 120);
+		}));
+}
+
+void FCharacterBRProfiler::Add(ECharacterBRPath Path, uint64 Cycles, uint32 Calls)
+{
+	using namespace CharacterBRProfiler;
+
+	if (!IsInGameThread())
+	{
+		return;
+	}
+
+	if (!bRegistered)
+	{
+		bRegistered = true;
+		FMemory::Memzero(Current);
+		FCoreDelegates::OnEndFrame.AddStatic(&FCharacterBRProfiler::EndFrame);
+	}
+
+	Current.Cycles[(int32)Path] += Cycles;
+	Current.Calls[(int32)Path] += Calls;
+}
+
+void FCharacterBRProfiler::EndFrame()
+{
+	using namespace CharacterBRProfiler;
+
+	History[NextFrame] = Current;
+	NextFrame = (NextFrame + 1) % HistoryFrames;
+	RecordedFrames = FMath::Min(RecordedFrames + 1, HistoryFrames);
+	FMemory::Memzero(Current);
+}
+
+void FCharacterBRProfiler::GetLastFrame(ECharacterBRPath Path, float& OutMs, uint32& OutCalls)
+{
+	using namespace CharacterBRProfiler;
+
+	if (RecordedFrames == 0)
+	{
+		OutMs = 0.f;
+		OutCalls = 0;
+		return;
+	}
+
+	const FFrame& Frame = History[(NextFrame + HistoryFrames - 1) % HistoryFrames];
+	OutMs = FPlatformTime::ToMilliseconds64(Frame.Cycles[(int32)Path]);
+	OutCalls = Frame.Calls[(int32)Path];
+}
+
+const TCHAR* FCharacterBRProfiler::GetPathName(ECharacterBRPath Path)
+{
+	return CharacterBRProfiler::PathNames[(int32)Path];
+}
+
+void FCharacterBRProfiler::Dump(int32 FrameCount)
+{
+	using namespace CharacterBRProfiler;
+
+	FrameCount = FMath::Min(FMath::Max(FrameCount, 1), RecordedFrames);
+	if (FrameCount == 0)
+	{
+		UE_LOG(LogCharacterBR, Log, TEXT("CharacterBR.Profile: no frames recorded yet"));
+		return;
+	}
+
+	UE_LOG(LogCharacterBR, Log, TEXT("CharacterBR.Profile over %d frames:"), FrameCount);
+	UE_LOG(LogCharacterBR, Log, TEXT("  %-22s %10s %10s %10s %10s"), TEXT("Path"), TEXT("AvgMs"), TEXT("MaxMs"), TEXT("AvgCalls"), TEXT("MaxCalls"));
+
+	for (int32 Path = 0; Path < NumPaths; ++Path)
+	{
+		uint64 TotalCycles = 0;
+		uint64 MaxCycles = 0;
+		uint64 TotalCalls = 0;
+		uint32 MaxCalls = 0;
+
+		for (int32 i = 1; i <= FrameCount; ++i)
+		{
+			const FFrame& Frame = History[(NextFrame + HistoryFrames - i) % HistoryFrames];
+			TotalCycles += Frame.Cycles[Path];
+			MaxCycles = FMath::Max(MaxCycles, Frame.Cycles[Path]);
+			TotalCalls += Frame.Calls[Path];
+			MaxCalls = FMath::Max(MaxCalls, Frame.Calls[Path]);
+		}
+
+		if (TotalCalls == 0)
+		{
+			continue;
+		}
+
+		UE_LOG(LogCharacterBR, Log, TEXT("  %-22s %10.3f %10.3f %10.1f %10u"),
+			PathNames[Path],
+			FPlatformTime::ToMilliseconds64(TotalCycles) / FrameCount,
+			FPlatformTime::ToMilliseconds64(MaxCycles),
+			(double)TotalCalls / FrameCount,
+			MaxCalls);
+	}
+}
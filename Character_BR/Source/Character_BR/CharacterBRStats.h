@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+/** Gameplay paths with a cycle counter, a call counter, an Insights scope and a CSV timing stat */
+#define CHARACTERBR_TIMED_PATHS(Op) \
+	Op(Fire) \
+	Op(Reload) \
+	Op(AttachWeapon) \
+	Op(TakeItem) \
+	Op(EmitShot) \
+	Op(UpdateHitWeapon) \
+	Op(StatusTick) \
+	Op(ClimbProbeTick) \
+	Op(FocusTargetTick) \
+	Op(LootPresentationTick) \
+	Op(HitscanTick) \
+	Op(RewindHitboxes) \
+	Op(ProjectileTick) \
+	Op(BotTick)
+
+/** Traces and timer manager calls, only counted */
+#define CHARACTERBR_COUNTED_PATHS(Op) \
+	Op(ClimbProbeTrace) \
+	Op(ClimbWallTrace) \
+	Op(FocusTrace) \
+	Op(ShotTrace) \
+	Op(HitboxRewind) \
+	Op(RoundTrace) \
+	Op(MoveCorrection) \
+	Op(TimerSet)
+
+enum class ECharacterBRPath : uint8
+{
+#define CHARACTERBR_PATH_ENUM(Name) Name,
+	CHARACTERBR_TIMED_PATHS(CHARACTERBR_PATH_ENUM)
+	CHARACTERBR_COUNTED_PATHS(CHARACTERBR_PATH_ENUM)
+#undef CHARACTERBR_PATH_ENUM
+
+	MAX
+};
+
+DECLARE_STATS_GROUP(TEXT("CharacterBR"), STATGROUP_CharacterBR, STATCAT_Advanced);
+
+#define CHARACTERBR_DECLARE_TIMED_STATS(Name) \
+	DECLARE_CYCLE_STAT_EXTERN(TEXT(#Name), STAT_CharacterBR_##Name, STATGROUP_CharacterBR, CHARACTER_BR_API); \
+	DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT(#Name " calls"), STAT_CharacterBR_##Name##Calls, STATGROUP_CharacterBR, CHARACTER_BR_API);
+#define CHARACTERBR_DECLARE_COUNTED_STATS(Name) \
+	DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT(#Name " calls"), STAT_CharacterBR_##Name##Calls, STATGROUP_CharacterBR, CHARACTER_BR_API);
+
+CHARACTERBR_TIMED_PATHS(CHARACTERBR_DECLARE_TIMED_STATS)
+CHARACTERBR_COUNTED_PATHS(CHARACTERBR_DECLARE_COUNTED_STATS)
+
+CSV_DECLARE_CATEGORY_EXTERN(CharacterBR);
+
+/**
+ * Keeps the time and calls of every path for the last HistoryFrames frames,
+ * printed by CharacterBR.Profile [Frames]. Game thread only.
+ */
+class CHARACTER_BR_API FCharacterBRProfiler
+{
+public:
+
+	static constexpr int32 HistoryFrames = 600;
+
+	struct FScope
+	{
+		FScope(ECharacterBRPath InPath) : Path(InPath), StartCycles(FPlatformTime::Cycles64()) {}
+
+		~FScope() { Add(Path, FPlatformTime::Cycles64() - StartCycles); }
+
+		ECharacterBRPath Path;
+		uint64 StartCycles;
+	};
+
+	static void Add(ECharacterBRPath Path, uint64 Cycles, uint32 Calls = 1);
+
+	/** Time and calls of the last finished frame */
+	static void GetLastFrame(ECharacterBRPath Path, float& OutMs, uint32& OutCalls);
+
+	static const TCHAR* GetPathName(ECharacterBRPath Path);
+
+	/** Average and maximum per frame over the last FrameCount frames */
+	static void Dump(int32 FrameCount);
+
+private:
+
+	static void EndFrame();
+};
+
+/** Shipping builds keep the stat, trace and CSV macros, which compile out on their own, but drop the profiler */
+#if !UE_BUILD_SHIPPING
+#define CHARACTERBR_PROFILER_SCOPE(Name) FCharacterBRProfiler::FScope CharacterBRScope_##Name(ECharacterBRPath::Name)
+#define CHARACTERBR_PROFILER_ADD(Name, Count) FCharacterBRProfiler::Add(ECharacterBRPath::Name, 0, Count)
+#else
+#define CHARACTERBR_PROFILER_SCOPE(Name)
+#define CHARACTERBR_PROFILER_ADD(Name, Count)
+#endif
+
+/** Times the rest of the scope as Name */
+#define CHARACTERBR_SCOPE(Name) \
+	SCOPE_CYCLE_COUNTER(STAT_CharacterBR_##Name); \
+	INC_DWORD_STAT(STAT_CharacterBR_##Name##Calls); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(CharacterBR_##Name); \
+	CSV_SCOPED_TIMING_STAT(CharacterBR, Name); \
+	CHARACTERBR_PROFILER_SCOPE(Name)
+
+/** Counts Count calls of Name */
+#define CHARACTERBR_COUNT(Name, Count) \
+	INC_DWORD_STAT_BY(STAT_CharacterBR_##Name##Calls, Count); \
+	CHARACTERBR_PROFILER_ADD(Name, Count)
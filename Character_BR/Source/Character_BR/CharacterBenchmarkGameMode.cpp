@@ -0,0 +1,364 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CharacterBenchmarkGameMode.h"
+#include "Character_BR.h"
+#include "PlayerCharacter.h"
+#include "Weapon.h"
+#include "InputRecordingSubsystem.h"
+#include "AIController.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "Kismet/KismetSystemLibrary.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace CharacterBenchmark
+{
+	static FBenchmarkInputStep Action(float Time, const TCHAR* Name, EInputEvent Event)
+	{
+		FBenchmarkInputStep Step;
+		Step.Time = Time;
+		Step.Name = Name;
+		Step.Event = Event;
+		return Step;
+	}
+
+	static FBenchmarkInputStep Axis(float Time, const TCHAR* Name, float Value)
+	{
+		FBenchmarkInputStep Step;
+		Step.Time = Time;
+		Step.Name = Name;
+		Step.bAxis = true;
+		Step.AxisValue = Value;
+		return Step;
+	}
+
+	/** Average, median, 95th percentile and maximum of one column as a JSON object */
+	static FString Summarize(TArray<float> Values)
+	{
+		if (Values.Num() == 0)
+			return TEXT("{}");
+
+		Values.Sort();
+		float Sum = 0.f;
+		for (float Value : Values)
+		{
+			Sum += Value;
+		}
+
+		return FString::Printf(TEXT("{ \"avg\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"max\": %.4f }"),
+			Sum / Values.Num(), Values[Values.Num() / 2], Values[FMath::Min(Values.Num() * 95 / 100, Values.Num() - 1)], Values.Last());
+	}
+}
+
+ACharacterBenchmarkGameMode::ACharacterBenchmarkGameMode()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	CharacterCount = 1;
+	Spacing = 400.f;
+	WarmUpSeconds = 5.f;
+	DurationSeconds = 30.f;
+	ScriptLength = 12.f;
+	ReplayFrameRate = 60.f;
+	bQuitWhenDone = true;
+
+	ElapsedTime = 0.f;
+	LastFrameSeconds = 0.0;
+	bFinished = false;
+
+	//Run, sprint, roll, climb, then equip, fire and reload
+	using namespace CharacterBenchmark;
+	Script =
+	{
+		Axis(0.f, TEXT("MoveForward"), 1.f),
+		Action(0.f, TEXT("TakeItem"), IE_Pressed),
+		Action(1.f, TEXT("Sprint"), IE_Pressed),
+		Action(3.f, TEXT("Sprint"), IE_Released),
+		Action(3.5f, TEXT("Roll"), IE_Pressed),
+		Action(4.5f, TEXT("Jump"), IE_Pressed),
+		Action(5.5f, TEXT("Jump"), IE_Released),
+		Action(6.f, TEXT("EquipFirstWeapon"), IE_Pressed),
+		Axis(7.f, TEXT("MoveForward"), 0.f),
+		Action(7.f, TEXT("Fire"), IE_Pressed),
+		Action(8.5f, TEXT("Fire"), IE_Released),
+		Action(9.f, TEXT("Reload"), IE_Pressed),
+		Action(11.5f, TEXT("UnEquipWeapon"), IE_Pressed),
+	};
+}
+
+void ACharacterBenchmarkGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	CharacterCount = FMath::Max(UGameplayStatics::GetIntOption(Options, TEXT("Characters"), CharacterCount), 1);
+
+	if (UGameplayStatics::HasOption(Options, TEXT("WarmUp")))
+	{
+		WarmUpSeconds = FCString::Atof(*UGameplayStatics::ParseOption(Options, TEXT("WarmUp")));
+	}
+
+	if (UGameplayStatics::HasOption(Options, TEXT("Duration")))
+	{
+		DurationSeconds = FCString::Atof(*UGameplayStatics::ParseOption(Options, TEXT("Duration")));
+	}
+
+	OutputName = FString::Printf(TEXT("CharacterBenchmark_%d"), CharacterCount);
+
+	if (UGameplayStatics::HasOption(Options, TEXT("Replay")))
+	{
+		const FString ReplayName = UGameplayStatics::ParseOption(Options, TEXT("Replay"));
+		LoadRecordings(ReplayName);
+
+		if (Recordings.Num() > 0)
+		{
+			CharacterCount = Recordings.Num();
+			OutputName = FString::Printf(TEXT("Replay_%s_%d"), *ReplayName, CharacterCount);
+
+			if (!UGameplayStatics::HasOption(Options, TEXT("Duration")))
+			{
+				float Length = 0.f;
+				for (const FPlayerInputRecording& Recording : Recordings)
+				{
+					Length = FMath::Max(Length, Recording.GetLength());
+				}
+				DurationSeconds = FMath::Max(Length - WarmUpSeconds, 0.f);
+			}
+
+			//Same simulation steps on every run, whatever the machine
+			ReplayFrameRate = FMath::Max(UGameplayStatics::GetIntOption(Options, TEXT("FrameRate"), FMath::RoundToInt(ReplayFrameRate)), 1);
+			FApp::SetUseFixedTimeStep(true);
+			FApp::SetFixedDeltaTime(1.0 / ReplayFrameRate);
+		}
+		else
+		{
+			UE_LOG(LogCharacterBR, Error, TEXT("Character benchmark found no input recordings named %s, running the script"), *ReplayName);
+		}
+	}
+
+	Script.Sort([](const FBenchmarkInputStep& A, const FBenchmarkInputStep& B) { return A.Time < B.Time; });
+}
+
+void ACharacterBenchmarkGameMode::StartPlay()
+{
+	Super::StartPlay();
+
+	SpawnCharacters();
+
+	Frames.Reserve(FMath::CeilToInt(DurationSeconds * 60.f));
+}
+
+void ACharacterBenchmarkGameMode::LoadRecordings(const FString& Name)
+{
+	const FString Directory = UInputRecordingSubsystem::GetRecordingDirectory();
+
+	TArray<FString> Files;
+	IFileManager::Get().FindFiles(Files, *(Directory / Name + TEXT("_*.cbrinput")), true, false);
+	Files.Sort();
+
+	for (const FString& File : Files)
+	{
+		FPlayerInputRecording Recording;
+		if (Recording.LoadFromFile(Directory / File))
+		{
+			Recordings.Add(MoveTemp(Recording));
+		}
+		else
+		{
+			UE_LOG(LogCharacterBR, Warning, TEXT("Skipping unreadable input recording %s"), *File);
+		}
+	}
+}
+
+void ACharacterBenchmarkGameMode::SpawnCharacters()
+{
+	UClass* LoadedCharacterClass = CharacterClass.LoadSynchronous();
+	UClass* LoadedWeaponClass = WeaponClass.LoadSynchronous();
+	if (!LoadedCharacterClass)
+	{
+		UE_LOG(LogCharacterBR, Error, TEXT("Character benchmark has no CharacterClass"));
+		return;
+	}
+
+	const AActor* Start = FindPlayerStart(nullptr);
+	const FVector Origin = Start ? Start->GetActorLocation() : FVector::ZeroVector;
+	const int32 Columns = FMath::CeilToInt(FMath::Sqrt((float)CharacterCount));
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	Characters.Reserve(CharacterCount);
+	for (int32 Index = 0; Index < CharacterCount; ++Index)
+	{
+		//Replayed players start where they were recorded
+		const bool bReplay = Recordings.IsValidIndex(Index);
+		const FVector Location = bReplay ? Recordings[Index].StartLocation : Origin + FVector((Index / Columns) * Spacing, (Index % Columns) * Spacing, 0.f);
+		const FRotator Rotation = bReplay ? Recordings[Index].StartRotation : FRotator::ZeroRotator;
+
+		APlayerCharacter* Character = GetWorld()->SpawnActor<APlayerCharacter>(LoadedCharacterClass, Location, Rotation, SpawnParams);
+		if (!Character)
+			continue;
+
+		//Movement needs a controller, the script stands in for the player and owns the view
+		Character->SpawnDefaultController();
+		if (AAIController* AIController = Cast<AAIController>(Character->GetController()))
+		{
+			AIController->bSetControlRotationFromPawnOrientation = false;
+		}
+		Characters.Add(Character);
+
+		if (bReplay)
+		{
+			Playbacks.Emplace(Recordings[Index]);
+		}
+		else if (LoadedWeaponClass)
+		{
+			GetWorld()->SpawnActor<AWeapon>(LoadedWeaponClass, Location, FRotator::ZeroRotator, SpawnParams);
+		}
+	}
+
+	UE_LOG(LogCharacterBR, Log, TEXT("Character benchmark spawned %d characters"), Characters.Num());
+}
+
+void ACharacterBenchmarkGameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (bFinished)
+		return;
+
+	const float PreviousElapsed = ElapsedTime;
+	ElapsedTime += DeltaSeconds;
+
+	const double InputStart = FPlatformTime::Seconds();
+	const float FrameMs = LastFrameSeconds > 0.0 ? (InputStart - LastFrameSeconds) * 1000.0 : DeltaSeconds * 1000.f;
+	LastFrameSeconds = InputStart;
+
+	for (int32 Index = 0; Index < Characters.Num(); ++Index)
+	{
+		APlayerCharacter* Character = Characters[Index];
+		if (!Character || Character->IsPendingKill())
+			continue;
+
+		if (Playbacks.IsValidIndex(Index))
+		{
+			Playbacks[Index].Advance(Character, ElapsedTime);
+			continue;
+		}
+
+		//Spread the characters over the script so they don't all act on the same frame
+		const float Offset = FMath::Frac(Index * 0.618034f) * ScriptLength;
+		RunScript(Character, FMath::Fmod(PreviousElapsed + Offset, ScriptLength), FMath::Fmod(ElapsedTime + Offset, ScriptLength));
+	}
+
+	const float InputMs = (FPlatformTime::Seconds() - InputStart) * 1000.0;
+
+	if (ElapsedTime < WarmUpSeconds)
+		return;
+
+	FBenchmarkFrame& Frame = Frames.AddDefaulted_GetRef();
+	Frame.FrameMs = FrameMs;
+	Frame.GameThreadMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+	Frame.InputMs = InputMs;
+	Frame.UsedMemoryMB = FPlatformMemory::GetStats().UsedPhysical / (1024.f * 1024.f);
+
+	for (int32 Path = 0; Path < (int32)ECharacterBRPath::MAX; ++Path)
+	{
+		FCharacterBRProfiler::GetLastFrame((ECharacterBRPath)Path, Frame.PathMs[Path], Frame.PathCalls[Path]);
+	}
+
+	if (ElapsedTime >= WarmUpSeconds + DurationSeconds)
+	{
+		bFinished = true;
+		WriteResults();
+
+		if (bQuitWhenDone)
+		{
+			UKismetSystemLibrary::QuitGame(this, nullptr, EQuitPreference::Quit, false);
+		}
+	}
+}
+
+void ACharacterBenchmarkGameMode::RunScript(APlayerCharacter* Character, float PreviousTime, float Time)
+{
+	const bool bWrapped = Time < PreviousTime;
+
+	TArray<TPair<FName, float>, TInlineAllocator<4>> HeldAxes;
+
+	for (const FBenchmarkInputStep& Step : Script)
+	{
+		if (Step.bAxis)
+		{
+			TPair<FName, float>* Held = HeldAxes.FindByPredicate([&Step](const TPair<FName, float>& Pair) { return Pair.Key == Step.Name; });
+			if (!Held)
+			{
+				Held = &HeldAxes.Emplace_GetRef(Step.Name, 0.f);
+			}
+
+			if (Step.Time <= Time)
+			{
+				Held->Value = Step.AxisValue;
+			}
+			continue;
+		}
+
+		const bool bCrossed = bWrapped
+			? (Step.Time > PreviousTime || Step.Time <= Time)
+			: (Step.Time > PreviousTime && Step.Time <= Time);
+
+		if (bCrossed)
+		{
+			Character->InjectAction(Step.Name, Step.Event);
+		}
+	}
+
+	//Axes are sent every frame, like an input component does
+	for (const TPair<FName, float>& Held : HeldAxes)
+	{
+		Character->InjectAxis(Held.Key, Held.Value);
+	}
+}
+
+void ACharacterBenchmarkGameMode::WriteResults() const
+{
+	const FString Directory = FPaths::ProjectSavedDir() / TEXT("Benchmarks");
+
+	FString Csv = TEXT("Frame,Characters,FrameMs,GameThreadMs,InputMs,UsedMemoryMB");
+	for (int32 Path = 0; Path < (int32)ECharacterBRPath::MAX; ++Path)
+	{
+		const TCHAR* PathName = FCharacterBRProfiler::GetPathName((ECharacterBRPath)Path);
+		Csv += FString::Printf(TEXT(",%sMs,%sCalls"), PathName, PathName);
+	}
+	Csv += TEXT("\n");
+
+	TArray<float> FrameMs, GameThreadMs, InputMs, UsedMemoryMB;
+
+	for (int32 Index = 0; Index < Frames.Num(); ++Index)
+	{
+		const FBenchmarkFrame& Frame = Frames[Index];
+		Csv += FString::Printf(TEXT("%d,%d,%.4f,%.4f,%.4f,%.2f"), Index, Characters.Num(), Frame.FrameMs, Frame.GameThreadMs, Frame.InputMs, Frame.UsedMemoryMB);
+		for (int32 Path = 0; Path < (int32)ECharacterBRPath::MAX; ++Path)
+		{
+			Csv += FString::Printf(TEXT(",%.4f,%u"), Frame.PathMs[Path], Frame.PathCalls[Path]);
+		}
+		Csv += TEXT("\n");
+
+		FrameMs.Add(Frame.FrameMs);
+		GameThreadMs.Add(Frame.GameThreadMs);
+		InputMs.Add(Frame.InputMs);
+		UsedMemoryMB.Add(Frame.UsedMemoryMB);
+	}
+
+	using namespace CharacterBenchmark;
+	const FString Json = FString::Printf(
+		TEXT("{\n\t\"characters\": %d,\n\t\"frames\": %d,\n\t\"frameMs\": %s,\n\t\"gameThreadMs\": %s,\n\t\"inputMs\": %s,\n\t\"usedMemoryMB\": %s\n}\n"),
+		Characters.Num(), Frames.Num(), *Summarize(FrameMs), *Summarize(GameThreadMs), *Summarize(InputMs), *Summarize(UsedMemoryMB));
+
+	const FString CsvPath = Directory / OutputName + TEXT(".csv");
+	FFileHelper::SaveStringToFile(Csv, *CsvPath);
+	FFileHelper::SaveStringToFile(Json, *(Directory / OutputName + TEXT(".json")));
+
+	UE_LOG(LogCharacterBR, Log, TEXT("Character benchmark wrote %d frames to %s"), Frames.Num(), *CsvPath);
+}
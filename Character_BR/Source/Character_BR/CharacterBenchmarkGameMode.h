@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameModeBase.h"
+#include "CharacterBRStats.h"
+#include "PlayerInputRecording.h"
+#include "CharacterBenchmarkGameMode.generated.h"
+
+class APlayerCharacter;
+
+/** One input event of the benchmark script, axis steps hold their value until the next step of that axis */
+USTRUCT()
+struct FBenchmarkInputStep
+{
+	GENERATED_BODY()
+
+	/** Seconds into the script */
+	UPROPERTY(Config)
+	float Time = 0.f;
+
+	UPROPERTY(Config)
+	FName Name;
+
+	UPROPERTY(Config)
+	bool bAxis = false;
+
+	UPROPERTY(Config)
+	TEnumAsByte<EInputEvent> Event = IE_Pressed;
+
+	UPROPERTY(Config)
+	float AxisValue = 0.f;
+};
+
+/** Measurements of one benchmark frame */
+struct FBenchmarkFrame
+{
+	float FrameMs;
+	float GameThreadMs;
+	float InputMs;
+	float UsedMemoryMB;
+
+	/** CharacterBR paths of the previous frame, the one DeltaSeconds measured */
+	float PathMs[(int32)ECharacterBRPath::MAX];
+	uint32 PathCalls[(int32)ECharacterBRPath::MAX];
+};
+
+/**
+ * Spawns Characters player characters, drives each through the input script by the same bindings players use,
+ * and writes per-frame timings to Saved/Benchmarks once DurationSeconds have been measured.
+ * Runs headless, e.g. Character_BR ThirdPersonExampleMap?game=/Script/Character_BR.CharacterBenchmarkGameMode?Characters=100 -game -nullrhi
+ * ?Replay=Name spawns one character per input recording of that name instead and replays them at a fixed time step.
+ */
+UCLASS(Config = Game)
+class CHARACTER_BR_API ACharacterBenchmarkGameMode : public AGameModeBase
+{
+	GENERATED_BODY()
+
+public:
+
+	ACharacterBenchmarkGameMode();
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+
+	virtual void StartPlay() override;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+protected:
+
+	UPROPERTY(Config)
+	TSoftClassPtr<APlayerCharacter> CharacterClass;
+
+	/** Spawned at the feet of every character so the script can pick it up */
+	UPROPERTY(Config)
+	TSoftClassPtr<class AWeapon> WeaponClass;
+
+	/** Overridden by ?Characters= */
+	UPROPERTY(Config)
+	int32 CharacterCount;
+
+	UPROPERTY(Config)
+	float Spacing;
+
+	/** Frames before this are not recorded, overridden by ?WarmUp= */
+	UPROPERTY(Config)
+	float WarmUpSeconds;
+
+	/** Overridden by ?Duration= */
+	UPROPERTY(Config)
+	float DurationSeconds;
+
+	/** The script repeats every ScriptLength seconds, each character starts at a different offset */
+	UPROPERTY(Config)
+	float ScriptLength;
+
+	UPROPERTY(Config)
+	TArray<FBenchmarkInputStep> Script;
+
+	/** Fixed frame rate of replays, overridden by ?FrameRate= */
+	UPROPERTY(Config)
+	float ReplayFrameRate;
+
+	/** Quit once the results are written */
+	UPROPERTY(Config)
+	bool bQuitWhenDone;
+
+private:
+
+	void SpawnCharacters();
+
+	/** Sends every step crossed between PreviousTime and Time and the held axis values */
+	void RunScript(APlayerCharacter* Character, float PreviousTime, float Time);
+
+	void WriteResults() const;
+
+	/** Loads Saved/InputRecordings/Name_*.cbrinput */
+	void LoadRecordings(const FString& Name);
+
+	UPROPERTY(Transient)
+	TArray<APlayerCharacter*> Characters;
+
+	TArray<FBenchmarkFrame> Frames;
+
+	TArray<FPlayerInputRecording> Recordings;
+
+	/** One per spawned character when replaying */
+	TArray<FPlayerInputPlayback> Playbacks;
+
+	/** Wall clock of the previous frame, DeltaSeconds is fixed while replaying */
+	double LastFrameSeconds;
+
+	float ElapsedTime;
+
+	bool bFinished;
+
+	FString OutputName;
+};
@@ -0,0 +1,136 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CharacterStatusSubsystem.h"
+#include "CharacterBRStats.h"
+#include "PlayerCharacter.h"
+
+void UCharacterStatusSubsystem::Deinitialize()
+{
+	for (APlayerCharacter* Character : Characters)
+	{
+		if (Character) Character->StatusIndex = INDEX_NONE;
+	}
+
+	Characters.Reset();
+	Stamina.Reset();
+	Health.Reset();
+	StaminaDrain.Reset();
+	HealthDrain.Reset();
+
+	Super::Deinitialize();
+}
+
+int32 UCharacterStatusSubsystem::Register(APlayerCharacter* Character)
+{
+	check(Character);
+
+	if (Character->StatusIndex != INDEX_NONE)
+		return Character->StatusIndex;
+
+	const int32 Index = Characters.Add(Character);
+	Stamina.Add(Character->Stamina);
+	Health.Add(Character->Health);
+	StaminaDrain.Add(0.f);
+	HealthDrain.Add(0.f);
+
+	Character->StatusIndex = Index;
+	return Index;
+}
+
+void UCharacterStatusSubsystem::Unregister(APlayerCharacter* Character)
+{
+	if (!Character || !Characters.IsValidIndex(Character->StatusIndex) || Characters[Character->StatusIndex] != Character)
+		return;
+
+	const int32 Index = Character->StatusIndex;
+
+	Characters.RemoveAtSwap(Index, 1, false);
+	Stamina.RemoveAtSwap(Index, 1, false);
+	Health.RemoveAtSwap(Index, 1, false);
+	StaminaDrain.RemoveAtSwap(Index, 1, false);
+	HealthDrain.RemoveAtSwap(Index, 1, false);
+
+	//Last slot moved into the hole
+	if (Characters.IsValidIndex(Index) && Characters[Index])
+	{
+		Characters[Index]->StatusIndex = Index;
+	}
+
+	Character->StatusIndex = INDEX_NONE;
+}
+
+void UCharacterStatusSubsystem::SetDrainRates(int32 Index, float InStaminaDrain, float InHealthDrain)
+{
+	if (Characters.IsValidIndex(Index))
+	{
+		StaminaDrain[Index] = InStaminaDrain;
+		HealthDrain[Index] = InHealthDrain;
+	}
+}
+
+void UCharacterStatusSubsystem::SetStamina(int32 Index, float Value)
+{
+	if (Characters.IsValidIndex(Index))
+	{
+		Stamina[Index] = Value;
+		Characters[Index]->Stamina = Value;
+		Characters[Index]->NotifyStatusChanged();
+	}
+}
+
+void UCharacterStatusSubsystem::SetHealth(int32 Index, float Value)
+{
+	if (Characters.IsValidIndex(Index))
+	{
+		Health[Index] = Value;
+		Characters[Index]->Health = Value;
+		Characters[Index]->NotifyStatusChanged();
+	}
+}
+
+void UCharacterStatusSubsystem::Drain(float DeltaTime, int32 Count, float* RESTRICT StaminaData, float* RESTRICT HealthData, const float* RESTRICT StaminaDrainData, const float* RESTRICT HealthDrainData)
+{
+	//Branch free so the compiler can vectorize it
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const float HasStamina = StaminaData[Index] > 0.f ? 1.f : 0.f;
+		StaminaData[Index] -= HasStamina * StaminaDrainData[Index] * DeltaTime;
+		HealthData[Index] -= (1.f - HasStamina) * HealthDrainData[Index] * DeltaTime;
+	}
+}
+
+void UCharacterStatusSubsystem::Tick(float DeltaTime)
+{
+	CHARACTERBR_SCOPE(StatusTick);
+
+	const int32 Count = Characters.Num();
+
+	float* StaminaData = Stamina.GetData();
+	float* HealthData = Health.GetData();
+	const float* StaminaDrainData = StaminaDrain.GetData();
+	const float* HealthDrainData = HealthDrain.GetData();
+
+	Drain(DeltaTime, Count, StaminaData, HealthData, StaminaDrainData, HealthDrainData);
+
+	//Mirror back only the characters that are actually draining
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		if (StaminaDrainData[Index] != 0.f || HealthDrainData[Index] != 0.f)
+		{
+			APlayerCharacter* Character = Characters[Index];
+			Character->Stamina = StaminaData[Index];
+			Character->Health = HealthData[Index];
+			Character->NotifyStatusChanged();
+		}
+	}
+}
+
+bool UCharacterStatusSubsystem::IsTickable() const
+{
+	return !IsTemplate() && Characters.Num() > 0;
+}
+
+TStatId UCharacterStatusSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCharacterStatusSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "CharacterStatusSubsystem.generated.h"
+
+class APlayerCharacter;
+
+/**
+ * Drains stamina and health of every registered character in one pass per frame.
+ * Values are kept in parallel arrays so the update loop only walks contiguous floats;
+ * characters just register, set their drain rates when their state changes and unregister.
+ */
+UCLASS()
+class CHARACTER_BR_API UCharacterStatusSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	/** Adds the character and returns its slot. The slot may move, the character's StatusIndex is kept up to date. */
+	int32 Register(APlayerCharacter* Character);
+
+	void Unregister(APlayerCharacter* Character);
+
+	/** Per second drain. Health only drains while stamina is empty. */
+	void SetDrainRates(int32 Index, float StaminaDrain, float HealthDrain);
+
+	void SetStamina(int32 Index, float Value);
+
+	void SetHealth(int32 Index, float Value);
+
+	FORCEINLINE int32 Num() const { return Characters.Num(); }
+
+	/** The per-frame pass over Count slots, health only drains where stamina is empty */
+	static void Drain(float DeltaTime, int32 Count, float* RESTRICT Stamina, float* RESTRICT Health, const float* RESTRICT StaminaDrain, const float* RESTRICT HealthDrain);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+
+	UPROPERTY(Transient)
+	TArray<APlayerCharacter*> Characters;
+
+	TArray<float> Stamina;
+
+	TArray<float> Health;
+
+	TArray<float> StaminaDrain;
+
+	TArray<float> HealthDrain;
+};
@@ -3,5 +3,7 @@
 #include "Character_BR.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_LOG_CATEGORY(LogCharacterBR);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Character_BR, "Character_BR" );
  
\ No newline at end of file
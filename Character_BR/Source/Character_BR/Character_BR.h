@@ -3,3 +3,11 @@
 #pragma once
 
 #include "CoreMinimal.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogCharacterBR, Log, All);
+
+/** Trace channel that only climbable geometry blocks, "ClimbTrace" in DefaultEngine.ini */
+#define COLLISION_CLIMB ECC_GameTraceChannel1
+
+/** Trace channel for hitscan shots, blocked by default so pawns are hit too, "WeaponTrace" in DefaultEngine.ini */
+#define COLLISION_WEAPON ECC_GameTraceChannel2
@@ -0,0 +1,390 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ClimbLedgeIndexSubsystem.h"
+#include "Character_BR.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/Level.h"
+#include "Engine/StaticMesh.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/Package.h"
+
+namespace ClimbLedgeIndex
+{
+	static const uint32 CacheMagic = 0x434C4958; // CLIX
+	static const int32 CacheVersion = 1;
+
+	static FAutoConsoleCommandWithWorld RebuildCommand(
+		TEXT("ClimbIndex.Rebuild"),
+		TEXT("Rescans every loaded level for climbable walls and rewrites the cached index."),
+		FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+		{
+			if (UClimbLedgeIndexSubsystem* Index = World ? World->GetSubsystem<UClimbLedgeIndexSubsystem>() : nullptr)
+			{
+				Index->Rebuild();
+			}
+		}));
+}
+
+UClimbLedgeIndexSubsystem::UClimbLedgeIndexSubsystem()
+{
+	CellSize = 400.f;
+	MaxReach = 100.f;
+	MinWallHeight = 50.f;
+	NumLevels = 0;
+}
+
+void UClimbLedgeIndexSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	ActorsInitializedHandle = FWorldDelegates::OnWorldInitializedActors.AddUObject(this, &UClimbLedgeIndexSubsystem::OnActorsInitialized);
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UClimbLedgeIndexSubsystem::OnLevelAdded);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UClimbLedgeIndexSubsystem::OnLevelRemoved);
+}
+
+void UClimbLedgeIndexSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldInitializedActors.Remove(ActorsInitializedHandle);
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	Levels.Reset();
+	Cells.Reset();
+	NumLevels = 0;
+
+	Super::Deinitialize();
+}
+
+void UClimbLedgeIndexSubsystem::OnActorsInitialized(const UWorld::FActorsInitializedParams& Params)
+{
+	if (Params.World != GetWorld() || !Params.World->IsGameWorld())
+		return;
+
+	for (ULevel* Level : Params.World->GetLevels())
+	{
+		if (Level && Level->bIsVisible)
+		{
+			AddLevel(Level, true);
+		}
+	}
+}
+
+void UClimbLedgeIndexSubsystem::OnLevelAdded(ULevel* Level, UWorld* World)
+{
+	if (World == GetWorld() && World->IsGameWorld() && Level)
+	{
+		AddLevel(Level, true);
+	}
+}
+
+void UClimbLedgeIndexSubsystem::OnLevelRemoved(ULevel* Level, UWorld* World)
+{
+	if (World != GetWorld())
+		return;
+
+	//A null level means the whole world is going away
+	if (Level == nullptr)
+	{
+		Levels.Reset();
+		Cells.Reset();
+		NumLevels = 0;
+		return;
+	}
+
+	RemoveLevel(Level);
+}
+
+void UClimbLedgeIndexSubsystem::Rebuild()
+{
+	TArray<ULevel*> LoadedLevels;
+	for (const FLedgeLevel& Slot : Levels)
+	{
+		if (ULevel* Level = Slot.Level.Get())
+		{
+			LoadedLevels.Add(Level);
+		}
+	}
+
+	Levels.Reset();
+	Cells.Reset();
+	NumLevels = 0;
+
+	for (ULevel* Level : LoadedLevels)
+	{
+		AddLevel(Level, false);
+	}
+}
+
+static void ForEachFaceCell(const FClimbLedgeFace& Face, float CellSize, float Padding, TFunctionRef<void(const FIntPoint&)> Func)
+{
+	const FVector2D Min = FVector2D::Min(Face.Start, Face.End) - FVector2D(Padding, Padding);
+	const FVector2D Max = FVector2D::Max(Face.Start, Face.End) + FVector2D(Padding, Padding);
+
+	const int32 MinX = FMath::FloorToInt(Min.X / CellSize);
+	const int32 MinY = FMath::FloorToInt(Min.Y / CellSize);
+	const int32 MaxX = FMath::FloorToInt(Max.X / CellSize);
+	const int32 MaxY = FMath::FloorToInt(Max.Y / CellSize);
+
+	for (int32 X = MinX; X <= MaxX; ++X)
+	{
+		for (int32 Y = MinY; Y <= MaxY; ++Y)
+		{
+			Func(FIntPoint(X, Y));
+		}
+	}
+}
+
+void UClimbLedgeIndexSubsystem::AddLevel(ULevel* Level, bool bUseCache)
+{
+	if (Levels.ContainsByPredicate([Level](const FLedgeLevel& Slot) { return Slot.Level == Level; }))
+		return;
+
+	int32 LevelSlot = Levels.IndexOfByPredicate([](const FLedgeLevel& Slot) { return !Slot.Level.IsValid() && Slot.Faces.Num() == 0; });
+	if (LevelSlot == INDEX_NONE)
+	{
+		LevelSlot = Levels.AddDefaulted();
+	}
+
+	FLedgeLevel& Slot = Levels[LevelSlot];
+	Slot.Level = Level;
+
+	if (!bUseCache || !LoadCache(Level, Slot.Faces))
+	{
+		ScanLevel(Level, Slot.Faces);
+		SaveCache(Level, Slot.Faces);
+	}
+
+	IndexFaces(LevelSlot);
+
+	NumLevels++;
+}
+
+void UClimbLedgeIndexSubsystem::AddFaces(const TArray<FClimbLedgeFace>& Faces)
+{
+	const int32 LevelSlot = Levels.AddDefaulted();
+	Levels[LevelSlot].Faces = Faces;
+
+	IndexFaces(LevelSlot);
+}
+
+void UClimbLedgeIndexSubsystem::IndexFaces(int32 LevelSlot)
+{
+	const TArray<FClimbLedgeFace>& Faces = Levels[LevelSlot].Faces;
+
+	for (int32 FaceIndex = 0; FaceIndex < Faces.Num(); ++FaceIndex)
+	{
+		ForEachFaceCell(Faces[FaceIndex], CellSize, MaxReach, [this, LevelSlot, FaceIndex](const FIntPoint& Cell)
+		{
+			Cells.FindOrAdd(Cell).Add({ LevelSlot, FaceIndex });
+		});
+	}
+}
+
+void UClimbLedgeIndexSubsystem::RemoveLevel(ULevel* Level)
+{
+	const int32 LevelSlot = Levels.IndexOfByPredicate([Level](const FLedgeLevel& Slot) { return Slot.Level == Level; });
+	if (LevelSlot == INDEX_NONE)
+		return;
+
+	FLedgeLevel& Slot = Levels[LevelSlot];
+
+	for (const FClimbLedgeFace& Face : Slot.Faces)
+	{
+		ForEachFaceCell(Face, CellSize, MaxReach, [this, LevelSlot](const FIntPoint& Cell)
+		{
+			if (TArray<FLedgeRef>* Refs = Cells.Find(Cell))
+			{
+				Refs->RemoveAllSwap([LevelSlot](const FLedgeRef& Ref) { return Ref.LevelSlot == LevelSlot; }, false);
+				if (Refs->Num() == 0)
+				{
+					Cells.Remove(Cell);
+				}
+			}
+		});
+	}
+
+	Slot.Level = nullptr;
+	Slot.Faces.Empty();
+	NumLevels--;
+}
+
+void UClimbLedgeIndexSubsystem::ScanLevel(ULevel* Level, TArray<FClimbLedgeFace>& OutFaces) const
+{
+	OutFaces.Reset();
+
+	for (AActor* Actor : Level->Actors)
+	{
+		if (!Actor)
+			continue;
+
+		TInlineComponentArray<UStaticMeshComponent*> Components(Actor);
+		for (UStaticMeshComponent* Component : Components)
+		{
+			//Only static geometry that blocks the climb channel can be baked
+			if (!Component->IsRegistered() || Component->Mobility != EComponentMobility::Static || !Component->GetStaticMesh()
+				|| !Component->IsCollisionEnabled() || Component->GetCollisionResponseToChannel(COLLISION_CLIMB) != ECR_Block)
+				continue;
+
+			const FBox LocalBox = Component->GetStaticMesh()->GetBoundingBox();
+
+			if (UInstancedStaticMeshComponent* Instanced = Cast<UInstancedStaticMeshComponent>(Component))
+			{
+				for (int32 Instance = 0; Instance < Instanced->GetInstanceCount(); ++Instance)
+				{
+					FTransform InstanceTransform;
+					if (Instanced->GetInstanceTransform(Instance, InstanceTransform, true))
+					{
+						AddBoxFaces(LocalBox, InstanceTransform, OutFaces);
+					}
+				}
+			}
+			else
+			{
+				AddBoxFaces(LocalBox, Component->GetComponentTransform(), OutFaces);
+			}
+		}
+	}
+
+	OutFaces.Shrink();
+}
+
+void UClimbLedgeIndexSubsystem::AddBoxFaces(const FBox& LocalBox, const FTransform& Transform, TArray<FClimbLedgeFace>& OutFaces) const
+{
+	const FVector& Min = LocalBox.Min;
+	const FVector& Max = LocalBox.Max;
+
+	float Bottom = MAX_flt;
+	float Top = -MAX_flt;
+	for (int32 Corner = 0; Corner < 8; ++Corner)
+	{
+		const FVector Local((Corner & 1) ? Max.X : Min.X, (Corner & 2) ? Max.Y : Min.Y, (Corner & 4) ? Max.Z : Min.Z);
+		const float Z = Transform.TransformPosition(Local).Z;
+		Bottom = FMath::Min(Bottom, Z);
+		Top = FMath::Max(Top, Z);
+	}
+
+	if (Top - Bottom < MinWallHeight)
+		return;
+
+	//Upright boxes keep their footprint, anything tilted falls back to its world bounds
+	FVector2D Base[4];
+	if (FMath::Abs(Transform.GetUnitAxis(EAxis::Z).Z) > 0.99f)
+	{
+		const FVector Footprint[4] = { FVector(Min.X, Min.Y, Min.Z), FVector(Max.X, Min.Y, Min.Z), FVector(Max.X, Max.Y, Min.Z), FVector(Min.X, Max.Y, Min.Z) };
+		for (int32 Corner = 0; Corner < 4; ++Corner)
+		{
+			const FVector World = Transform.TransformPosition(Footprint[Corner]);
+			Base[Corner] = FVector2D(World.X, World.Y);
+		}
+	}
+	else
+	{
+		const FBox WorldBox = LocalBox.TransformBy(Transform);
+		Base[0] = FVector2D(WorldBox.Min.X, WorldBox.Min.Y);
+		Base[1] = FVector2D(WorldBox.Max.X, WorldBox.Min.Y);
+		Base[2] = FVector2D(WorldBox.Max.X, WorldBox.Max.Y);
+		Base[3] = FVector2D(WorldBox.Min.X, WorldBox.Max.Y);
+	}
+
+	for (int32 Edge = 0; Edge < 4; ++Edge)
+	{
+		const FVector2D& Start = Base[Edge];
+		const FVector2D& End = Base[(Edge + 1) % 4];
+
+		if (FVector2D::DistSquared(Start, End) > 1.f)
+		{
+			OutFaces.Add({ Start, End, Bottom, Top });
+		}
+	}
+}
+
+bool UClimbLedgeIndexSubsystem::FindLedge(const FVector& Location, const FVector& Forward, float Reach, float Height, float& OutLedgeTop) const
+{
+	const FVector2D Origin(Location.X, Location.Y);
+	const FVector2D Ray = FVector2D(Forward.X, Forward.Y).GetSafeNormal() * FMath::Min(Reach, MaxReach);
+	if (Ray.IsNearlyZero())
+		return false;
+
+	const TArray<FLedgeRef>* Refs = Cells.Find(GetCell(Origin));
+	if (!Refs)
+		return false;
+
+	const float Z = Location.Z + Height;
+	float BestTime = MAX_flt;
+
+	for (const FLedgeRef& Ref : *Refs)
+	{
+		const FClimbLedgeFace& Face = Levels[Ref.LevelSlot].Faces[Ref.FaceIndex];
+		if (Z < Face.Bottom || Z > Face.Top)
+			continue;
+
+		//2D segment intersection
+		const FVector2D Edge = Face.End - Face.Start;
+		const float Denominator = Ray ^ Edge;
+		if (FMath::IsNearlyZero(Denominator))
+			continue;
+
+		const FVector2D ToStart = Face.Start - Origin;
+		const float Time = (ToStart ^ Edge) / Denominator;
+		const float EdgeTime = (ToStart ^ Ray) / Denominator;
+
+		if (Time >= 0.f && Time <= 1.f && EdgeTime >= 0.f && EdgeTime <= 1.f && Time < BestTime)
+		{
+			BestTime = Time;
+			OutLedgeTop = Face.Top;
+		}
+	}
+
+	return BestTime <= 1.f;
+}
+
+FIntPoint UClimbLedgeIndexSubsystem::GetCell(const FVector2D& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+FString UClimbLedgeIndexSubsystem::GetCachePath(ULevel* Level) const
+{
+	const FString PackageName = UWorld::RemovePIEPrefix(Level->GetOutermost()->GetName());
+	return FPaths::ProjectSavedDir() / TEXT("ClimbIndex") / FPaths::GetBaseFilename(PackageName) + TEXT(".bin");
+}
+
+bool UClimbLedgeIndexSubsystem::LoadCache(ULevel* Level, TArray<FClimbLedgeFace>& OutFaces) const
+{
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *GetCachePath(Level), FILEREAD_Silent))
+		return false;
+
+	FMemoryReader Reader(Data);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	FGuid PackageGuid;
+	Reader << Magic << Version << PackageGuid;
+
+	//Stale when the level was saved again since the cache was written
+	if (Magic != ClimbLedgeIndex::CacheMagic || Version != ClimbLedgeIndex::CacheVersion || PackageGuid != Level->GetOutermost()->GetGuid())
+		return false;
+
+	Reader << OutFaces;
+	return !Reader.IsError();
+}
+
+void UClimbLedgeIndexSubsystem::SaveCache(ULevel* Level, const TArray<FClimbLedgeFace>& Faces) const
+{
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+
+	uint32 Magic = ClimbLedgeIndex::CacheMagic;
+	int32 Version = ClimbLedgeIndex::CacheVersion;
+	FGuid PackageGuid = Level->GetOutermost()->GetGuid();
+	Writer << Magic << Version << PackageGuid;
+	Writer << const_cast<TArray<FClimbLedgeFace>&>(Faces);
+
+	FFileHelper::SaveArrayToFile(Data, *GetCachePath(Level));
+}
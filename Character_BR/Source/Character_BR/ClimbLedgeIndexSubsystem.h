@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/World.h"
+#include "ClimbLedgeIndexSubsystem.generated.h"
+
+class ULevel;
+class UStaticMeshComponent;
+
+/** Vertical wall segment of a climbable box, in world space */
+struct FClimbLedgeFace
+{
+	FVector2D Start;
+	FVector2D End;
+	float Bottom;
+	float Top;
+
+	friend FArchive& operator<<(FArchive& Ar, FClimbLedgeFace& Face)
+	{
+		return Ar << Face.Start << Face.End << Face.Bottom << Face.Top;
+	}
+};
+
+/**
+ * Grid of the climbable walls and their ledge heights, built from the static geometry
+ * that blocks the ClimbTrace channel. Climb checks query it without touching the physics scene.
+ * Each level's faces are cached under Saved/ClimbIndex and rebuilt when the level package changes;
+ * streaming levels are added and removed incrementally.
+ */
+UCLASS()
+class CHARACTER_BR_API UClimbLedgeIndexSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UClimbLedgeIndexSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	/** True once the loaded levels produced at least one climbable wall */
+	FORCEINLINE bool IsBuilt() const { return Cells.Num() > 0; }
+
+	/**
+	 * Looks for a wall in front of Location at the given height, within Reach.
+	 * @return true and the ledge top of the closest wall hit
+	 */
+	bool FindLedge(const FVector& Location, const FVector& Forward, float Reach, float Height, float& OutLedgeTop) const;
+
+	/** Drops the cached index of every loaded level and scans them again. Faces added with AddFaces are dropped too */
+	void Rebuild();
+
+	/** Indexes walls that belong to no level, such as geometry built at runtime or by tests */
+	void AddFaces(const TArray<FClimbLedgeFace>& Faces);
+
+	/** The four walls of a box, if it is tall enough to climb */
+	void AddBoxFaces(const FBox& LocalBox, const FTransform& Transform, TArray<FClimbLedgeFace>& OutFaces) const;
+
+	/** Cell size of the grid (cm) */
+	float CellSize;
+
+	/** Longest probe the grid is padded for (cm) */
+	float MaxReach;
+
+	/** Boxes lower than this are stepped over, not climbed (cm) */
+	float MinWallHeight;
+
+private:
+
+	struct FLedgeRef
+	{
+		int32 LevelSlot;
+		int32 FaceIndex;
+	};
+
+	struct FLedgeLevel
+	{
+		TWeakObjectPtr<ULevel> Level;
+		TArray<FClimbLedgeFace> Faces;
+	};
+
+	void OnActorsInitialized(const UWorld::FActorsInitializedParams& Params);
+
+	void OnLevelAdded(ULevel* Level, UWorld* World);
+
+	void OnLevelRemoved(ULevel* Level, UWorld* World);
+
+	void AddLevel(ULevel* Level, bool bUseCache);
+
+	void RemoveLevel(ULevel* Level);
+
+	void ScanLevel(ULevel* Level, TArray<FClimbLedgeFace>& OutFaces) const;
+
+	/** Adds the faces of a level slot to the cells they can be reached from */
+	void IndexFaces(int32 LevelSlot);
+
+	FString GetCachePath(ULevel* Level) const;
+
+	bool LoadCache(ULevel* Level, TArray<FClimbLedgeFace>& OutFaces) const;
+
+	void SaveCache(ULevel* Level, const TArray<FClimbLedgeFace>& Faces) const;
+
+	FIntPoint GetCell(const FVector2D& Location) const;
+
+	TArray<FLedgeLevel> Levels;
+
+	TMap<FIntPoint, TArray<FLedgeRef>> Cells;
+
+	int32 NumLevels;
+
+	FDelegateHandle ActorsInitializedHandle;
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+};
@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ClimbProbeSubsystem.h"
+#include "CharacterBRStats.h"
+#include "Character_BR.h"
+#include "ClimbLedgeIndexSubsystem.h"
+#include "PlayerCharacter.h"
+#include "PlayerCharacterMovementComponent.h"
+#include "Engine/World.h"
+
+UClimbProbeSubsystem::UClimbProbeSubsystem()
+{
+	MoveThreshold = 5.f;
+	TurnThreshold = 5.f;
+}
+
+void UClimbProbeSubsystem::Deinitialize()
+{
+	Probes.Reset();
+
+	Super::Deinitialize();
+}
+
+void UClimbProbeSubsystem::Register(APlayerCharacter* Character)
+{
+	if (!Character || Probes.ContainsByPredicate([Character](const FClimbProbe& Probe) { return Probe.Character == Character; }))
+		return;
+
+	FClimbProbe& Probe = Probes.AddDefaulted_GetRef();
+	Probe.Character = Character;
+	Probe.LastLocation = Character->GetActorLocation();
+	Probe.LastYaw = Character->GetActorRotation().Yaw;
+	Probe.bHasResult = false;
+}
+
+void UClimbProbeSubsystem::Unregister(APlayerCharacter* Character)
+{
+	Probes.RemoveAllSwap([Character](const FClimbProbe& Probe) { return Probe.Character == Character; }, false);
+}
+
+void UClimbProbeSubsystem::Invalidate(APlayerCharacter* Character)
+{
+	for (FClimbProbe& Probe : Probes)
+	{
+		if (Probe.Character == Character)
+		{
+			Probe.bHasResult = false;
+			return;
+		}
+	}
+}
+
+void UClimbProbeSubsystem::Tick(float DeltaTime)
+{
+	CHARACTERBR_SCOPE(ClimbProbeTick);
+
+	UWorld* World = GetWorld();
+
+	const UClimbLedgeIndexSubsystem* LedgeIndex = World->GetSubsystem<UClimbLedgeIndexSubsystem>();
+	const bool bUseLedgeIndex = LedgeIndex && LedgeIndex->IsBuilt();
+
+	const float MoveThresholdSquared = MoveThreshold * MoveThreshold;
+
+	for (int32 Index = Probes.Num() - 1; Index >= 0; --Index)
+	{
+		FClimbProbe& Probe = Probes[Index];
+
+		APlayerCharacter* Character = Probe.Character.Get();
+		if (!Character)
+		{
+			Probes.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+
+		//Read back the probe queued last frame
+		if (Probe.Handle.IsValid())
+		{
+			FTraceDatum Datum;
+			if (World->QueryTraceData(Probe.Handle, Datum))
+			{
+				const bool bBlocked = Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit;
+				Probe.bHasResult = true;
+				Character->OnClimbProbeResult(bBlocked);
+			}
+			Probe.Handle.Invalidate();
+		}
+
+		//Armed characters can't climb, probe again as soon as they put the weapon away
+		if (Character->IsEquippedWeapon)
+		{
+			Probe.bHasResult = false;
+			continue;
+		}
+
+		//The movement component checks the wall itself while climbing
+		if (Character->PlayMovementState == APlayerMovementState::PMS_Climbing)
+		{
+			continue;
+		}
+
+		const FVector Location = Character->GetActorLocation();
+		const FRotator Rotation = Character->GetActorRotation();
+
+		if (Probe.bHasResult
+			&& FVector::DistSquared(Location, Probe.LastLocation) < MoveThresholdSquared
+			&& FMath::Abs(FRotator::NormalizeAxis(Rotation.Yaw - Probe.LastYaw)) < TurnThreshold)
+		{
+			continue;
+		}
+
+		Probe.LastLocation = Location;
+		Probe.LastYaw = Rotation.Yaw;
+
+		const FVector Direction = Rotation.Vector();
+		const UPlayerCharacterMovementComponent* Movement = Character->GetPlayerMovement();
+		const float ProbeDistance = Movement->ClimbProbeDistance;
+		const float ProbeHeight = Movement->ClimbProbeHeight;
+
+		float LedgeTop;
+		if (bUseLedgeIndex)
+		{
+			Probe.bHasResult = true;
+			Character->OnClimbProbeResult(LedgeIndex->FindLedge(Location, Direction, ProbeDistance, ProbeHeight, LedgeTop));
+			continue;
+		}
+
+		const FVector Start = FVector(Location.X, Location.Y, Location.Z + ProbeHeight);
+		const FVector End = Location + FVector(Direction.X * ProbeDistance, Direction.Y * ProbeDistance, Direction.Z + ProbeHeight);
+
+		FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(ClimbProbe), false, Character);
+		CHARACTERBR_COUNT(ClimbProbeTrace, 1);
+		Probe.Handle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, COLLISION_CLIMB, TraceParams);
+	}
+}
+
+bool UClimbProbeSubsystem::IsTickable() const
+{
+	return !IsTemplate() && Probes.Num() > 0;
+}
+
+TStatId UClimbProbeSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UClimbProbeSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+#include "ClimbProbeSubsystem.generated.h"
+
+class APlayerCharacter;
+
+/**
+ * Runs the climb probes of all registered characters, with the reach and height of their movement component's climb check.
+ * When the level has a ledge index the probe is answered from it directly, otherwise
+ * it goes through the async trace API and is read back next frame.
+ * Characters that have not moved or turned since their last probe are skipped.
+ */
+UCLASS()
+class CHARACTER_BR_API UClimbProbeSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UClimbProbeSubsystem();
+
+	virtual void Deinitialize() override;
+
+	void Register(APlayerCharacter* Character);
+
+	void Unregister(APlayerCharacter* Character);
+
+	/** Forces a fresh probe for the character on the next frame */
+	void Invalidate(APlayerCharacter* Character);
+
+	/** Skip the probe while the character moved less than this (cm) ... */
+	float MoveThreshold;
+
+	/** ... and turned less than this (degrees) since the last one */
+	float TurnThreshold;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+
+	struct FClimbProbe
+	{
+		TWeakObjectPtr<APlayerCharacter> Character;
+		FTraceHandle Handle;
+		FVector LastLocation;
+		float LastYaw;
+		bool bHasResult;
+	};
+
+	TArray<FClimbProbe> Probes;
+};
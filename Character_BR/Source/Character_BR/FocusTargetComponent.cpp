@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FocusTargetComponent.h"
+#include "CharacterBRStats.h"
+#include "FocusTargetSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+
+UFocusTargetComponent::UFocusTargetComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	TraceDistance = 500.f;
+	MoveThreshold = 5.f;
+	AngleThreshold = 1.f;
+
+	LastViewLocation = FVector::ZeroVector;
+	LastViewDirection = FVector::ZeroVector;
+	bTraceEnabled = true;
+	bHasResult = false;
+}
+
+void UFocusTargetComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UFocusTargetSubsystem* FocusSubsystem = GetWorld()->GetSubsystem<UFocusTargetSubsystem>())
+	{
+		FocusSubsystem->Register(this);
+	}
+}
+
+void UFocusTargetComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UFocusTargetSubsystem* FocusSubsystem = GetWorld()->GetSubsystem<UFocusTargetSubsystem>())
+	{
+		FocusSubsystem->Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UFocusTargetComponent::SetTraceEnabled(bool bEnabled)
+{
+	if (bTraceEnabled == bEnabled)
+		return;
+
+	bTraceEnabled = bEnabled;
+	bHasResult = false;
+
+	if (!bEnabled)
+	{
+		SetFocusActor(nullptr);
+	}
+}
+
+void UFocusTargetComponent::Invalidate()
+{
+	bHasResult = false;
+}
+
+bool UFocusTargetComponent::UpdateFocus()
+{
+	const APawn* Pawn = Cast<APawn>(GetOwner());
+	AController* Controller = Pawn ? Pawn->GetController() : nullptr;
+	if (!bTraceEnabled || !Controller)
+		return false;
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	Controller->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	const FVector ViewDirection = ViewRotation.Vector();
+
+	if (bHasResult
+		&& FVector::DistSquared(ViewLocation, LastViewLocation) < MoveThreshold * MoveThreshold
+		&& FVector::DotProduct(ViewDirection, LastViewDirection) > FMath::Cos(FMath::DegreesToRadians(AngleThreshold)))
+	{
+		return false;
+	}
+
+	LastViewLocation = ViewLocation;
+	LastViewDirection = ViewDirection;
+	bHasResult = true;
+
+	FHitResult Hit;
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(FocusTarget), false, GetOwner());
+	CHARACTERBR_COUNT(FocusTrace, 1);
+	GetWorld()->LineTraceSingleByChannel(Hit, ViewLocation, ViewLocation + ViewDirection * TraceDistance, ECC_Visibility, TraceParams);
+
+	SetFocusActor(Hit.GetActor());
+	return true;
+}
+
+void UFocusTargetComponent::SetFocusActor(AActor* NewFocus)
+{
+	AActor* OldFocus = FocusActor.Get();
+	if (OldFocus == NewFocus)
+		return;
+
+	FocusActor = NewFocus;
+	OnFocusChanged.Broadcast(NewFocus, OldFocus);
+}
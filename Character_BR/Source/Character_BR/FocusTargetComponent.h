@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "FocusTargetComponent.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnFocusChanged, AActor*, NewFocus, AActor*, OldFocus);
+
+/**
+ * Remembers the actor under the owner's view.
+ * Traces are issued by UFocusTargetSubsystem within its per-frame budget; the last result
+ * is reused while the view barely moved, and OnFocusChanged fires only when the actor changes.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class CHARACTER_BR_API UFocusTargetComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UFocusTargetComponent();
+
+	/** Length of the view trace */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Focus")
+	float TraceDistance;
+
+	/** Keep the last result while the view moved less than this (cm) ... */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Focus")
+	float MoveThreshold;
+
+	/** ... and turned less than this (degrees) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Focus")
+	float AngleThreshold;
+
+	UPROPERTY(BlueprintAssignable, Category = "Focus")
+	FOnFocusChanged OnFocusChanged;
+
+	UFUNCTION(BlueprintCallable, Category = "Focus")
+	FORCEINLINE AActor* GetFocusActor() const { return FocusActor.Get(); }
+
+	/** Disabling clears the focus */
+	UFUNCTION(BlueprintCallable, Category = "Focus")
+	void SetTraceEnabled(bool bEnabled);
+
+	/** Forces a fresh trace the next time the subsystem gets to us */
+	void Invalidate();
+
+	/**
+	 * Called by UFocusTargetSubsystem.
+	 * @return true if a trace was issued, false if the cached result was kept
+	 */
+	bool UpdateFocus();
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+
+	void SetFocusActor(AActor* NewFocus);
+
+	TWeakObjectPtr<AActor> FocusActor;
+
+	FVector LastViewLocation;
+
+	FVector LastViewDirection;
+
+	bool bTraceEnabled;
+
+	bool bHasResult;
+};
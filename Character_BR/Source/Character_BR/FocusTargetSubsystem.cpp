@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FocusTargetSubsystem.h"
+#include "CharacterBRStats.h"
+#include "FocusTargetComponent.h"
+
+UFocusTargetSubsystem::UFocusTargetSubsystem()
+{
+	TracesPerFrame = 4;
+	NextIndex = 0;
+}
+
+void UFocusTargetSubsystem::Deinitialize()
+{
+	Components.Reset();
+	NextIndex = 0;
+
+	Super::Deinitialize();
+}
+
+void UFocusTargetSubsystem::Register(UFocusTargetComponent* Component)
+{
+	if (Component)
+	{
+		Components.AddUnique(Component);
+	}
+}
+
+void UFocusTargetSubsystem::Unregister(UFocusTargetComponent* Component)
+{
+	Components.RemoveSingleSwap(Component, false);
+}
+
+void UFocusTargetSubsystem::Tick(float DeltaTime)
+{
+	CHARACTERBR_SCOPE(FocusTargetTick);
+
+	int32 Traces = 0;
+
+	for (int32 Visited = 0; Visited < Components.Num() && Traces < TracesPerFrame; ++Visited)
+	{
+		NextIndex = NextIndex < Components.Num() ? NextIndex : 0;
+
+		UFocusTargetComponent* Component = Components[NextIndex++];
+		if (Component && Component->UpdateFocus())
+		{
+			++Traces;
+		}
+	}
+}
+
+bool UFocusTargetSubsystem::IsTickable() const
+{
+	return !IsTemplate() && Components.Num() > 0;
+}
+
+TStatId UFocusTargetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFocusTargetSubsystem, STATGROUP_Tickables);
+}
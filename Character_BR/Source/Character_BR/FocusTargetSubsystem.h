@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "FocusTargetSubsystem.generated.h"
+
+class UFocusTargetComponent;
+
+/**
+ * Time-slices the view traces of every UFocusTargetComponent.
+ * Components are visited round-robin and at most TracesPerFrame of them trace each frame;
+ * the rest keep their cached focus until their turn comes.
+ */
+UCLASS(Config = Game)
+class CHARACTER_BR_API UFocusTargetSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UFocusTargetSubsystem();
+
+	virtual void Deinitialize() override;
+
+	void Register(UFocusTargetComponent* Component);
+
+	void Unregister(UFocusTargetComponent* Component);
+
+	/** View traces allowed per frame over all components */
+	UPROPERTY(Config)
+	int32 TracesPerFrame;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+
+	UPROPERTY(Transient)
+	TArray<UFocusTargetComponent*> Components;
+
+	/** Where the next frame picks up the round-robin */
+	int32 NextIndex;
+};
@@ -0,0 +1,259 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HitboxHistoryComponent.h"
+#include "Character_BR.h"
+#include "HitscanSubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+
+namespace HitboxHistory
+{
+	/** Offsets are stored in half centimeters, int16 holds bones within about 163m of the actor */
+	static const float OffsetScale = 2.f;
+
+	/** Snapshots per second without a net driver */
+	static const float StandaloneSampleRate = 30.f;
+
+	/** Slab test of a ray in the box's local space */
+	static bool IntersectBox(const FVector& Start, const FVector& Direction, float Length, const FVector& HalfExtent, float& OutDistance)
+	{
+		float Near = 0.f;
+		float Far = Length;
+
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			if (FMath::Abs(Direction[Axis]) < KINDA_SMALL_NUMBER)
+			{
+				if (FMath::Abs(Start[Axis]) > HalfExtent[Axis])
+					return false;
+				continue;
+			}
+
+			float T0 = (-HalfExtent[Axis] - Start[Axis]) / Direction[Axis];
+			float T1 = (HalfExtent[Axis] - Start[Axis]) / Direction[Axis];
+			if (T0 > T1) Swap(T0, T1);
+
+			Near = FMath::Max(Near, T0);
+			Far = FMath::Min(Far, T1);
+			if (Near > Far)
+				return false;
+		}
+
+		OutDistance = Near;
+		return true;
+	}
+}
+
+UHitboxHistoryComponent::UHitboxHistoryComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+
+	HistorySeconds = 1.f;
+	SampleRate = 0.f;
+
+	const TPair<FName, FVector> DefaultHitboxes[] =
+	{
+		{ TEXT("head"), FVector(12.f, 12.f, 14.f) },
+		{ TEXT("spine_03"), FVector(18.f, 16.f, 22.f) },
+		{ TEXT("pelvis"), FVector(16.f, 14.f, 14.f) },
+		{ TEXT("upperarm_l"), FVector(16.f, 6.f, 6.f) },
+		{ TEXT("upperarm_r"), FVector(16.f, 6.f, 6.f) },
+		{ TEXT("thigh_l"), FVector(24.f, 8.f, 8.f) },
+		{ TEXT("thigh_r"), FVector(24.f, 8.f, 8.f) },
+	};
+
+	for (const TPair<FName, FVector>& Default : DefaultHitboxes)
+	{
+		FHitboxDefinition& Hitbox = Hitboxes.AddDefaulted_GetRef();
+		Hitbox.BoneName = Default.Key;
+		Hitbox.HalfExtent = Default.Value;
+	}
+
+	Mesh = nullptr;
+	MaxHitboxExtent = 0.f;
+	Head = 0;
+	Count = 0;
+}
+
+void UHitboxHistoryComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	//Only the server rewinds
+	if (!GetOwner()->HasAuthority())
+		return;
+
+	ACharacter* Character = Cast<ACharacter>(GetOwner());
+	Mesh = Character ? Character->GetMesh() : GetOwner()->FindComponentByClass<USkeletalMeshComponent>();
+	if (!Mesh)
+		return;
+
+	Hitboxes.SetNum(FMath::Min(Hitboxes.Num(), (int32)MaxHitboxes));
+
+	BoneIndices.Reset(Hitboxes.Num());
+	MaxHitboxExtent = 0.f;
+	for (const FHitboxDefinition& Hitbox : Hitboxes)
+	{
+		BoneIndices.Add(Mesh->GetBoneIndex(Hitbox.BoneName));
+		MaxHitboxExtent = FMath::Max(MaxHitboxExtent, Hitbox.HalfExtent.Size());
+	}
+
+	//Bones have to be posed every frame, seen or not, and read after the mesh has updated them
+	Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+	AddTickPrerequisiteComponent(Mesh);
+
+	//One snapshot per net tick, the rate shots are received at. Ticks come late, never early, so this covers HistorySeconds
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	const float Rate = SampleRate > 0.f ? SampleRate : NetDriver ? NetDriver->NetServerMaxTickRate : HitboxHistory::StandaloneSampleRate;
+	SetComponentTickInterval(1.f / FMath::Max(Rate, 1.f));
+
+	Snapshots.SetNumZeroed(FMath::Max(FMath::CeilToInt(HistorySeconds * Rate) + 1, 2));
+	Head = 0;
+	Count = 0;
+
+	UE_LOG(LogCharacterBR, Verbose, TEXT("%s hitbox history: %d snapshots at %.0f Hz, %d bytes"),
+		*GetOwner()->GetName(), Snapshots.Num(), Rate, (int32)Snapshots.GetAllocatedSize());
+
+	SetComponentTickEnabled(true);
+
+	if (UHitscanSubsystem* Hitscan = GetWorld()->GetSubsystem<UHitscanSubsystem>())
+	{
+		Hitscan->RegisterHistory(this);
+	}
+}
+
+void UHitboxHistoryComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UHitscanSubsystem* Hitscan = GetWorld()->GetSubsystem<UHitscanSubsystem>())
+	{
+		Hitscan->UnregisterHistory(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UHitboxHistoryComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	Record();
+}
+
+void UHitboxHistoryComponent::Record()
+{
+	FSnapshot& Snapshot = Snapshots[Head];
+	Snapshot.Time = GetWorld()->GetTimeSeconds();
+	Snapshot.Location = GetOwner()->GetActorLocation();
+
+	float MaxOffsetSquared = 0.f;
+
+	for (int32 Hitbox = 0; Hitbox < BoneIndices.Num(); ++Hitbox)
+	{
+		const FTransform Bone = BoneIndices[Hitbox] != INDEX_NONE ? Mesh->GetBoneTransform(BoneIndices[Hitbox]) : Mesh->GetComponentTransform();
+		MaxOffsetSquared = FMath::Max(MaxOffsetSquared, FVector::DistSquared(Bone.GetLocation(), Snapshot.Location));
+		const FVector Offset = (Bone.GetLocation() - Snapshot.Location) * HitboxHistory::OffsetScale;
+		const FRotator Rotation = Bone.Rotator();
+
+		FBoneSample& Sample = Snapshot.Bones[Hitbox];
+		Sample.Offset[0] = (int16)FMath::Clamp(FMath::RoundToInt(Offset.X), -32768, 32767);
+		Sample.Offset[1] = (int16)FMath::Clamp(FMath::RoundToInt(Offset.Y), -32768, 32767);
+		Sample.Offset[2] = (int16)FMath::Clamp(FMath::RoundToInt(Offset.Z), -32768, 32767);
+		Sample.Rotation[0] = FRotator::CompressAxisToShort(Rotation.Pitch);
+		Sample.Rotation[1] = FRotator::CompressAxisToShort(Rotation.Yaw);
+		Sample.Rotation[2] = FRotator::CompressAxisToShort(Rotation.Roll);
+	}
+
+	Snapshot.Radius = FMath::Sqrt(MaxOffsetSquared) + MaxHitboxExtent;
+
+	Head = (Head + 1) % Snapshots.Num();
+	Count = FMath::Min(Count + 1, Snapshots.Num());
+}
+
+const UHitboxHistoryComponent::FSnapshot& UHitboxHistoryComponent::GetSnapshot(int32 Age) const
+{
+	//Age 0 is the latest snapshot
+	return Snapshots[(Head - 1 - Age + Snapshots.Num() * 2) % Snapshots.Num()];
+}
+
+int32 UHitboxHistoryComponent::FindSnapshotAge(float Time) const
+{
+	//Times only grow with the ring, so they fall with age
+	int32 Low = 0;
+	int32 High = Count;
+	while (Low < High)
+	{
+		const int32 Middle = (Low + High) / 2;
+		if (GetSnapshot(Middle).Time <= Time)
+			High = Middle;
+		else
+			Low = Middle + 1;
+	}
+	return Low;
+}
+
+FTransform UHitboxHistoryComponent::DecodeBone(const FSnapshot& Snapshot, int32 Hitbox)
+{
+	const FBoneSample& Sample = Snapshot.Bones[Hitbox];
+
+	const FVector Offset(Sample.Offset[0], Sample.Offset[1], Sample.Offset[2]);
+	const FRotator Rotation(
+		FRotator::DecompressAxisFromShort(Sample.Rotation[0]),
+		FRotator::DecompressAxisFromShort(Sample.Rotation[1]),
+		FRotator::DecompressAxisFromShort(Sample.Rotation[2]));
+
+	return FTransform(Rotation, Snapshot.Location + Offset / HitboxHistory::OffsetScale);
+}
+
+bool UHitboxHistoryComponent::RewindRaycast(float Time, const FVector& Start, const FVector& End, FHitboxHit& OutHit) const
+{
+	if (Count == 0)
+		return false;
+
+	//Find the snapshots on both sides of Time
+	const int32 Newer = FMath::Clamp(FindSnapshotAge(Time) - 1, 0, Count - 1);
+
+	const FSnapshot& To = GetSnapshot(Newer);
+	const FSnapshot& From = GetSnapshot(FMath::Min(Newer + 1, Count - 1));
+	const float Alpha = To.Time > From.Time ? FMath::Clamp((Time - From.Time) / (To.Time - From.Time), 0.f, 1.f) : 1.f;
+
+	const FVector Center = FMath::Lerp(From.Location, To.Location, Alpha);
+	if (FMath::PointDistToSegmentSquared(Center, Start, End) > FMath::Square(FMath::Max(From.Radius, To.Radius)))
+		return false;
+
+	const FVector Delta = End - Start;
+	const float Length = Delta.Size();
+	if (Length < KINDA_SMALL_NUMBER)
+		return false;
+
+	const FVector Direction = Delta / Length;
+
+	bool bHit = false;
+	OutHit.Distance = Length;
+
+	for (int32 Hitbox = 0; Hitbox < BoneIndices.Num(); ++Hitbox)
+	{
+		const FTransform FromBone = DecodeBone(From, Hitbox);
+		const FTransform ToBone = DecodeBone(To, Hitbox);
+
+		const FQuat Rotation = FQuat::Slerp(FromBone.GetRotation(), ToBone.GetRotation(), Alpha);
+		const FVector Location = FMath::Lerp(FromBone.GetLocation(), ToBone.GetLocation(), Alpha);
+
+		const FVector LocalStart = Rotation.UnrotateVector(Start - Location);
+		const FVector LocalDirection = Rotation.UnrotateVector(Direction);
+
+		float Distance;
+		if (HitboxHistory::IntersectBox(LocalStart, LocalDirection, OutHit.Distance, Hitboxes[Hitbox].HalfExtent, Distance))
+		{
+			bHit = true;
+			OutHit.Distance = Distance;
+			OutHit.BoneName = Hitboxes[Hitbox].BoneName;
+			OutHit.Location = Start + Direction * Distance;
+		}
+	}
+
+	return bHit;
+}
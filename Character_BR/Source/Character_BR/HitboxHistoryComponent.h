@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "HitboxHistoryComponent.generated.h"
+
+/** Box around one bone, tested by rewound shots */
+USTRUCT(BlueprintType)
+struct FHitboxDefinition
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Hitbox")
+	FName BoneName;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Hitbox")
+	FVector HalfExtent = FVector(10.f);
+};
+
+/** Result of a rewound ray test */
+USTRUCT(BlueprintType)
+struct FHitboxHit
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Hitbox")
+	FName BoneName;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Hitbox")
+	FVector Location = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Hitbox")
+	float Distance = 0.f;
+};
+
+/**
+ * Server side history of the owner's hitboxes for lag compensation.
+ * At the server's net tick rate a quantized snapshot of the actor location and the hitbox bones is written into
+ * a ring buffer of timestamped snapshots sized once in BeginPlay, so recording never allocates.
+ * RewindRaycast finds the two snapshots around a past time, interpolates them and tests a ray against the boxes.
+ * Histories register with UHitscanSubsystem, which rewinds the shots clients send.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class CHARACTER_BR_API UHitboxHistoryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UHitboxHistoryComponent();
+
+	enum { MaxHitboxes = 8 };
+
+	/** Bones that get a hitbox, at most MaxHitboxes */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hitbox")
+	TArray<FHitboxDefinition> Hitboxes;
+
+	/** How far back shots can be rewound */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hitbox")
+	float HistorySeconds;
+
+	/** Snapshots per second, 0 follows the net driver's NetServerMaxTickRate */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Hitbox")
+	float SampleRate;
+
+	/**
+	 * Tests the segment against the hitboxes as they were at Time.
+	 * Times older than the history use the oldest snapshot, newer ones the latest.
+	 * @return true and the closest box hit
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Hitbox")
+	bool RewindRaycast(float Time, const FVector& Start, const FVector& End, FHitboxHit& OutHit) const;
+
+	FORCEINLINE int32 NumSnapshots() const { return Count; }
+
+	FORCEINLINE class USkeletalMeshComponent* GetMesh() const { return Mesh; }
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+
+	/** Bone transform relative to the actor: offset in half centimeters, rotation as compressed axes */
+	struct FBoneSample
+	{
+		int16 Offset[3];
+		uint16 Rotation[3];
+	};
+
+	struct FSnapshot
+	{
+		float Time;
+		FVector Location;
+		/** Distance from Location that holds every box, rays passing further away are skipped */
+		float Radius;
+		FBoneSample Bones[MaxHitboxes];
+	};
+
+	void Record();
+
+	/** World transform of a hitbox in the snapshot */
+	static FTransform DecodeBone(const FSnapshot& Snapshot, int32 Hitbox);
+
+	const FSnapshot& GetSnapshot(int32 Age) const;
+
+	/** Age of the newest snapshot taken at or before Time, Count when all are newer */
+	int32 FindSnapshotAge(float Time) const;
+
+	UPROPERTY(Transient)
+	class USkeletalMeshComponent* Mesh;
+
+	TArray<int32> BoneIndices;
+
+	/** Largest hitbox half extent, added to the bone offsets for the snapshot radius */
+	float MaxHitboxExtent;
+
+	TArray<FSnapshot> Snapshots;
+
+	/** Slot the next snapshot goes to */
+	int32 Head;
+
+	int32 Count;
+};
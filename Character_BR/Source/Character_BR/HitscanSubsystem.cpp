@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HitscanSubsystem.h"
+#include "CharacterBRStats.h"
+#include "Character_BR.h"
+#include "Weapon.h"
+#include "HitboxHistoryComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "Kismet/GameplayStatics.h"
+
+void UHitscanSubsystem::Deinitialize()
+{
+	QueuedShots.Reset();
+	PendingShots.Reset();
+	Records.Reset();
+	Histories.Reset();
+	HistoryOwners.Reset();
+
+	Super::Deinitialize();
+}
+
+void UHitscanSubsystem::QueueShot(AActor* Shooter, AWeapon* Weapon, const FVector& Start, const FVector& Direction, float Range, float Damage, float RewindTime)
+{
+	FShotRequest& Shot = QueuedShots.AddDefaulted_GetRef();
+	Shot.Shooter = Shooter;
+	Shot.Weapon = Weapon;
+	Shot.Start = Start;
+	Shot.End = Start + Direction.GetSafeNormal() * Range;
+	Shot.Damage = Damage;
+	Shot.RewindTime = RewindTime;
+}
+
+void UHitscanSubsystem::RegisterHistory(UHitboxHistoryComponent* History)
+{
+	if (!Histories.Contains(History))
+	{
+		Histories.Add(History);
+		HistoryOwners.Add(History->GetOwner());
+	}
+}
+
+void UHitscanSubsystem::UnregisterHistory(UHitboxHistoryComponent* History)
+{
+	const int32 Index = Histories.Find(History);
+	if (Index != INDEX_NONE)
+	{
+		Histories.RemoveAtSwap(Index);
+		HistoryOwners.RemoveAtSwap(Index);
+	}
+}
+
+FCollisionQueryParams UHitscanSubsystem::MakeTraceParams(const FShotRequest& Shot) const
+{
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(HitscanShot), true, Shot.Shooter.Get());
+	TraceParams.AddIgnoredActor(Shot.Weapon.Get());
+
+	if (Shot.RewindTime >= 0.f)
+	{
+		TraceParams.AddIgnoredActors(HistoryOwners);
+	}
+
+	return TraceParams;
+}
+
+void UHitscanSubsystem::Tick(float DeltaTime)
+{
+	CHARACTERBR_SCOPE(HitscanTick);
+
+	UWorld* World = GetWorld();
+
+	//Read back the shots traced last frame
+	Records.Reset();
+
+	for (FShotRequest& Shot : PendingShots)
+	{
+		FTraceDatum Datum;
+		if (World->QueryTraceData(Shot.Handle, Datum))
+		{
+			ResolveShot(Shot, Datum.OutHits.Num() > 0 ? &Datum.OutHits[0] : nullptr);
+			continue;
+		}
+
+		//The async batch missed this one, don't drop the shot
+		FHitResult Hit;
+		CHARACTERBR_COUNT(ShotTrace, 1);
+		const bool bHit = World->LineTraceSingleByChannel(Hit, Shot.Start, Shot.End, COLLISION_WEAPON, MakeTraceParams(Shot));
+		ResolveShot(Shot, bHit ? &Hit : nullptr);
+	}
+
+	PendingShots.Reset();
+
+	if (Records.Num() > 0)
+	{
+		OnHitsResolved.Broadcast(Records);
+	}
+
+	//Send this frame's shots as one batch
+	CHARACTERBR_COUNT(ShotTrace, QueuedShots.Num());
+	for (FShotRequest& Shot : QueuedShots)
+	{
+		Shot.Handle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Shot.Start, Shot.End, COLLISION_WEAPON, MakeTraceParams(Shot));
+	}
+
+	Swap(PendingShots, QueuedShots);
+}
+
+void UHitscanSubsystem::ResolveShot(const FShotRequest& Shot, const FHitResult* Hit)
+{
+	FHitResult RewoundHit;
+	if (Shot.RewindTime >= 0.f && RewindHitboxes(Shot, Hit, RewoundHit))
+	{
+		Hit = &RewoundHit;
+	}
+
+	AActor* Shooter = Shot.Shooter.Get();
+
+	FWeaponHitRecord& Record = Records.AddDefaulted_GetRef();
+	Record.Shooter = Shooter;
+	Record.Weapon = Shot.Weapon.Get();
+	Record.TraceStart = Shot.Start;
+	Record.Damage = Shot.Damage;
+	Record.bAuthoritative = Shooter && Shooter->HasAuthority();
+
+	const bool bBlocked = Hit && Hit->bBlockingHit;
+	Record.HitActor = bBlocked ? Hit->GetActor() : nullptr;
+	Record.ImpactPoint = bBlocked ? Hit->ImpactPoint : Shot.End;
+	Record.ImpactNormal = bBlocked ? Hit->ImpactNormal : FVector::ZeroVector;
+	Record.BoneName = bBlocked ? Hit->BoneName : NAME_None;
+
+	if (bBlocked)
+	{
+		ApplyHitDamage(Record, *Hit);
+	}
+}
+
+bool UHitscanSubsystem::RewindHitboxes(const FShotRequest& Shot, const FHitResult* WorldHit, FHitResult& OutHit) const
+{
+	//Cost of one rewound shot against every registered history, see CharacterBR.Profile
+	CHARACTERBR_SCOPE(RewindHitboxes);
+	CHARACTERBR_COUNT(HitboxRewind, Histories.Num());
+
+	const FVector End = WorldHit && WorldHit->bBlockingHit ? WorldHit->ImpactPoint : Shot.End;
+
+	const UHitboxHistoryComponent* ClosestHistory = nullptr;
+	FHitboxHit ClosestHit;
+
+	for (const UHitboxHistoryComponent* History : Histories)
+	{
+		FHitboxHit HitboxHit;
+		if (History && History->GetOwner() != Shot.Shooter.Get() && History->RewindRaycast(Shot.RewindTime, Shot.Start, End, HitboxHit)
+			&& (!ClosestHistory || HitboxHit.Distance < ClosestHit.Distance))
+		{
+			ClosestHistory = History;
+			ClosestHit = HitboxHit;
+		}
+	}
+
+	if (!ClosestHistory)
+		return false;
+
+	const FVector Direction = (End - Shot.Start).GetSafeNormal();
+	OutHit = FHitResult(ClosestHistory->GetOwner(), ClosestHistory->GetMesh(), ClosestHit.Location, -Direction);
+	OutHit.bBlockingHit = true;
+	OutHit.BoneName = ClosestHit.BoneName;
+	OutHit.TraceStart = Shot.Start;
+	OutHit.TraceEnd = Shot.End;
+	OutHit.Distance = ClosestHit.Distance;
+	OutHit.Time = ClosestHit.Distance / FMath::Max(FVector::Dist(Shot.Start, Shot.End), KINDA_SMALL_NUMBER);
+	return true;
+}
+
+void UHitscanSubsystem::ApplyHitDamage(const FWeaponHitRecord& Record, const FHitResult& Hit)
+{
+	if (!Record.bAuthoritative || !Record.HitActor || Record.Damage <= 0.f)
+		return;
+
+	const APawn* ShooterPawn = Cast<APawn>(Record.Shooter);
+	const TSubclassOf<UDamageType> DamageType = Record.Weapon ? Record.Weapon->DamageTypeClass : nullptr;
+	UGameplayStatics::ApplyPointDamage(Record.HitActor, Record.Damage, (Record.ImpactPoint - Record.TraceStart).GetSafeNormal(), Hit,
+		ShooterPawn ? ShooterPawn->GetController() : nullptr, Record.Shooter, DamageType);
+}
+
+bool UHitscanSubsystem::IsTickable() const
+{
+	return !IsTemplate() && (QueuedShots.Num() > 0 || PendingShots.Num() > 0);
+}
+
+TStatId UHitscanSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UHitscanSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+#include "Engine/NetSerialization.h"
+#include "HitscanSubsystem.generated.h"
+
+class AWeapon;
+class UHitboxHistoryComponent;
+
+/** Outcome of one hitscan shot, enough for damage, decals and impact effects */
+USTRUCT(BlueprintType)
+struct FWeaponHitRecord
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Hit")
+	AActor* Shooter = nullptr;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Hit")
+	AWeapon* Weapon = nullptr;
+
+	/** Null when the shot hit nothing */
+	UPROPERTY(BlueprintReadOnly, Category = "Hit")
+	AActor* HitActor = nullptr;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Hit")
+	FVector_NetQuantize TraceStart;
+
+	/** Impact point, or the end of the range on a miss */
+	UPROPERTY(BlueprintReadOnly, Category = "Hit")
+	FVector_NetQuantize ImpactPoint;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Hit")
+	FVector_NetQuantizeNormal ImpactNormal;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Hit")
+	FName BoneName;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Hit")
+	float Damage = 0.f;
+
+	/** Resolved where damage is applied */
+	UPROPERTY(BlueprintReadOnly, Category = "Hit")
+	bool bAuthoritative = false;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnWeaponHitsResolved, const TArray<FWeaponHitRecord>&, Records);
+
+/**
+ * Resolves every hitscan shot fired in a frame in one batch.
+ * Shots are buffered by QueueShot and sent through the async trace API at the end of the frame,
+ * which spreads them over the worker threads; the results are read back next frame,
+ * damage is applied where we have authority and OnHitsResolved hands the records to decals and effects.
+ * Shots with a rewind time trace past the characters and test their hitbox histories as the shooter saw them.
+ */
+UCLASS()
+class CHARACTER_BR_API UHitscanSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	/** A RewindTime of 0 or more is the server time the shooter saw, for shots received from clients */
+	void QueueShot(AActor* Shooter, AWeapon* Weapon, const FVector& Start, const FVector& Direction, float Range, float Damage, float RewindTime);
+
+	void RegisterHistory(UHitboxHistoryComponent* History);
+
+	void UnregisterHistory(UHitboxHistoryComponent* History);
+
+	/** Applies the record's damage to its hit actor, if the shooter has authority */
+	static void ApplyHitDamage(const FWeaponHitRecord& Record, const FHitResult& Hit);
+
+	UPROPERTY(BlueprintAssignable, Category = "Hitscan")
+	FOnWeaponHitsResolved OnHitsResolved;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+
+	struct FShotRequest
+	{
+		TWeakObjectPtr<AActor> Shooter;
+		TWeakObjectPtr<AWeapon> Weapon;
+		FVector Start;
+		FVector End;
+		float Damage;
+		float RewindTime;
+		FTraceHandle Handle;
+	};
+
+	void ResolveShot(const FShotRequest& Shot, const FHitResult* Hit);
+
+	/** Closest rewound hitbox in front of WorldHit, the trace left the characters out */
+	bool RewindHitboxes(const FShotRequest& Shot, const FHitResult* WorldHit, FHitResult& OutHit) const;
+
+	FCollisionQueryParams MakeTraceParams(const FShotRequest& Shot) const;
+
+	UPROPERTY(Transient)
+	TArray<UHitboxHistoryComponent*> Histories;
+
+	/** Owners of Histories, skipped by the traces of rewound shots */
+	UPROPERTY(Transient)
+	TArray<AActor*> HistoryOwners;
+
+	/** Queued this frame, traced at the end of it */
+	TArray<FShotRequest> QueuedShots;
+
+	/** Traced last frame, waiting for their results */
+	TArray<FShotRequest> PendingShots;
+
+	UPROPERTY(Transient)
+	TArray<FWeaponHitRecord> Records;
+};
@@ -0,0 +1,163 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "InputRecordingSubsystem.h"
+#include "Character_BR.h"
+#include "PlayerCharacter.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+
+namespace InputRecording
+{
+	static FAutoConsoleCommandWithWorld StartCommand(
+		TEXT("InputRecording.Start"),
+		TEXT("Starts recording the input of the local player characters."),
+		FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+		{
+			if (UInputRecordingSubsystem* Recorder = World ? World->GetSubsystem<UInputRecordingSubsystem>() : nullptr)
+			{
+				Recorder->StartRecording();
+			}
+		}));
+
+	static FAutoConsoleCommandWithWorldAndArgs StopCommand(
+		TEXT("InputRecording.Stop"),
+		TEXT("Stops recording and writes one file per player. Usage: InputRecording.Stop [Name]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (UInputRecordingSubsystem* Recorder = World ? World->GetSubsystem<UInputRecordingSubsystem>() : nullptr)
+			{
+				Recorder->StopRecording(Args.Num() > 0 ? Args[0] : FDateTime::Now().ToString());
+			}
+		}));
+}
+
+UInputRecordingSubsystem::UInputRecordingSubsystem()
+{
+	StartTime = 0.f;
+	bRecording = false;
+}
+
+void UInputRecordingSubsystem::Deinitialize()
+{
+	Recordings.Reset();
+	bRecording = false;
+
+	Super::Deinitialize();
+}
+
+FString UInputRecordingSubsystem::GetRecordingDirectory()
+{
+	return FPaths::ProjectSavedDir() / TEXT("InputRecordings");
+}
+
+void UInputRecordingSubsystem::StartRecording()
+{
+	Recordings.Reset();
+	StartTime = GetWorld()->GetTimeSeconds();
+	bRecording = true;
+
+	UE_LOG(LogCharacterBR, Log, TEXT("Input recording started"));
+}
+
+void UInputRecordingSubsystem::StopRecording(const FString& Name)
+{
+	if (!bRecording)
+		return;
+
+	bRecording = false;
+
+	for (int32 Index = 0; Index < Recordings.Num(); ++Index)
+	{
+		const FString Path = GetRecordingDirectory() / FString::Printf(TEXT("%s_%d.cbrinput"), *Name, Index);
+		const FPlayerInputRecording& Recording = Recordings[Index].Recording;
+
+		if (Recording.SaveToFile(Path))
+		{
+			UE_LOG(LogCharacterBR, Log, TEXT("Wrote %d inputs over %.1fs to %s"), Recording.Inputs.Num(), Recording.GetLength(), *Path);
+		}
+		else
+		{
+			UE_LOG(LogCharacterBR, Warning, TEXT("Could not write input recording %s"), *Path);
+		}
+	}
+
+	Recordings.Reset();
+}
+
+float UInputRecordingSubsystem::GetRecordingTime() const
+{
+	return GetWorld()->GetTimeSeconds() - StartTime;
+}
+
+UInputRecordingSubsystem::FActiveRecording& UInputRecordingSubsystem::FindOrAddRecording(APlayerCharacter* Character)
+{
+	for (FActiveRecording& Active : Recordings)
+	{
+		if (Active.Character == Character)
+			return Active;
+	}
+
+	//Players that show up late start where they are, idle until their first input
+	FActiveRecording& Active = Recordings.AddDefaulted_GetRef();
+	Active.Character = Character;
+	Active.Recording.StartLocation = Character->GetActorLocation();
+	Active.Recording.StartRotation = Character->GetActorRotation();
+	Active.LastControlRotation = Character->GetControlRotation();
+	Active.Recording.AddControlRotation(GetRecordingTime(), Active.LastControlRotation);
+	return Active;
+}
+
+void UInputRecordingSubsystem::RecordAction(APlayerCharacter* Character, FName Action, EInputEvent Event)
+{
+	if (!bRecording)
+		return;
+
+	FindOrAddRecording(Character).Recording.AddAction(GetRecordingTime(), Action, Event);
+}
+
+void UInputRecordingSubsystem::RecordAxis(APlayerCharacter* Character, FName Axis, float Value)
+{
+	if (!bRecording)
+		return;
+
+	FActiveRecording& Active = FindOrAddRecording(Character);
+
+	//Axes arrive every frame, only changes are kept
+	float* LastValue = Active.LastAxisValues.Find(Axis);
+	if (LastValue && *LastValue == Value)
+		return;
+
+	Active.LastAxisValues.Add(Axis, Value);
+	Active.Recording.AddAxis(GetRecordingTime(), Axis, Value);
+}
+
+void UInputRecordingSubsystem::Tick(float DeltaTime)
+{
+	const float Time = GetRecordingTime();
+
+	for (FActiveRecording& Active : Recordings)
+	{
+		const AController* Controller = Active.Character.IsValid() ? Active.Character->GetController() : nullptr;
+		if (!Controller)
+			continue;
+
+		const FRotator ControlRotation = Controller->GetControlRotation();
+		if (!ControlRotation.Equals(Active.LastControlRotation, 0.01f))
+		{
+			Active.LastControlRotation = ControlRotation;
+			Active.Recording.AddControlRotation(Time, ControlRotation);
+		}
+	}
+}
+
+bool UInputRecordingSubsystem::IsTickable() const
+{
+	return !IsTemplate() && bRecording;
+}
+
+TStatId UInputRecordingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UInputRecordingSubsystem, STATGROUP_Tickables);
+}
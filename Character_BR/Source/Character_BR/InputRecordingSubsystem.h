@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "PlayerInputRecording.h"
+#include "InputRecordingSubsystem.generated.h"
+
+class APlayerCharacter;
+
+/**
+ * Records the input of the locally controlled player characters between InputRecording.Start and
+ * InputRecording.Stop [Name], one Saved/InputRecordings/Name_N.cbrinput file per player.
+ * Replay them with the character benchmark, ?Replay=Name.
+ */
+UCLASS()
+class CHARACTER_BR_API UInputRecordingSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UInputRecordingSubsystem();
+
+	virtual void Deinitialize() override;
+
+	void StartRecording();
+
+	/** Writes every player's recording and stops */
+	void StopRecording(const FString& Name);
+
+	bool IsRecording() const { return bRecording; }
+
+	void RecordAction(APlayerCharacter* Character, FName Action, EInputEvent Event);
+
+	void RecordAxis(APlayerCharacter* Character, FName Axis, float Value);
+
+	static FString GetRecordingDirectory();
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+
+	struct FActiveRecording
+	{
+		TWeakObjectPtr<APlayerCharacter> Character;
+		FPlayerInputRecording Recording;
+		TMap<FName, float> LastAxisValues;
+		FRotator LastControlRotation;
+	};
+
+	FActiveRecording& FindOrAddRecording(APlayerCharacter* Character);
+
+	float GetRecordingTime() const;
+
+	TArray<FActiveRecording> Recordings;
+
+	float StartTime;
+
+	bool bRecording;
+};
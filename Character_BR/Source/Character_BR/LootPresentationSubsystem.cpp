@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LootPresentationSubsystem.h"
+#include "CharacterBRStats.h"
+#include "Weapon.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+ULootPresentationSubsystem::ULootPresentationSubsystem()
+{
+	SpinRate = 45.f;
+	ViewRadius = 3000.f;
+}
+
+void ULootPresentationSubsystem::Deinitialize()
+{
+	for (AWeapon* Weapon : Weapons)
+	{
+		if (Weapon) Weapon->PresentationIndex = INDEX_NONE;
+	}
+
+	Weapons.Reset();
+	Visuals.Reset();
+	Locations.Reset();
+	BaseRotations.Reset();
+	Yaws.Reset();
+
+	Super::Deinitialize();
+}
+
+void ULootPresentationSubsystem::Register(AWeapon* Weapon)
+{
+	if (!Weapon || !Weapon->SkeletalMesh || Weapon->PresentationIndex != INDEX_NONE)
+		return;
+
+	Weapon->PresentationIndex = Weapons.Add(Weapon);
+	Visuals.Add(Weapon->SkeletalMesh);
+	Locations.Add(Weapon->SkeletalMesh->GetComponentLocation());
+	BaseRotations.Add(Weapon->SkeletalMesh->GetRelativeRotation().Quaternion());
+	Yaws.Add(0.f);
+}
+
+void ULootPresentationSubsystem::Unregister(AWeapon* Weapon)
+{
+	if (!Weapon || !Weapons.IsValidIndex(Weapon->PresentationIndex) || Weapons[Weapon->PresentationIndex] != Weapon)
+		return;
+
+	const int32 Index = Weapon->PresentationIndex;
+
+	if (Visuals[Index])
+	{
+		Visuals[Index]->SetRelativeRotation(BaseRotations[Index], false, nullptr, ETeleportType::TeleportPhysics);
+	}
+
+	Weapons.RemoveAtSwap(Index, 1, false);
+	Visuals.RemoveAtSwap(Index, 1, false);
+	Locations.RemoveAtSwap(Index, 1, false);
+	BaseRotations.RemoveAtSwap(Index, 1, false);
+	Yaws.RemoveAtSwap(Index, 1, false);
+
+	if (Weapons.IsValidIndex(Index) && Weapons[Index])
+	{
+		Weapons[Index]->PresentationIndex = Index;
+	}
+
+	Weapon->PresentationIndex = INDEX_NONE;
+}
+
+void ULootPresentationSubsystem::Tick(float DeltaTime)
+{
+	CHARACTERBR_SCOPE(LootPresentationTick);
+
+	//Nobody to look at the loot on a dedicated server
+	TArray<FVector, TInlineAllocator<4>> Viewers;
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		APlayerController* PlayerController = Iterator->Get();
+		if (PlayerController && PlayerController->IsLocalController())
+		{
+			FVector Location;
+			FRotator Rotation;
+			PlayerController->GetPlayerViewPoint(Location, Rotation);
+			Viewers.Add(Location);
+		}
+	}
+
+	if (Viewers.Num() == 0)
+		return;
+
+	const float ViewRadiusSquared = ViewRadius * ViewRadius;
+	const float DeltaYaw = SpinRate * DeltaTime;
+
+	for (int32 Index = 0; Index < Visuals.Num(); ++Index)
+	{
+		bool bNearViewer = false;
+		for (const FVector& Viewer : Viewers)
+		{
+			bNearViewer |= FVector::DistSquared(Viewer, Locations[Index]) < ViewRadiusSquared;
+		}
+
+		//Blueprints may still switch bRotate off without going through SetRotate
+		USceneComponent* Visual = Visuals[Index];
+		if (!bNearViewer || !Visual || !Weapons[Index] || !Weapons[Index]->bRotate || !Visual->WasRecentlyRendered(0.2f))
+			continue;
+
+		Yaws[Index] = FMath::Fmod(Yaws[Index] + DeltaYaw, 360.f);
+		Visual->SetRelativeRotation(FQuat(FVector::UpVector, FMath::DegreesToRadians(Yaws[Index])) * BaseRotations[Index], false, nullptr, ETeleportType::TeleportPhysics);
+	}
+}
+
+bool ULootPresentationSubsystem::IsTickable() const
+{
+	return !IsTemplate() && Visuals.Num() > 0;
+}
+
+TStatId ULootPresentationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULootPresentationSubsystem, STATGROUP_Tickables);
+}
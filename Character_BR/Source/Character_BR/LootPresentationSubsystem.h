@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "LootPresentationSubsystem.generated.h"
+
+class AWeapon;
+
+/**
+ * Spins the visual of every unowned pickup in one pass per frame.
+ * Only the weapon's mesh is rotated, and only while a local viewer is close and the mesh was rendered,
+ * so dedicated servers and far away loot cost nothing.
+ */
+UCLASS()
+class CHARACTER_BR_API ULootPresentationSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	ULootPresentationSubsystem();
+
+	virtual void Deinitialize() override;
+
+	void Register(AWeapon* Weapon);
+
+	/** Stops spinning and puts the visual back to its original rotation */
+	void Unregister(AWeapon* Weapon);
+
+	/** Degrees per second */
+	float SpinRate;
+
+	/** Pickups further than this from every local viewer stay still */
+	float ViewRadius;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+
+	UPROPERTY(Transient)
+	TArray<AWeapon*> Weapons;
+
+	UPROPERTY(Transient)
+	TArray<USceneComponent*> Visuals;
+
+	TArray<FVector> Locations;
+
+	TArray<FQuat> BaseRotations;
+
+	TArray<float> Yaws;
+};
@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LootRegistrySubsystem.h"
+#include "Weapon.h"
+
+ULootRegistrySubsystem::ULootRegistrySubsystem()
+{
+	CellSize = 500.f;
+}
+
+void ULootRegistrySubsystem::Deinitialize()
+{
+	for (AWeapon* Weapon : Weapons)
+	{
+		if (Weapon) Weapon->LootIndex = INDEX_NONE;
+	}
+
+	Weapons.Reset();
+	Locations.Reset();
+	WeaponCells.Reset();
+	Cells.Reset();
+
+	Super::Deinitialize();
+}
+
+FIntPoint ULootRegistrySubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void ULootRegistrySubsystem::Register(AWeapon* Weapon)
+{
+	if (Weapon)
+	{
+		Register(Weapon, Weapon->GetActorLocation());
+	}
+}
+
+void ULootRegistrySubsystem::Register(AWeapon* Weapon, const FVector& Location)
+{
+	if (!Weapon || Weapon->LootIndex != INDEX_NONE)
+		return;
+
+	const FIntPoint Cell = GetCell(Location);
+
+	const int32 Index = Weapons.Add(Weapon);
+	Locations.Add(Location);
+	WeaponCells.Add(Cell);
+	Cells.FindOrAdd(Cell).Add(Index);
+
+	Weapon->LootIndex = Index;
+}
+
+void ULootRegistrySubsystem::Unregister(AWeapon* Weapon)
+{
+	if (!Weapon || !Weapons.IsValidIndex(Weapon->LootIndex) || Weapons[Weapon->LootIndex] != Weapon)
+		return;
+
+	const int32 Index = Weapon->LootIndex;
+	const int32 LastIndex = Weapons.Num() - 1;
+
+	TArray<int32>& Cell = Cells.FindChecked(WeaponCells[Index]);
+	Cell.RemoveSingleSwap(Index, false);
+	if (Cell.Num() == 0)
+	{
+		Cells.Remove(WeaponCells[Index]);
+	}
+
+	//The last entry moves into the freed slot
+	if (Index != LastIndex)
+	{
+		Cells.FindChecked(WeaponCells[LastIndex]).RemoveSingleSwap(LastIndex, false);
+		Cells.FindChecked(WeaponCells[LastIndex]).Add(Index);
+		if (Weapons[LastIndex]) Weapons[LastIndex]->LootIndex = Index;
+	}
+
+	Weapons.RemoveAtSwap(Index, 1, false);
+	Locations.RemoveAtSwap(Index, 1, false);
+	WeaponCells.RemoveAtSwap(Index, 1, false);
+
+	Weapon->LootIndex = INDEX_NONE;
+}
+
+AWeapon* ULootRegistrySubsystem::FindBestLoot(const FVector& Location, const FVector& Forward, float Radius, float MinDot) const
+{
+	const FIntPoint MinCell = GetCell(Location - FVector(Radius, Radius, 0.f));
+	const FIntPoint MaxCell = GetCell(Location + FVector(Radius, Radius, 0.f));
+	const FVector Forward2D = Forward.GetSafeNormal2D();
+	const float RadiusSquared = Radius * Radius;
+
+	AWeapon* BestWeapon = nullptr;
+	float BestScore = MAX_flt;
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			const TArray<int32>* Cell = Cells.Find(FIntPoint(X, Y));
+			if (!Cell)
+				continue;
+
+			for (int32 Index : *Cell)
+			{
+				const FVector Offset = Locations[Index] - Location;
+				const float DistanceSquared = Offset.SizeSquared();
+				if (DistanceSquared > RadiusSquared)
+					continue;
+
+				const float Dot = FVector::DotProduct(Offset.GetSafeNormal2D(), Forward2D);
+				if (Dot < MinDot)
+					continue;
+
+				const float Score = DistanceSquared * (2.f - Dot);
+				if (Score < BestScore && Weapons[Index])
+				{
+					BestScore = Score;
+					BestWeapon = Weapons[Index];
+				}
+			}
+		}
+	}
+
+	return BestWeapon;
+}
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LootRegistrySubsystem.generated.h"
+
+class AWeapon;
+
+/**
+ * Uniform grid over every pickup lying on the ground, so characters find loot with a few cell lookups
+ * instead of overlap events against every weapon they walk past.
+ */
+UCLASS()
+class CHARACTER_BR_API ULootRegistrySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	ULootRegistrySubsystem();
+
+	virtual void Deinitialize() override;
+
+	void Register(AWeapon* Weapon);
+
+	/** Registers the weapon as lying at Location, wherever its actor is */
+	void Register(AWeapon* Weapon, const FVector& Location);
+
+	void Unregister(AWeapon* Weapon);
+
+	/**
+	 * Best pickup within Radius of Location whose direction is at least MinDot along Forward.
+	 * Closer pickups win, and among equally close ones the one more in front.
+	 */
+	AWeapon* FindBestLoot(const FVector& Location, const FVector& Forward, float Radius, float MinDot) const;
+
+	FORCEINLINE int32 Num() const { return Weapons.Num(); }
+
+	/** Cell size of the grid (cm), keep it close to the usual query radius */
+	float CellSize;
+
+private:
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+	UPROPERTY(Transient)
+	TArray<AWeapon*> Weapons;
+
+	TArray<FVector> Locations;
+
+	TArray<FIntPoint> WeaponCells;
+
+	TMap<FIntPoint, TArray<int32>> Cells;
+};
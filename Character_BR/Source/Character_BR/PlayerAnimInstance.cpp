@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlayerAnimInstance.h"
+#include "PlayerCharacter.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+void FPlayerAnimInstanceProxy::PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds)
+{
+	FAnimInstanceProxy::PreUpdate(InAnimInstance, DeltaSeconds);
+
+	//The proxy is transient, tuning lives on the anim Blueprint
+	AimInterpSpeed = CastChecked<UPlayerAnimInstance>(InAnimInstance)->AimInterpSpeed;
+
+	const APlayerCharacter* Character = Cast<APlayerCharacter>(InAnimInstance->TryGetPawnOwner());
+	if (!Character)
+		return;
+
+	bIsAiming = Character->IsAiming;
+	bIsFiring = Character->IsFiring;
+	bBulletFire = Character->BulletFire;
+	bIsReloading = Character->IsRifleReloading;
+	bIsEquippedWeapon = Character->IsEquippedWeapon;
+	bIsEquipping = Character->IsEquipping;
+	bIsClimbing = Character->IsClimbing;
+	bClimbUp = Character->ClimbUp;
+	bIsDodging = Character->PlayMovementState == APlayerMovementState::PMS_Dodgging;
+	bIsSwimming = Character->PlayMovementState == APlayerMovementState::PMS_Swimming;
+	bIsJumping = Character->IsJumping;
+	bIsFalling = Character->GetCharacterMovement()->IsFalling();
+	bIsSprinting = Character->IsSprinting;
+	WeaponKind = Character->RightHandEquippedWeapon ? Character->RightHandEquippedWeapon->WeaponKind : EWeaponKind::EWK_AssaultRifle;
+
+	MoveForward = Character->MoveForwardValue;
+	MoveRight = Character->MoveRightValue;
+
+	Velocity = Character->GetVelocity();
+	ActorRotation = Character->GetActorRotation();
+	AimRotation = Character->GetBaseAimRotation();
+}
+
+void FPlayerAnimInstanceProxy::Update(float DeltaSeconds)
+{
+	FAnimInstanceProxy::Update(DeltaSeconds);
+
+	Speed = Velocity.Size2D();
+
+	const FMatrix RotationMatrix = FRotationMatrix(ActorRotation);
+	const FVector Forward = RotationMatrix.GetScaledAxis(EAxis::X);
+	const FVector Right = RotationMatrix.GetScaledAxis(EAxis::Y);
+	Direction = Speed > KINDA_SMALL_NUMBER ? FMath::RadiansToDegrees(FMath::Atan2(FVector::DotProduct(Velocity, Right), FVector::DotProduct(Velocity, Forward))) : 0.f;
+
+	const FRotator AimDelta = (AimRotation - ActorRotation).GetNormalized();
+	AimPitch = FMath::FInterpTo(AimPitch, FMath::Clamp(AimDelta.Pitch, -90.f, 90.f), DeltaSeconds, AimInterpSpeed);
+	AimYaw = FMath::FInterpTo(AimYaw, FMath::Clamp(AimDelta.Yaw, -90.f, 90.f), DeltaSeconds, AimInterpSpeed);
+}
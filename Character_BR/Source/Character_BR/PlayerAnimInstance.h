@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimInstance.h"
+#include "Animation/AnimInstanceProxy.h"
+#include "Weapon.h"
+#include "PlayerAnimInstance.generated.h"
+
+/**
+ * Animation data of the player character. PreUpdate copies the pawn's state on the game thread,
+ * Update derives speed, direction and aim offsets on the animation worker thread,
+ * and the anim graph reads the results through UPlayerAnimInstance::Proxy.
+ */
+USTRUCT(BlueprintType)
+struct FPlayerAnimInstanceProxy : public FAnimInstanceProxy
+{
+	GENERATED_BODY()
+
+	FPlayerAnimInstanceProxy() {}
+
+	FPlayerAnimInstanceProxy(UAnimInstance* InAnimInstance) : FAnimInstanceProxy(InAnimInstance) {}
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "State")
+	bool bIsAiming = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "State")
+	bool bIsFiring = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "State")
+	bool bBulletFire = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "State")
+	bool bIsReloading = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "State")
+	bool bIsEquippedWeapon = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "State")
+	bool bIsEquipping = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "State")
+	bool bIsClimbing = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "State")
+	bool bClimbUp = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "State")
+	bool bIsDodging = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "State")
+	bool bIsSwimming = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "State")
+	bool bIsJumping = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "State")
+	bool bIsFalling = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "State")
+	bool bIsSprinting = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "State")
+	EWeaponKind WeaponKind = EWeaponKind::EWK_AssaultRifle;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Locomotion")
+	float MoveForward = 0.f;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Locomotion")
+	float MoveRight = 0.f;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Locomotion")
+	float Speed = 0.f;
+
+	/** Angle between the velocity and the facing, -180 to 180 */
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Locomotion")
+	float Direction = 0.f;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Aim")
+	float AimPitch = 0.f;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Aim")
+	float AimYaw = 0.f;
+
+protected:
+
+	virtual void PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds) override;
+
+	virtual void Update(float DeltaSeconds) override;
+
+private:
+
+	FVector Velocity = FVector::ZeroVector;
+
+	FRotator ActorRotation = FRotator::ZeroRotator;
+
+	FRotator AimRotation = FRotator::ZeroRotator;
+
+	/** Copy of UPlayerAnimInstance::AimInterpSpeed */
+	float AimInterpSpeed = 15.f;
+};
+
+/** Anim instance of the player character, the anim graph only reads the proxy so it can update off the game thread */
+UCLASS(Transient, Blueprintable)
+class CHARACTER_BR_API UPlayerAnimInstance : public UAnimInstance
+{
+	GENERATED_BODY()
+
+public:
+
+	/** How fast the aim offsets follow the control rotation */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Aim")
+	float AimInterpSpeed = 15.f;
+
+protected:
+
+	virtual FAnimInstanceProxy* CreateAnimInstanceProxy() override { return &Proxy; }
+
+	virtual void DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy) override {}
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Animation", meta = (AllowPrivateAccess = "true"))
+	FPlayerAnimInstanceProxy Proxy;
+};
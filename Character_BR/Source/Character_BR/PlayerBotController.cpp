@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlayerBotController.h"
+#include "CharacterBRStats.h"
+#include "PlayerCharacter.h"
+#include "Engine/World.h"
+#include "Navigation/PathFollowingComponent.h"
+
+namespace PlayerBot
+{
+	static const FName MoveForward(TEXT("MoveForward"));
+	static const FName MoveRight(TEXT("MoveRight"));
+	static const FName Sprint(TEXT("Sprint"));
+	static const FName Roll(TEXT("Roll"));
+	static const FName Jump(TEXT("Jump"));
+	static const FName TakeItem(TEXT("TakeItem"));
+	static const FName EquipFirstWeapon(TEXT("EquipFirstWeapon"));
+	static const FName Fire(TEXT("Fire"));
+	static const FName Reload(TEXT("Reload"));
+}
+
+APlayerBotController::APlayerBotController(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	//Bots show up in the player list and replicate like players
+	bWantsPlayerState = true;
+
+	//The bot turns the view itself, the pawn's facing would overwrite it every tick
+	bSetControlRotationFromPawnOrientation = false;
+
+	DecisionInterval = 0.5f;
+
+	BehaviorIndex = INDEX_NONE;
+	NextDecisionTime = 0.f;
+	FireReleaseTime = 0.f;
+	ForwardValue = 0.f;
+	RightValue = 0.f;
+	bSprinting = false;
+	bJumpHeld = false;
+	bFiring = false;
+	bEquipNext = false;
+	BotCharacter = nullptr;
+}
+
+void APlayerBotController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	//Bots move through the input bindings, not the navmesh
+	if (UPathFollowingComponent* PathFollowing = GetPathFollowingComponent())
+	{
+		PathFollowing->SetComponentTickEnabled(false);
+	}
+
+	if (Behaviors.Num() == 0)
+	{
+		Behaviors.AddDefaulted();
+	}
+
+	if (BehaviorIndex == INDEX_NONE)
+	{
+		InitBot(FMath::Rand());
+	}
+}
+
+void APlayerBotController::InitBot(int32 Seed, int32 InBehaviorIndex)
+{
+	Random.Initialize(Seed);
+
+	if (Behaviors.IsValidIndex(InBehaviorIndex))
+	{
+		BehaviorIndex = InBehaviorIndex;
+		return;
+	}
+
+	float TotalWeight = 0.f;
+	for (const FBotBehavior& Behavior : Behaviors)
+	{
+		TotalWeight += FMath::Max(Behavior.Weight, 0.f);
+	}
+
+	float Pick = Random.FRand() * TotalWeight;
+	BehaviorIndex = 0;
+	for (int32 Index = 0; Index < Behaviors.Num(); ++Index)
+	{
+		Pick -= FMath::Max(Behaviors[Index].Weight, 0.f);
+		if (Pick <= 0.f)
+		{
+			BehaviorIndex = Index;
+			break;
+		}
+	}
+}
+
+int32 APlayerBotController::FindBehavior(FName Name) const
+{
+	return Behaviors.IndexOfByPredicate([Name](const FBotBehavior& Behavior) { return Behavior.Name == Name; });
+}
+
+void APlayerBotController::OnPossess(APawn* InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	BotCharacter = Cast<APlayerCharacter>(InPawn);
+
+	//Spread the decisions of bots spawned on the same frame
+	NextDecisionTime = GetWorld()->GetTimeSeconds() + Random.FRand() * DecisionInterval;
+}
+
+void APlayerBotController::OnUnPossess()
+{
+	ReleaseAll();
+	BotCharacter = nullptr;
+
+	Super::OnUnPossess();
+}
+
+void APlayerBotController::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (!BotCharacter || !Behaviors.IsValidIndex(BehaviorIndex))
+		return;
+
+	CHARACTERBR_SCOPE(BotTick);
+
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	if (bFiring && Now >= FireReleaseTime)
+	{
+		BotCharacter->InjectAction(PlayerBot::Fire, IE_Released);
+		bFiring = false;
+	}
+
+	if (Now >= NextDecisionTime)
+	{
+		NextDecisionTime = Now + DecisionInterval;
+		Decide(BotCharacter);
+	}
+
+	//Axes are sent every frame, like an input component does
+	BotCharacter->InjectAxis(PlayerBot::MoveForward, ForwardValue);
+	BotCharacter->InjectAxis(PlayerBot::MoveRight, RightValue);
+}
+
+void APlayerBotController::Decide(APlayerCharacter* Character)
+{
+	const FBotBehavior& Behavior = Behaviors[BehaviorIndex];
+
+	ForwardValue = Random.FRand() < Behavior.IdleChance ? 0.f : 1.f;
+	RightValue = Random.FRand() < Behavior.StrafeChance ? (Random.RandRange(0, 1) ? 1.f : -1.f) : 0.f;
+
+	if (Random.FRand() < Behavior.TurnChance)
+	{
+		SetControlRotation(FRotator(0.f, GetControlRotation().Yaw + Random.FRandRange(-120.f, 120.f), 0.f));
+	}
+
+	const bool bWantsSprint = ForwardValue > 0.f && Random.FRand() < Behavior.SprintChance;
+	if (bWantsSprint != bSprinting)
+	{
+		Character->InjectAction(PlayerBot::Sprint, bWantsSprint ? IE_Pressed : IE_Released);
+		bSprinting = bWantsSprint;
+	}
+
+	//A jump or climb is held for one decision
+	if (bJumpHeld)
+	{
+		Character->InjectAction(PlayerBot::Jump, IE_Released);
+		bJumpHeld = false;
+	}
+	else if (Random.FRand() < Behavior.ClimbChance)
+	{
+		Character->InjectAction(PlayerBot::Jump, IE_Pressed);
+		bJumpHeld = true;
+	}
+
+	if (Random.FRand() < Behavior.RollChance)
+	{
+		Character->InjectAction(PlayerBot::Roll, IE_Pressed);
+	}
+
+	if (!Character->GetEquippedWeapon())
+	{
+		Character->InjectAction(bEquipNext ? PlayerBot::EquipFirstWeapon : PlayerBot::TakeItem, IE_Pressed);
+		bEquipNext = !bEquipNext;
+	}
+	else if (Character->GetLoadedBullet() <= 0)
+	{
+		if (bFiring)
+		{
+			Character->InjectAction(PlayerBot::Fire, IE_Released);
+			bFiring = false;
+		}
+		Character->InjectAction(PlayerBot::Reload, IE_Pressed);
+	}
+	else if (!bFiring && Random.FRand() < Behavior.FireChance)
+	{
+		Character->InjectAction(PlayerBot::Fire, IE_Pressed);
+		bFiring = true;
+		FireReleaseTime = GetWorld()->GetTimeSeconds() + Behavior.FireDuration;
+	}
+}
+
+void APlayerBotController::ReleaseAll()
+{
+	ForwardValue = 0.f;
+	RightValue = 0.f;
+
+	if (!BotCharacter)
+		return;
+
+	if (bSprinting)
+	{
+		BotCharacter->InjectAction(PlayerBot::Sprint, IE_Released);
+	}
+	if (bJumpHeld)
+	{
+		BotCharacter->InjectAction(PlayerBot::Jump, IE_Released);
+	}
+	if (bFiring)
+	{
+		BotCharacter->InjectAction(PlayerBot::Fire, IE_Released);
+	}
+
+	bSprinting = false;
+	bJumpHeld = false;
+	bFiring = false;
+}
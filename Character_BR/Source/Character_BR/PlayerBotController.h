@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "PlayerBotController.generated.h"
+
+class APlayerCharacter;
+
+/** How often a bot does each thing, chances are rolled once per decision */
+USTRUCT()
+struct FBotBehavior
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Config)
+	FName Name;
+
+	/** Share of the bots that get this behavior, relative to the others */
+	UPROPERTY(Config)
+	float Weight = 1.f;
+
+	UPROPERTY(Config)
+	float IdleChance = 0.1f;
+
+	UPROPERTY(Config)
+	float StrafeChance = 0.3f;
+
+	UPROPERTY(Config)
+	float TurnChance = 0.3f;
+
+	UPROPERTY(Config)
+	float SprintChance = 0.3f;
+
+	UPROPERTY(Config)
+	float RollChance = 0.05f;
+
+	UPROPERTY(Config)
+	float ClimbChance = 0.1f;
+
+	UPROPERTY(Config)
+	float FireChance = 0.2f;
+
+	/** Seconds the trigger is held */
+	UPROPERTY(Config)
+	float FireDuration = 1.f;
+};
+
+/**
+ * Drives an APlayerCharacter through the same input actions and axes a player uses.
+ * Decides every DecisionInterval seconds and only replays the held axes in between,
+ * no behavior tree, perception or path following.
+ */
+UCLASS(Config = Game)
+class CHARACTER_BR_API APlayerBotController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+
+	APlayerBotController(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+	/** Seeds the bot and picks its behavior, INDEX_NONE for a weighted pick */
+	void InitBot(int32 Seed, int32 BehaviorIndex = INDEX_NONE);
+
+	int32 FindBehavior(FName Name) const;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	virtual void OnPossess(APawn* InPawn) override;
+
+	virtual void OnUnPossess() override;
+
+	UPROPERTY(Config)
+	TArray<FBotBehavior> Behaviors;
+
+	UPROPERTY(Config)
+	float DecisionInterval;
+
+private:
+
+	void Decide(APlayerCharacter* Character);
+
+	/** Lets go of every held action */
+	void ReleaseAll();
+
+	UPROPERTY(Transient)
+	APlayerCharacter* BotCharacter;
+
+	FRandomStream Random;
+
+	int32 BehaviorIndex;
+
+	float NextDecisionTime;
+
+	float FireReleaseTime;
+
+	float ForwardValue;
+
+	float RightValue;
+
+	bool bSprinting;
+
+	bool bJumpHeld;
+
+	bool bFiring;
+
+	/** Alternates picking up loot and equipping it while unarmed */
+	bool bEquipNext;
+};
@@ -1,12 +1,14 @@
 ﻿// Fill out your copyright notice in the Description page of Project Settings.
 
 #include "PlayerCharacter.h"
+#include "CharacterBRStats.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/BoxComponent.h"
 #include "Components/InputComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
+#include "GameFramework/GameStateBase.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Blueprint/UserWidget.h"
 #include "Components/SkeletalMeshComponent.h"
@@ -17,16 +19,111 @@
 #include "TimerManager.h"
 #include "DrawDebugHelpers.h"
 #include "Weapon.h"
+#include "CharacterStatusSubsystem.h"
+#include "ClimbProbeSubsystem.h"
+#include "ClimbLedgeIndexSubsystem.h"
+#include "LootRegistrySubsystem.h"
+#include "FocusTargetComponent.h"
+#include "HitboxHistoryComponent.h"
+#include "HitscanSubsystem.h"
+#include "ProjectileSubsystem.h"
+#include "WeaponDefinitionSubsystem.h"
+#include "PlayerCharacterMovementComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "Engine/AssetManager.h"
+#include "AnimationBudgetSubsystem.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "PlayerStatusViewModel.h"
+#include "PlayerStatusWidget.h"
+#include "InputRecordingSubsystem.h"
+
+
+/** Gameplay key bindings, shared by the input component and injected input */
+struct FPlayerCharacterInputBindings
+{
+	struct FAction
+	{
+		FName Name;
+		EInputEvent Event;
+		void (APlayerCharacter::*Handler)();
+	};
+
+	struct FAxis
+	{
+		FName Name;
+		void (APlayerCharacter::*Handler)(float);
+
+		/** Recorded as the control rotation it produces */
+		bool bLook;
+	};
+
+	static const TArray<FAction>& GetActions()
+	{
+		static const TArray<FAction> Actions =
+		{
+			{ TEXT("Jump"), IE_Pressed, &ACharacter::Jump },
+			{ TEXT("Jump"), IE_Pressed, &APlayerCharacter::StartClimbing },
+			{ TEXT("Jump"), IE_Released, &ACharacter::StopJumping },
+			{ TEXT("Jump"), IE_Released, &APlayerCharacter::ReleaseClimbing },
 
+			{ TEXT("Sprint"), IE_Pressed, &APlayerCharacter::Sprint },
+			{ TEXT("Sprint"), IE_Released, &APlayerCharacter::ReleaseSprint },
 
-APlayerCharacter::APlayerCharacter()
+			{ TEXT("Roll"), IE_Pressed, &APlayerCharacter::Rolling },
+
+			{ TEXT("TakeItem"), IE_Pressed, &APlayerCharacter::TakeItem },
+
+			{ TEXT("EquipFirstWeapon"), IE_Pressed, &APlayerCharacter::EquipFirstWeapon },
+			{ TEXT("EquipSecondWeapon"), IE_Pressed, &APlayerCharacter::EquipSecondWeapon },
+			{ TEXT("UnEquipWeapon"), IE_Pressed, &APlayerCharacter::UnEquipWeapon },
+
+			{ TEXT("Aiming"), IE_Pressed, &APlayerCharacter::Aiming },
+			{ TEXT("Aiming"), IE_Released, &APlayerCharacter::ReleaseAiming },
+
+			{ TEXT("Fire"), IE_Pressed, &APlayerCharacter::StartFire },
+			{ TEXT("Fire"), IE_Released, &APlayerCharacter::ReleaseFire },
+
+			{ TEXT("Reload"), IE_Pressed, &APlayerCharacter::Reload },
+
+			{ TEXT("SwitchCamera"), IE_Pressed, &APlayerCharacter::SwitchCamera },
+		};
+		return Actions;
+	}
+
+	static const TArray<FAxis>& GetAxes()
+	{
+		// We have 2 versions of the rotation bindings to handle different kinds of devices differently
+		// "turn" handles devices that provide an absolute delta, such as a mouse.
+		// "turnrate" is for devices that we choose to treat as a rate of change, such as an analog joystick
+		static const TArray<FAxis> Axes =
+		{
+			{ TEXT("MoveForward"), &APlayerCharacter::MoveForward, false },
+			{ TEXT("MoveRight"), &APlayerCharacter::MoveRight, false },
+			{ TEXT("Turn"), &APawn::AddControllerYawInput, true },
+			{ TEXT("TurnRate"), &APlayerCharacter::TurnAtRate, true },
+			{ TEXT("LookUp"), &APawn::AddControllerPitchInput, true },
+			{ TEXT("LookUpRate"), &APlayerCharacter::LookUpAtRate, true },
+		};
+		return Axes;
+	}
+};
+
+APlayerCharacter::APlayerCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer
+		.SetDefaultSubobjectClass<UPlayerCharacterMovementComponent>(ACharacter::CharacterMovementComponentName)
+		.SetDefaultSubobjectClass<USkeletalMeshComponentBudgeted>(ACharacter::MeshComponentName))
 {
+	// Stamina, health and climb probes are driven by world subsystems
+	PrimaryActorTick.bCanEverTick = false;
+
 	/**Set HP and Armor*/
 	MaxHealth = 100;
 	Health = 100;
 	MaxStamina = 100;
 	Stamina = 100;
 
+	StatusIndex = INDEX_NONE;
+
 	WeaponMaxBullet = 30;
 
 	LoadedBullet = 30;
@@ -62,6 +159,13 @@ APlayerCharacter::APlayerCharacter()
 
 	WeaponDamage = 0;
 
+	ShotCount = 0;
+	ShotAllowance = 2.f;
+	LastServerShotTime = 0.f;
+
+	MaxShotOriginOffset = 150.f;
+	MaxShotRewind = 0.3f;
+
 	IsEquipping = false;
 
 	// Set size for collision capsule
@@ -69,6 +173,17 @@ APlayerCharacter::APlayerCharacter()
 
 	InteractionCollision = CreateDefaultSubobject<UBoxComponent>(TEXT("InteractionCollision"));
 	InteractionCollision->SetupAttachment(GetRootComponent());
+	InteractionCollision->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	InteractionCollision->SetGenerateOverlapEvents(false);
+
+	LootSearchRadius = 200.f;
+	LootSearchMinDot = -0.2f;
+	LootSearchInterval = 0.2f;
+
+	FocusTarget = CreateDefaultSubobject<UFocusTargetComponent>(TEXT("FocusTarget"));
+	FocusTarget->TraceDistance = 500.f;
+
+	HitboxHistory = CreateDefaultSubobject<UHitboxHistoryComponent>(TEXT("HitboxHistory"));
 
 	ClimbReady = false;
 
@@ -82,6 +197,10 @@ APlayerCharacter::APlayerCharacter()
 	bUseControllerRotationRoll = false;
 
 	// Configure character movement
+	PlayerMovement = Cast<UPlayerCharacterMovementComponent>(GetCharacterMovement());
+	PlayerMovement->SprintSpeed = SprintSpeed;
+	PlayerMovement->AimingSpeed = AimingSpeed;
+	PlayerMovement->AimingJumpZVelocity = AimingJump;
 	GetCharacterMovement()->bOrientRotationToMovement = true; // Character moves in the direction of input...	
 	GetCharacterMovement()->RotationRate = FRotator(0.0f, 540.0f, 0.0f); // ...at this rotation rate
 	GetCharacterMovement()->JumpZVelocity = NormalJump;
@@ -98,6 +217,8 @@ APlayerCharacter::APlayerCharacter()
 	FPCamera->SetupAttachment(GetMesh(), FName("Head")); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
 	FPCamera->bUsePawnControlRotation = true; // Camera does not rotate relative to arm
 
+	// Animation rate follows the budget allocator
+	CastChecked<USkeletalMeshComponentBudgeted>(GetMesh())->SetAutoCalculateSignificance(true);
 
 	// Create a follow camera
 	TPCamera = CreateDefaultSubobject<UCameraComponent>(TEXT("TPCamera"));
@@ -120,133 +241,284 @@ void APlayerCharacter::BeginPlay()
 		}
 	}
 
-	if (PlayerStatusAsset)
-	{
-		PlayerStatus = CreateWidget<UUserWidget>(GetWorld(), PlayerStatusAsset);
-	}
-	PlayerStatus->AddToViewport();
-	PlayerStatus->SetVisibility(ESlateVisibility::Visible);
+	CreateStatusWidget();
 
 	GetCharacterMovement()->MaxWalkSpeed = NormalSpeed;
 	FPCamera->SetActive(false);
 
-	InteractionCollision->OnComponentBeginOverlap.AddDynamic(this, &APlayerCharacter::InteractionOnOverlapBegin);
-	InteractionCollision->OnComponentEndOverlap.AddDynamic(this, &APlayerCharacter::InteractionOnOverlapEnd);
+	FocusTarget->OnFocusChanged.AddDynamic(this, &APlayerCharacter::OnFocusChanged);
+	CHARACTERBR_COUNT(TimerSet, 1);
+	GetWorldTimerManager().SetTimer(LootSearchTimer, this, &APlayerCharacter::UpdateHitWeapon, LootSearchInterval, true);
 
 	GunRebound = 0.2f;
 	EquippedWeaponNumber = 0;
+
+	PreloadCharacterAssets();
+
+	UAnimationBudgetSubsystem::ConfigureCharacterMesh(this);
+
+	if (UCharacterStatusSubsystem* StatusSubsystem = GetWorld()->GetSubsystem<UCharacterStatusSubsystem>())
+	{
+		StatusSubsystem->Register(this);
+		UpdateStatusDrain();
+	}
+
+	if (UClimbProbeSubsystem* ClimbProbeSubsystem = GetWorld()->GetSubsystem<UClimbProbeSubsystem>())
+	{
+		ClimbProbeSubsystem->Register(this);
+	}
 }
 
-void APlayerCharacter::Tick(float DeltaTime)
+void APlayerCharacter::PossessedBy(AController* NewController)
 {
-	Super::Tick(DeltaTime);
-	//FindFrontObject();
-	ClimbTracer();
+	Super::PossessedBy(NewController);
+
+	UAnimationBudgetSubsystem::ConfigureCharacterMesh(this);
+	CreateStatusWidget();
+}
 
-	//Set Stamina
-	if (PlayMovementState != APlayerMovementState::PMS_Common || IsSprinting)
+void APlayerCharacter::OnRep_Controller()
+{
+	Super::OnRep_Controller();
+
+	UAnimationBudgetSubsystem::ConfigureCharacterMesh(this);
+	CreateStatusWidget();
+}
+
+void APlayerCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCharacterStatusSubsystem* StatusSubsystem = GetWorld()->GetSubsystem<UCharacterStatusSubsystem>())
 	{
-		if (PlayMovementState == APlayerMovementState::PMS_Climbing)
-		{
-			if (Stamina > 0) Stamina -= 2.5f * DeltaTime;
-			else if (Stamina <= 0) Health -= 5 * DeltaTime;
-		}
-		else if (PlayMovementState == APlayerMovementState::PMS_Dodgging)
-		{
-			if (Stamina > 0) Stamina -= 2 * DeltaTime;
-			else if (Stamina <= 0) Health -= 4 * DeltaTime;
-		}
-		else if (PlayMovementState == APlayerMovementState::PMS_Swimming)
-		{
-			if (Stamina > 0) Stamina -= 2 * DeltaTime;
-			else if (Stamina <= 0) Health -= 4 * DeltaTime;
-		}
-		else if (IsSprinting)
-		{
-			if (Stamina > 0) Stamina -= 1 * DeltaTime;
-			else if (Stamina <= 0) Health -= 2 * DeltaTime;
-		}
+		StatusSubsystem->Unregister(this);
+	}
+
+	if (UClimbProbeSubsystem* ClimbProbeSubsystem = GetWorld()->GetSubsystem<UClimbProbeSubsystem>())
+	{
+		ClimbProbeSubsystem->Unregister(this);
 	}
+
+	StopFireSound();
+
+	if (PlayerStatus)
+	{
+		PlayerStatus->RemoveFromParent();
+		PlayerStatus = nullptr;
+	}
+
+	if (CharacterAssetsHandle.IsValid())
+	{
+		CharacterAssetsHandle->ReleaseHandle();
+		CharacterAssetsHandle.Reset();
+	}
+
+	if (WeaponAssetsHandle.IsValid())
+	{
+		WeaponAssetsHandle->ReleaseHandle();
+		WeaponAssetsHandle.Reset();
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
-void APlayerCharacter::FindFrontObject()
+void APlayerCharacter::CreateStatusWidget()
 {
-	if (!IsAiming)
-	{
-		FVector Loc;
-		FRotator Rot;
-		FHitResult Hit;
+	//Only a local player gets a HUD, dedicated servers and other players' characters skip it
+	APlayerController* PlayerController = Cast<APlayerController>(Controller);
+	if (PlayerStatus || !PlayerStatusAsset || !PlayerController || !PlayerController->IsLocalController())
+		return;
 
-		GetController()->GetPlayerViewPoint(Loc, Rot);
+	PlayerStatus = CreateWidget<UUserWidget>(PlayerController, PlayerStatusAsset);
+	if (!PlayerStatus)
+		return;
 
-		TraceDistance = (IsSwitched) ? 200 : 500;
+	StatusViewModel = NewObject<UPlayerStatusViewModel>(this);
+	NotifyStatusChanged();
+	NotifyAmmoChanged();
 
-		FVector Start = Loc;
-		FVector End = Loc + (Rot.Vector() * TraceDistance);
+	if (UPlayerStatusWidget* StatusWidget = Cast<UPlayerStatusWidget>(PlayerStatus))
+	{
+		StatusWidget->SetViewModel(StatusViewModel);
+	}
 
-		FCollisionQueryParams TraceParams;
-		GetWorld()->LineTraceSingleByChannel(Hit, Start, End, ECollisionChannel::ECC_Visibility, TraceParams);
-		if (Hit.Actor != NULL && Hit.Actor != this)
-		{
-			UE_LOG(LogTemp, Log, TEXT("name : %s"), *Hit.Actor->GetName());
-			//If hit actor is Item
-			if (Hit.Actor->IsA<AWeapon>())
-			{
-				UE_LOG(LogTemp, Log, TEXT("Weapon hit"));
-				//AWeapon* HitActor = Cast<AWeapon>(Hit.Actor);	
+	PlayerStatus->AddToViewport();
+	PlayerStatus->SetVisibility(ESlateVisibility::Visible);
+}
 
-				//HitWeapon = HitActor;
-			}
-		}
-		/*else if (Hit.bBlockingHit == false)
-		{
-			HitWeapon = nullptr;
-		}*/
+void APlayerCharacter::NotifyStatusChanged()
+{
+	if (StatusViewModel)
+	{
+		StatusViewModel->SetHealth(Health, MaxHealth);
+		StatusViewModel->SetStamina(Stamina, MaxStamina);
 	}
 }
 
-void APlayerCharacter::ClimbTracer()
+void APlayerCharacter::NotifyAmmoChanged()
 {
-	if (!IsEquippedWeapon)
+	if (StatusViewModel)
 	{
-		FVector Loc;
-		FRotator Rot;
-		FHitResult Hit;
+		StatusViewModel->SetAmmo(LoadedBullet, InventoryBulletCount);
+	}
+}
 
-		Loc = GetActorLocation();
-		Rot = GetActorRotation();
-		
-		ClimbTraceDistance = 70;
+void APlayerCharacter::SetPlayerMovementStatus(APlayerMovementState Status)
+{
+	if (PlayMovementState != Status)
+	{
+		PlayMovementState = Status;
+		UpdateStatusDrain();
+	}
+}
 
-		FVector Start = FVector(Loc.X, Loc.Y, Loc.Z + 70);
-		FVector End = Loc + (FVector(Rot.Vector().X * ClimbTraceDistance, Rot.Vector().Y * ClimbTraceDistance, Rot.Vector().Z + 70));
+uint16 APlayerCharacter::GetConditions() const
+{
+	return (PlayMovementState == APlayerMovementState::PMS_Climbing ? ECharacterCondition::Climbing : 0)
+		| (PlayMovementState == APlayerMovementState::PMS_Dodgging ? ECharacterCondition::Dodging : 0)
+		| (PlayMovementState == APlayerMovementState::PMS_Swimming ? ECharacterCondition::Swimming : 0)
+		| (IsJumping ? ECharacterCondition::Jumping : 0)
+		| (GetCharacterMovement()->IsFalling() ? ECharacterCondition::Falling : 0)
+		| (IsAiming ? ECharacterCondition::Aiming : 0)
+		| (IsFiring ? ECharacterCondition::Firing : 0)
+		| (IsRifleReloading ? ECharacterCondition::Reloading : 0)
+		| (IsEquipping ? ECharacterCondition::Equipping : 0)
+		| (IsEquippedWeapon ? ECharacterCondition::Armed : 0);
+}
 
-		FCollisionQueryParams TraceParams;
-		GetWorld()->LineTraceSingleByChannel(Hit, Start, End, ECC_Visibility, TraceParams);
+void APlayerCharacter::UpdateStatusDrain()
+{
+	if (StatusIndex == INDEX_NONE)
+		return;
 
-		if (Hit.bBlockingHit && Hit.Actor != this)
-		{
-			ClimbReady = true;
-		}
-		else if (Hit.bBlockingHit == false && ClimbReady)
-		{
-			ClimbReady = false;
+	//Stamina drain, then health drain once stamina is empty
+	float StaminaDrain = 0.f;
+	float HealthDrain = 0.f;
 
-			if (PlayMovementState == APlayerMovementState::PMS_Climbing)
-			{
-				ClimbUp = true;
-				IsClimbing = false;
-				SetPlayerMovementStatus(APlayerMovementState::PMS_Common);
-				GetCharacterMovement()->SetMovementMode(MOVE_None);
-				ClimbingUpMovement();
-				ClimbingLocation = GetActorLocation();
-				ClimbingLocation.Z += 100.f;
-				SetActorLocation(ClimbingLocation);
-				GetWorld()->GetTimerManager().SetTimer(ClimbUpDelay, this, &APlayerCharacter::ClimbingUpMovement, 0.5f, false);
-				GetWorld()->GetTimerManager().SetTimer(ClimbDelay, this, &APlayerCharacter::ClimbingUp, 1.3f, false);
-			}
-		}
+	if (PlayMovementState == APlayerMovementState::PMS_Climbing)
+	{
+		StaminaDrain = 2.5f;
+		HealthDrain = 5.f;
+	}
+	else if (PlayMovementState == APlayerMovementState::PMS_Dodgging || PlayMovementState == APlayerMovementState::PMS_Swimming)
+	{
+		StaminaDrain = 2.f;
+		HealthDrain = 4.f;
+	}
+	else if (IsSprinting)
+	{
+		StaminaDrain = 1.f;
+		HealthDrain = 2.f;
+	}
+
+	GetWorld()->GetSubsystem<UCharacterStatusSubsystem>()->SetDrainRates(StatusIndex, StaminaDrain, HealthDrain);
+}
+
+void APlayerCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	//The owner already has the values it packed
+	DOREPLIFETIME_CONDITION(APlayerCharacter, ReplicatedState, COND_SkipOwner);
+
+	DOREPLIFETIME(APlayerCharacter, RightHandEquippedWeapon);
+	DOREPLIFETIME(APlayerCharacter, FirstEquippedWeapon);
+	DOREPLIFETIME(APlayerCharacter, SecondEquippedWeapon);
+}
+
+FPlayerCharacterState APlayerCharacter::PackState() const
+{
+	FPlayerCharacterState State;
+	State.SetFlag(EPlayerStateFlag::Aiming, IsAiming);
+	State.SetFlag(EPlayerStateFlag::Firing, IsFiring);
+	State.SetFlag(EPlayerStateFlag::BulletFire, BulletFire);
+	State.SetFlag(EPlayerStateFlag::Sprinting, IsSprinting);
+	State.SetFlag(EPlayerStateFlag::Jumping, IsJumping);
+	State.SetFlag(EPlayerStateFlag::Climbing, IsClimbing);
+	State.SetFlag(EPlayerStateFlag::ClimbReady, ClimbReady);
+	State.SetFlag(EPlayerStateFlag::ClimbUp, ClimbUp);
+	State.SetFlag(EPlayerStateFlag::Swimming, IsSwimming);
+	State.SetFlag(EPlayerStateFlag::Equipping, IsEquipping);
+	State.SetFlag(EPlayerStateFlag::Reloading, IsRifleReloading);
+	State.SetFlag(EPlayerStateFlag::Dodging, IsDogging);
+	State.SetFlag(EPlayerStateFlag::Switched, IsSwitched);
+	State.SetFlag(EPlayerStateFlag::EquippedWeapon, IsEquippedWeapon);
+	State.MovementState = (uint8)PlayMovementState;
+	State.EquippedWeaponNumber = (uint8)EquippedWeaponNumber;
+	return State;
+}
+
+void APlayerCharacter::UnpackState(const FPlayerCharacterState& State)
+{
+	IsAiming = State.HasFlag(EPlayerStateFlag::Aiming);
+	IsFiring = State.HasFlag(EPlayerStateFlag::Firing);
+	BulletFire = State.HasFlag(EPlayerStateFlag::BulletFire);
+	IsSprinting = State.HasFlag(EPlayerStateFlag::Sprinting);
+	IsJumping = State.HasFlag(EPlayerStateFlag::Jumping);
+	IsClimbing = State.HasFlag(EPlayerStateFlag::Climbing);
+	ClimbReady = State.HasFlag(EPlayerStateFlag::ClimbReady);
+	ClimbUp = State.HasFlag(EPlayerStateFlag::ClimbUp);
+	IsSwimming = State.HasFlag(EPlayerStateFlag::Swimming);
+	IsEquipping = State.HasFlag(EPlayerStateFlag::Equipping);
+	IsRifleReloading = State.HasFlag(EPlayerStateFlag::Reloading);
+	IsDogging = State.HasFlag(EPlayerStateFlag::Dodging);
+	IsSwitched = State.HasFlag(EPlayerStateFlag::Switched);
+	IsEquippedWeapon = State.HasFlag(EPlayerStateFlag::EquippedWeapon);
+	EquippedWeaponNumber = State.EquippedWeaponNumber;
+
+	//Sprint changes without the movement state, so the drain follows every update
+	PlayMovementState = (APlayerMovementState)State.MovementState;
+	UpdateStatusDrain();
+}
+
+void APlayerCharacter::SyncReplicatedState()
+{
+	//The server packs its own view for everyone else, an owning client only sends what it wants to do
+	if (HasAuthority())
+	{
+		ReplicatedState = PackState();
+		return;
 	}
+
+	if (!IsLocallyControlled())
+		return;
+
+	const FPlayerCharacterState State = PackState();
+	if (State == ReplicatedState)
+		return;
+
+	ReplicatedState = State;
+	ServerSetReplicatedState(State);
+}
+
+void APlayerCharacter::OnRep_ReplicatedState()
+{
+	UnpackState(ReplicatedState);
+}
+
+bool APlayerCharacter::ServerSetReplicatedState_Validate(FPlayerCharacterState NewState)
+{
+	return NewState.EquippedWeaponNumber <= 2;
+}
+
+void APlayerCharacter::ServerSetReplicatedState_Implementation(FPlayerCharacterState NewState)
+{
+	//Input intent and animation-only flags. Climbing, swimming, reloading, equipping and the weapon slot
+	//follow the server's own movement and weapon state
+	IsAiming = NewState.HasFlag(EPlayerStateFlag::Aiming) && IsEquippedWeapon;
+	IsFiring = NewState.HasFlag(EPlayerStateFlag::Firing) && IsEquippedWeapon;
+	BulletFire = NewState.HasFlag(EPlayerStateFlag::BulletFire) && IsEquippedWeapon;
+	IsSprinting = NewState.HasFlag(EPlayerStateFlag::Sprinting);
+	IsJumping = NewState.HasFlag(EPlayerStateFlag::Jumping);
+	IsDogging = NewState.HasFlag(EPlayerStateFlag::Dodging);
+	IsSwitched = NewState.HasFlag(EPlayerStateFlag::Switched);
+	UpdateStatusDrain();
+
+	ReplicatedState = PackState();
+}
+
+void APlayerCharacter::OnClimbProbeResult(bool bBlocked)
+{
+	//Reaching the ledge while climbing is handled by the movement component
+	ClimbReady = bBlocked;
 }
 
 // Called to bind functionality to input
@@ -257,43 +529,84 @@ void APlayerCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCom
 	// Set up gameplay key bindings
 	check(PlayerInputComponent);
 
-	PlayerInputComponent->BindAction("Jump", IE_Pressed, this, &ACharacter::Jump);
-	PlayerInputComponent->BindAction("Jump", IE_Pressed, this, &APlayerCharacter::StartClimbing);
-	PlayerInputComponent->BindAction("Jump", IE_Released, this, &ACharacter::StopJumping);
-	PlayerInputComponent->BindAction("Jump", IE_Released, this, &APlayerCharacter::ReleaseClimbing);
+	//Recording bindings go first and don't consume, so they see the same input as the gameplay ones
+	InputRecorder = GetWorld()->GetSubsystem<UInputRecordingSubsystem>();
+	if (InputRecorder)
+	{
+		TArray<TPair<FName, EInputEvent>, TInlineAllocator<32>> RecordedActions;
+		for (const FPlayerCharacterInputBindings::FAction& Binding : FPlayerCharacterInputBindings::GetActions())
+		{
+			if (RecordedActions.Contains(TPair<FName, EInputEvent>(Binding.Name, Binding.Event)))
+				continue;
 
-	PlayerInputComponent->BindAction("Sprint", IE_Pressed, this, &APlayerCharacter::Sprint);
-	PlayerInputComponent->BindAction("Sprint", IE_Released, this, &APlayerCharacter::ReleaseSprint);
+			RecordedActions.Emplace(Binding.Name, Binding.Event);
 
-	PlayerInputComponent->BindAction("Roll", IE_Pressed, this, &APlayerCharacter::Rolling);
+			FInputActionBinding RecordBinding(Binding.Name, Binding.Event);
+			RecordBinding.bConsumeInput = false;
+			RecordBinding.ActionDelegate.GetDelegateForManualSet().BindUObject(this, &APlayerCharacter::RecordAction, Binding.Name, Binding.Event);
+			PlayerInputComponent->AddActionBinding(RecordBinding);
+		}
 
-	PlayerInputComponent->BindAction("TakeItem", IE_Pressed, this, &APlayerCharacter::TakeItem);
+		for (const FPlayerCharacterInputBindings::FAxis& Binding : FPlayerCharacterInputBindings::GetAxes())
+		{
+			if (Binding.bLook)
+				continue;
 
-	PlayerInputComponent->BindAction("EquipFirstWeapon", IE_Pressed, this, &APlayerCharacter::EquipFirstWeapon);
-	PlayerInputComponent->BindAction("EquipSecondWeapon", IE_Pressed, this, &APlayerCharacter::EquipSecondWeapon);
-	PlayerInputComponent->BindAction("UnEquipWeapon", IE_Pressed, this, &APlayerCharacter::UnEquipWeapon);
+			FInputAxisBinding RecordBinding(Binding.Name);
+			RecordBinding.bConsumeInput = false;
+			RecordBinding.AxisDelegate.GetDelegateForManualSet().BindUObject(this, &APlayerCharacter::RecordAxis, Binding.Name);
+			PlayerInputComponent->AxisBindings.Add(RecordBinding);
+		}
+	}
 
-	PlayerInputComponent->BindAction("Aiming", IE_Pressed, this, &APlayerCharacter::Aiming);
-	PlayerInputComponent->BindAction("Aiming", IE_Released, this, &APlayerCharacter::ReleaseAiming);
+	for (const FPlayerCharacterInputBindings::FAction& Binding : FPlayerCharacterInputBindings::GetActions())
+	{
+		PlayerInputComponent->BindAction(Binding.Name, Binding.Event, this, Binding.Handler);
+	}
 
-	PlayerInputComponent->BindAction("Fire", IE_Pressed, this, &APlayerCharacter::StartFire);
-	PlayerInputComponent->BindAction("Fire", IE_Released, this, &APlayerCharacter::ReleaseFire);
+	for (const FPlayerCharacterInputBindings::FAxis& Binding : FPlayerCharacterInputBindings::GetAxes())
+	{
+		PlayerInputComponent->BindAxis(Binding.Name, this, Binding.Handler);
+	}
 
-	PlayerInputComponent->BindAction("Reload", IE_Pressed, this, &APlayerCharacter::Reload);
+}
 
-	PlayerInputComponent->BindAction("SwitchCamera", IE_Pressed, this, &APlayerCharacter::SwitchCamera); 
+void APlayerCharacter::InjectAction(FName Action, TEnumAsByte<EInputEvent> Event)
+{
+	for (const FPlayerCharacterInputBindings::FAction& Binding : FPlayerCharacterInputBindings::GetActions())
+	{
+		if (Binding.Name == Action && Binding.Event == Event)
+		{
+			(this->*Binding.Handler)();
+		}
+	}
+}
 
-	PlayerInputComponent->BindAxis("MoveForward", this, &APlayerCharacter::MoveForward);
-	PlayerInputComponent->BindAxis("MoveRight", this, &APlayerCharacter::MoveRight);
+void APlayerCharacter::RecordAction(FName Action, EInputEvent Event)
+{
+	if (InputRecorder)
+	{
+		InputRecorder->RecordAction(this, Action, Event);
+	}
+}
 
-	// We have 2 versions of the rotation bindings to handle different kinds of devices differently
-	// "turn" handles devices that provide an absolute delta, such as a mouse.
-	// "turnrate" is for devices that we choose to treat as a rate of change, such as an analog joystick
-	PlayerInputComponent->BindAxis("Turn", this, &APawn::AddControllerYawInput);
-	PlayerInputComponent->BindAxis("TurnRate", this, &APlayerCharacter::TurnAtRate);
-	PlayerInputComponent->BindAxis("LookUp", this, &APawn::AddControllerPitchInput);
-	PlayerInputComponent->BindAxis("LookUpRate", this, &APlayerCharacter::LookUpAtRate);
+void APlayerCharacter::RecordAxis(float Value, FName Axis)
+{
+	if (InputRecorder)
+	{
+		InputRecorder->RecordAxis(this, Axis, Value);
+	}
+}
 
+void APlayerCharacter::InjectAxis(FName Axis, float Value)
+{
+	for (const FPlayerCharacterInputBindings::FAxis& Binding : FPlayerCharacterInputBindings::GetAxes())
+	{
+		if (Binding.Name == Axis)
+		{
+			(this->*Binding.Handler)(Value);
+		}
+	}
 }
 
 void APlayerCharacter::TurnAtRate(float Rate)
@@ -373,51 +686,43 @@ void APlayerCharacter::MoveRight(float Value)
 
 void APlayerCharacter::Sprint()
 {
-	if (PlayMovementState == APlayerMovementState::PMS_Common && !IsAiming)
+	if (CanPerform(ECharacterAction::Sprint))
 	{
 		IsSprinting = true;
 
 		ReleaseAiming();
 
-		GetCharacterMovement()->MaxWalkSpeed = SprintSpeed;
+		PlayerMovement->bWantsToSprint = true;
+
+		UpdateStatusDrain();
 	}
 }
 
 void APlayerCharacter::ReleaseSprint()
 {
-	GetCharacterMovement()->MaxWalkSpeed = NormalSpeed;
+	PlayerMovement->bWantsToSprint = false;
 
 	Sprinted = false;
 	IsSprinting = false;
+
+	UpdateStatusDrain();
 }
 
 void APlayerCharacter::StartClimbing()
 {
-	if (ClimbReady && !IsEquippedWeapon && PlayMovementState == APlayerMovementState::PMS_Common)
+	//Answer from the ledge index right away instead of waiting for the next probe
+	UClimbLedgeIndexSubsystem* LedgeIndex = GetWorld()->GetSubsystem<UClimbLedgeIndexSubsystem>();
+	if (LedgeIndex && LedgeIndex->IsBuilt() && CanPerform(ECharacterAction::Climb))
 	{
-		IsClimbing = true;
-		SetPlayerMovementStatus(APlayerMovementState::PMS_Climbing);
-		ClimbingLocation = GetActorLocation();
-		Climbing();
+		float LedgeTop;
+		ClimbReady = LedgeIndex->FindLedge(GetActorLocation(), GetActorForwardVector(), PlayerMovement->ClimbProbeDistance, PlayerMovement->ClimbProbeHeight, LedgeTop);
 	}
-}
 
-void APlayerCharacter::Climbing()
-{
-	if (PlayMovementState == APlayerMovementState::PMS_Climbing && !IsEquippedWeapon)
-	{   
-		GetCharacterMovement()->SetMovementMode(MOVE_Flying);		
-		ClimbingMovement();
-	}
-}
-
-void APlayerCharacter::ClimbingMovement()
-{
-	if (PlayMovementState == APlayerMovementState::PMS_Climbing)
+	if (ClimbReady && CanPerform(ECharacterAction::Climb))
 	{
-		ClimbingLocation.Z += (GetWorld()->GetDeltaSeconds() * 200.f);
-		SetActorLocation(ClimbingLocation);
-		GetWorld()->GetTimerManager().SetTimer(ClimbDelay, this, &APlayerCharacter::ClimbingMovement,  GetWorld()->GetDeltaSeconds(), false);
+		//Climbing wins over the jump bound to the same key
+		StopJumping();
+		PlayerMovement->bWantsToClimb = true;
 	}
 }
 
@@ -425,18 +730,6 @@ void APlayerCharacter::ClimbingUp()
 {
 	ClimbUp = false;
 	ClimbReady = false;
-	GetCharacterMovement()->SetMovementMode(MOVE_Walking);
-}
-
-void APlayerCharacter::ClimbingUpMovement()
-{
-	if (ClimbUp)
-	{
-		ClimbingLocation = GetActorLocation();
-		ClimbingLocation += GetActorForwardVector() * 3.f;
-		SetActorLocation(ClimbingLocation);
-		GetWorld()->GetTimerManager().SetTimer(ClimbUpDelay, this, &APlayerCharacter::ClimbingUpMovement, GetWorld()->GetDeltaSeconds(), false);
-	}
 }
 
 void APlayerCharacter::ReleaseClimbing()
@@ -447,152 +740,254 @@ void APlayerCharacter::ReleaseClimbing()
 		ClimbUp = false;
 		IsClimbing = false;
 		SetPlayerMovementStatus(APlayerMovementState::PMS_Common);
-		GetCharacterMovement()->SetMovementMode(MOVE_Walking);
 	}
+
+	PlayerMovement->bWantsToClimb = false;
 }
 
 void APlayerCharacter::Rolling()
 {
-	if (GetCharacterMovement()->IsFalling() == false && IsRifleReloading == false && PlayMovementState == APlayerMovementState::PMS_Common)
+	if (CanPerform(ECharacterAction::Dodge))
 	{
-		SetPlayerMovementStatus(APlayerMovementState::PMS_Dodgging);
-		DoggingForce = 40000;
-		DoggingVector = GetActorForwardVector();
-		PlayAnimMontage(RollMontage, 1, NAME_None);
-		RollingMovement();
-		GetWorld()->GetTimerManager().SetTimer(ReleaseDoggingDelay, this, &APlayerCharacter::ReleaseRolling, 1.f, false);
+		PlayAnimMontage(GetRollMontage(), 1, NAME_None);
+		PlayerMovement->bWantsToDodge = true;
 	}
 }
 
-void APlayerCharacter::RollingMovement()
+void APlayerCharacter::OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode)
 {
-	if (PlayMovementState == APlayerMovementState::PMS_Dodgging && GetCharacterMovement()->IsFalling() == false)
+	Super::OnMovementModeChanged(PrevMovementMode, PreviousCustomMode);
+
+	//Modes are entered from replicated moves too, so the state follows the movement component
+	if (PlayerMovement->IsInCustomMode(ECustomMovementMode::CMOVE_Climbing))
+	{
+		IsClimbing = true;
+		SetPlayerMovementStatus(APlayerMovementState::PMS_Climbing);
+	}
+	else if (PlayerMovement->IsInCustomMode(ECustomMovementMode::CMOVE_ClimbingUp))
 	{
-		GetCharacterMovement()->AddImpulse(DoggingVector * DoggingForce);
-		GetWorld()->GetTimerManager().SetTimer(DoggingDelay, this, &APlayerCharacter::RollingMovement, GetWorld()->GetDeltaSeconds(), false);
+		ClimbUp = true;
+		ClimbReady = false;
+		IsClimbing = false;
+		SetPlayerMovementStatus(APlayerMovementState::PMS_Common);
+	}
+	else if (PlayerMovement->IsInCustomMode(ECustomMovementMode::CMOVE_Dodging))
+	{
+		SetPlayerMovementStatus(APlayerMovementState::PMS_Dodgging);
+	}
+	else if (PlayerMovement->MovementMode == MOVE_Swimming)
+	{
+		IsSwimming = true;
+		SetPlayerMovementStatus(APlayerMovementState::PMS_Swimming);
+	}
+
+	if (PrevMovementMode == MOVE_Swimming && PlayerMovement->MovementMode != MOVE_Swimming)
+	{
+		IsSwimming = false;
+		if (PlayMovementState == APlayerMovementState::PMS_Swimming)
+		{
+			SetPlayerMovementStatus(APlayerMovementState::PMS_Common);
+		}
+	}
+
+	if (PrevMovementMode != MOVE_Custom)
+		return;
+
+	switch ((ECustomMovementMode)PreviousCustomMode)
+	{
+	case ECustomMovementMode::CMOVE_Climbing:
+		//Dropped off the wall without reaching the ledge
+		if (PlayMovementState == APlayerMovementState::PMS_Climbing)
+		{
+			ClimbReady = false;
+			IsClimbing = false;
+			SetPlayerMovementStatus(APlayerMovementState::PMS_Common);
+		}
+		break;
+	case ECustomMovementMode::CMOVE_ClimbingUp:
+		ClimbingUp();
+		break;
+	case ECustomMovementMode::CMOVE_Dodging:
+		if (PlayMovementState == APlayerMovementState::PMS_Dodgging)
+		{
+			SetPlayerMovementStatus(APlayerMovementState::PMS_Common);
+		}
+		break;
+	default:
+		break;
 	}
 }
 
-void APlayerCharacter::ReleaseRolling()
+bool APlayerCharacter::CanReachLoot(const AWeapon* Weapon) const
 {
-	SetPlayerMovementStatus(APlayerMovementState::PMS_Common);
+	return Weapon && Weapon->LootIndex != INDEX_NONE && FVector::DistSquared(Weapon->GetActorLocation(), GetActorLocation()) <= FMath::Square(LootSearchRadius);
 }
 
-void APlayerCharacter::InteractionOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+AWeapon* APlayerCharacter::FindBestLoot() const
 {
-	if ((OtherActor != nullptr) && (OtherActor != this) && (OtherComp != nullptr))
+	//The focus trace reaches further than we can pick up
+	AWeapon* FocusWeapon = Cast<AWeapon>(FocusTarget->GetFocusActor());
+	if (CanReachLoot(FocusWeapon))
+		return FocusWeapon;
+
+	const ULootRegistrySubsystem* LootRegistry = GetWorld()->GetSubsystem<ULootRegistrySubsystem>();
+	return LootRegistry ? LootRegistry->FindBestLoot(GetActorLocation(), GetActorForwardVector(), LootSearchRadius, LootSearchMinDot) : nullptr;
+}
+
+void APlayerCharacter::UpdateHitWeapon()
+{
+	CHARACTERBR_SCOPE(UpdateHitWeapon);
+
+	//Only the local player needs a pickup prompt, TakeItem searches again on demand
+	if (IsLocallyControlled())
 	{
-		//If other actor is item
-		if (OtherActor->IsA<AWeapon>() && HitWeapon == nullptr)
-		{
-			AWeapon* OverlapWeapon = Cast<AWeapon>(OtherActor);	
+		HitWeapon = FindBestLoot();
+	}
+}
 
-			HitWeapon = OverlapWeapon;
-		}
+void APlayerCharacter::OnFocusChanged(AActor* NewFocus, AActor* OldFocus)
+{
+	if (Cast<AWeapon>(NewFocus) || Cast<AWeapon>(OldFocus))
+	{
+		UpdateHitWeapon();
 	}
 }
 
-void APlayerCharacter::InteractionOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+void APlayerCharacter::TakeItem()
 {
-	if ((OtherActor != nullptr) && (OtherActor != this) && (OtherComp != nullptr))
+	CHARACTERBR_SCOPE(TakeItem);
+
+	HitWeapon = FindBestLoot();
+
+	//Take weapon, the server owns the pickup and the slots replicate back
+	if (CanReachLoot(HitWeapon))
 	{
-		HitWeapon = nullptr;
+		if (HasAuthority())
+			PickUp(HitWeapon);
+		else
+			ServerTakeItem(HitWeapon);
 	}
+}
 
+bool APlayerCharacter::ServerTakeItem_Validate(AWeapon* Weapon)
+{
+	return true;
 }
 
-void APlayerCharacter::TakeItem()
+void APlayerCharacter::ServerTakeItem_Implementation(AWeapon* Weapon)
 {
-	//Take weapon
-	if (HitWeapon)
+	//Dropped rather than kicked, someone else may have taken it first
+	if (CanReachLoot(Weapon) && Weapon->WeaponState == EWeaponState::EWS_NoOwner)
 	{
-		if (FirstEquippedWeapon == nullptr)
-		{
-			HitWeapon->Equip(this);
-			FirstEquippedWeapon = HitWeapon;
-		}
-		else if (SecondEquippedWeapon == nullptr)
+		PickUp(Weapon);
+	}
+}
+
+void APlayerCharacter::PickUp(AWeapon* Weapon)
+{
+	if (FirstEquippedWeapon == nullptr)
+	{
+		Weapon->Equip(this);
+		FirstEquippedWeapon = Weapon;
+	}
+	else if (SecondEquippedWeapon == nullptr)
+	{
+		Weapon->Equip(this);
+		SecondEquippedWeapon = Weapon;
+	}
+	else
+	{
+		//Change Weapon
+		if (EquippedWeaponNumber == 1)
 		{
-			HitWeapon->Equip(this);
-			SecondEquippedWeapon = HitWeapon;
+			FirstEquippedWeapon = nullptr;
+			Weapon->Equip(this);
+			FirstEquippedWeapon = Weapon;
+			FirstEquippedWeapon->SetWeaponRightHand(this);
 		}
-		else
+		else if (EquippedWeaponNumber == 2)
 		{
-			//Change Weapon
-			if (EquippedWeaponNumber == 1)
-			{
-				FirstEquippedWeapon = nullptr;
-				HitWeapon->Equip(this);
-				FirstEquippedWeapon = HitWeapon;
-				FirstEquippedWeapon->SetWeaponRightHand(this);
-			}
-			else if (EquippedWeaponNumber == 2)
-			{
-				SecondEquippedWeapon = nullptr;
-				HitWeapon->Equip(this);
-				SecondEquippedWeapon = HitWeapon;
-				SecondEquippedWeapon->SetWeaponRightHand(this);
-			}
+			SecondEquippedWeapon = nullptr;
+			Weapon->Equip(this);
+			SecondEquippedWeapon = Weapon;
+			SecondEquippedWeapon->SetWeaponRightHand(this);
 		}
-		HitWeapon = nullptr;
 	}
+	HitWeapon = nullptr;
+
+	PreloadWeaponAssets();
 }
 
-void APlayerCharacter::EquipFirstWeapon()
+void APlayerCharacter::OnRep_CarriedWeapons()
 {
-	if (IsAiming == false && IsJumping == false && !IsRifleReloading && PlayMovementState == APlayerMovementState::PMS_Common && EquippedWeaponNumber != 1 && FirstEquippedWeapon && !IsEquipping)
-	{
-		ClimbReady = false;
+	PreloadWeaponAssets();
+}
 
-		if (EquipAnimMonatage)
-			PlayAnimMontage(EquipAnimMonatage, 1, NAME_None);
+void APlayerCharacter::OnRep_RightHandEquippedWeapon()
+{
+	//Remote characters only learn the weapon in hand from here
+	if (RightHandEquippedWeapon)
+		ApplyWeaponDefinition();
+	else
+		WeaponDamage = 0;
+}
 
-		IsEquipping = true;
+void APlayerCharacter::EquipFirstWeapon()
+{
+	RequestEquipWeapon(1);
+}
 
-		APawn::bUseControllerRotationYaw = true;
-		GetCharacterMovement()->bOrientRotationToMovement = false;
+void APlayerCharacter::EquipSecondWeapon()
+{
+	RequestEquipWeapon(2);
+}
 
+void APlayerCharacter::UnEquipWeapon()
+{
+	RequestEquipWeapon(0);
+}
 
-		EquippedWeaponNumber = 1;
+void APlayerCharacter::RequestEquipWeapon(int32 Number)
+{
+	if (EquipWeapon(Number) && !HasAuthority())
+	{
+		ServerEquipWeapon((uint8)Number);
+	}
+}
 
-		GetWorld()->GetTimerManager().SetTimer(EquipDelay, this, &APlayerCharacter::AttachWeapon, 0.6f, false);
+bool APlayerCharacter::ServerEquipWeapon_Validate(uint8 Number)
+{
+	return Number <= 2;
+}
 
-		//if (OnEquipSound) UGameplayStatics::PlaySound2D(this, OnEquipSound);
-	}
+void APlayerCharacter::ServerEquipWeapon_Implementation(uint8 Number)
+{
+	EquipWeapon(Number);
 }
 
-void APlayerCharacter::EquipSecondWeapon()
+bool APlayerCharacter::EquipWeapon(int32 Number)
 {
-	if (IsAiming == false && IsJumping == false && !IsRifleReloading && PlayMovementState == APlayerMovementState::PMS_Common && EquippedWeaponNumber != 2 && SecondEquippedWeapon && !IsEquipping)
-	{
-		ClimbReady = false;
+	AWeapon* Weapon = Number == 1 ? FirstEquippedWeapon : Number == 2 ? SecondEquippedWeapon : nullptr;
+	const ECharacterAction Action = Number == 0 ? ECharacterAction::UnEquip : ECharacterAction::Equip;
 
-		if (EquipAnimMonatage)
-			PlayAnimMontage(EquipAnimMonatage, 1, NAME_None);
+	if (!CanPerform(Action) || EquippedWeaponNumber == Number || (Number != 0 && !Weapon))
+		return false;
 
-		IsEquipping = true;
+	ClimbReady = false;
 
-		APawn::bUseControllerRotationYaw = true;
-		GetCharacterMovement()->bOrientRotationToMovement = false;
+	//Loads the montage here if the preload hasn't finished yet
+	if (UAnimMontage* Montage = Number == 0 ? GetUnEquipAnimMonatage() : GetEquipAnimMonatage())
+		PlayAnimMontage(Montage, 1, NAME_None);
 
-		EquippedWeaponNumber = 2;
+	IsEquipping = true;
 
-		GetWorld()->GetTimerManager().SetTimer(EquipDelay, this, &APlayerCharacter::AttachWeapon, 0.6f, false);
-		//if (OnEquipSound) UGameplayStatics::PlaySound2D(this, OnEquipSound);
+	if (Number != 0)
+	{
+		APawn::bUseControllerRotationYaw = true;
+		GetCharacterMovement()->bOrientRotationToMovement = false;
 	}
-}
-
-void APlayerCharacter::UnEquipWeapon()
-{
-	if (IsAiming == false && IsJumping == false && !IsRifleReloading && PlayMovementState == APlayerMovementState::PMS_Common && EquippedWeaponNumber != 0 && !IsEquipping)
+	else
 	{
-		ClimbReady = false;
-
-		if (UnEquipAnimMonatage)
-			PlayAnimMontage(UnEquipAnimMonatage, 1, NAME_None);
-		
-		IsEquipping = true;
-
 		if (!IsSwitched)
 		{
 			APawn::bUseControllerRotationYaw = false;
@@ -600,15 +995,21 @@ void APlayerCharacter::UnEquipWeapon()
 		}
 
 		IsEquippedWeapon = false;
-		EquippedWeaponNumber = 0;
-
-		GetWorld()->GetTimerManager().SetTimer(EquipDelay, this, &APlayerCharacter::AttachWeapon, 0.6f, false);
-		//if (OnEquipSound) UGameplayStatics::PlaySound2D(this, OnEquipSound);
 	}
+
+	EquippedWeaponNumber = Number;
+
+	CHARACTERBR_COUNT(TimerSet, 1);
+	GetWorld()->GetTimerManager().SetTimer(EquipDelay, this, &APlayerCharacter::AttachWeapon, 0.6f, false);
+	//if (OnEquipSound) UGameplayStatics::PlaySound2D(this, OnEquipSound);
+
+	return true;
 }
 
 void APlayerCharacter::AttachWeapon()
 {
+	CHARACTERBR_SCOPE(AttachWeapon);
+
 	if (EquippedWeaponNumber == 1)
 	{
 		IsEquipping = false;
@@ -621,17 +1022,7 @@ void APlayerCharacter::AttachWeapon()
 		RightHandEquippedWeapon = FirstEquippedWeapon;
 		RightHandEquippedWeapon->SetWeaponRightHand(this);
 
-		WeaponDamage = RightHandEquippedWeapon->Damage;
-
-		//check rifle
-		if (RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWK_AssaultRifle)
-		{
-			MaxContinuityFire = 3;
-		}
-		else if (RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWk_HandGun)
-		{
-			MaxContinuityFire = 1;
-		}
+		ApplyWeaponDefinition();
 	}
 	else if (EquippedWeaponNumber == 2)
 	{
@@ -645,17 +1036,7 @@ void APlayerCharacter::AttachWeapon()
 		RightHandEquippedWeapon = SecondEquippedWeapon;
 		RightHandEquippedWeapon->SetWeaponRightHand(this);
 
-		WeaponDamage = RightHandEquippedWeapon->Damage;
-
-		//check rifle
-		if (RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWK_AssaultRifle)
-		{
-			MaxContinuityFire = 3;
-		}
-		else if (RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWk_HandGun)
-		{
-			MaxContinuityFire = 1;
-		}
+		ApplyWeaponDefinition();
 	}
 	else if (EquippedWeaponNumber == 0)
 	{
@@ -673,13 +1054,122 @@ void APlayerCharacter::AttachWeapon()
 	}
 }
 
+void APlayerCharacter::ApplyWeaponDefinition()
+{
+	EquippedWeaponDefinition = ResolveWeaponDefinition(RightHandEquippedWeapon->WeaponKind);
+
+	WeaponDamage = RightHandEquippedWeapon->bOverrideDamage ? RightHandEquippedWeapon->Damage : EquippedWeaponDefinition.Damage;
+	MaxContinuityFire = EquippedWeaponDefinition.BurstCount;
+	GunRebound = EquippedWeaponDefinition.Recoil;
+	WeaponMaxBullet = EquippedWeaponDefinition.MagazineSize;
+
+	//Rounds that don't fit the smaller magazine go back to the inventory
+	if (LoadedBullet > WeaponMaxBullet)
+	{
+		InventoryBulletCount += LoadedBullet - WeaponMaxBullet;
+		LoadedBullet = WeaponMaxBullet;
+		NotifyAmmoChanged();
+	}
+}
+
+FWeaponDefinition APlayerCharacter::ResolveWeaponDefinition(EWeaponKind Kind) const
+{
+	FWeaponDefinition Definition = GetGameInstance()->GetSubsystem<UWeaponDefinitionSubsystem>()->Get(Kind);
+
+	//Rows without montages keep using the ones set on the character Blueprint
+	const bool bHandGun = Kind == EWeaponKind::EWk_HandGun;
+	if (Definition.FireMontage.IsNull())
+		Definition.FireMontage = bHandGun ? FireHandGunAnimMontage : FireAnimMontage;
+	if (Definition.ReloadMontage.IsNull())
+		Definition.ReloadMontage = bHandGun ? HandGunReloadingAnimMontage : RifleReloadingAnimMontage;
+
+	return Definition;
+}
+
+UAnimMontage* APlayerCharacter::GetRollMontage() const
+{
+	return RollMontage.LoadSynchronous();
+}
+
+UAnimMontage* APlayerCharacter::GetEquipAnimMonatage() const
+{
+	return EquipAnimMonatage.LoadSynchronous();
+}
+
+UAnimMontage* APlayerCharacter::GetUnEquipAnimMonatage() const
+{
+	return UnEquipAnimMonatage.LoadSynchronous();
+}
+
+UAnimMontage* APlayerCharacter::GetFireAnimMontage() const
+{
+	return FireAnimMontage.LoadSynchronous();
+}
+
+UAnimMontage* APlayerCharacter::GetFireHandGunAnimMontage() const
+{
+	return FireHandGunAnimMontage.LoadSynchronous();
+}
+
+UAnimMontage* APlayerCharacter::GetRifleReloadingAnimMontage() const
+{
+	return RifleReloadingAnimMontage.LoadSynchronous();
+}
+
+UAnimMontage* APlayerCharacter::GetHandGunReloadingAnimMontage() const
+{
+	return HandGunReloadingAnimMontage.LoadSynchronous();
+}
+
+USoundCue* APlayerCharacter::GetOnEquipSound() const
+{
+	return OnEquipSound.LoadSynchronous();
+}
+
+void APlayerCharacter::PreloadCharacterAssets()
+{
+	TArray<FSoftObjectPath> Paths;
+	for (const FSoftObjectPath& Path : { RollMontage.ToSoftObjectPath(), EquipAnimMonatage.ToSoftObjectPath(), UnEquipAnimMonatage.ToSoftObjectPath(), OnEquipSound.ToSoftObjectPath() })
+	{
+		if (!Path.IsNull())
+			Paths.AddUnique(Path);
+	}
+
+	if (Paths.Num() > 0)
+	{
+		CharacterAssetsHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Paths);
+	}
+}
+
+void APlayerCharacter::PreloadWeaponAssets()
+{
+	TArray<FSoftObjectPath> Paths;
+	AWeapon* const CarriedWeapons[] = { FirstEquippedWeapon, SecondEquippedWeapon };
+	for (const AWeapon* Weapon : CarriedWeapons)
+	{
+		if (Weapon)
+		{
+			ResolveWeaponDefinition(Weapon->WeaponKind).GetAssetPaths(Paths);
+			Weapon->GetAssetPaths(Paths);
+		}
+	}
+
+	//The new request holds the shared assets before the old one lets go, so only a dropped weapon's assets unload
+	TSharedPtr<FStreamableHandle> PreviousHandle = WeaponAssetsHandle;
+	WeaponAssetsHandle = Paths.Num() > 0 ? UAssetManager::GetStreamableManager().RequestAsyncLoad(Paths) : nullptr;
+
+	if (PreviousHandle.IsValid())
+	{
+		PreviousHandle->ReleaseHandle();
+	}
+}
+
 void APlayerCharacter::Aiming()
 {
 	if (!RightHandEquippedWeapon)
 		return;
 
-	if ((RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWK_AssaultRifle)
-		&& !IsRifleReloading && PlayMovementState == APlayerMovementState::PMS_Common && !IsEquipping)
+	if (EquippedWeaponDefinition.bCanAim && CanPerform(ECharacterAction::Aim))
 	{
 		if (IsSprinting)
 		{
@@ -689,9 +1179,9 @@ void APlayerCharacter::Aiming()
 
 		IsAiming = true;
 		//GetWeaponAimSocket();
+		FocusTarget->SetTraceEnabled(false);
 		
-		GetCharacterMovement()->MaxWalkSpeed = AimingSpeed;
-		GetCharacterMovement()->JumpZVelocity = AimingJump;
+		PlayerMovement->bWantsToAim = true;
 	}
 }
 
@@ -700,21 +1190,19 @@ void APlayerCharacter::ReleaseAiming()
 	if (!RightHandEquippedWeapon)
 		return;
 
-	if (RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWK_AssaultRifle)
+	if (EquippedWeaponDefinition.bCanAim)
 	{
 		if (Sprinted)
 		{
 			Sprinted = false;
 			IsSprinting = true;
-			GetCharacterMovement()->MaxWalkSpeed = SprintSpeed;
-		}
-		else
-		{
-			GetCharacterMovement()->MaxWalkSpeed = NormalSpeed;
-			GetCharacterMovement()->JumpZVelocity = NormalJump;
+			PlayerMovement->bWantsToSprint = true;
+			UpdateStatusDrain();
 		}
 
+		PlayerMovement->bWantsToAim = false;
 		IsAiming = false;
+		FocusTarget->SetTraceEnabled(true);
 	}
 }
 
@@ -723,9 +1211,7 @@ void APlayerCharacter::StartFire()
 	if (!RightHandEquippedWeapon)
 		return;
 
-	if (FireAnimMontage 
-		&& (RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWk_HandGun || RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWK_AssaultRifle) 
-		&& !IsRifleReloading && LoadedBullet > 0)
+	if (EquippedWeaponDefinition.bCanFire && CanPerform(ECharacterAction::Fire) && LoadedBullet > 0)
 	{
 		ContinuityFire = 0;
 		IsFiring = true;
@@ -735,27 +1221,63 @@ void APlayerCharacter::StartFire()
 
 void APlayerCharacter::Fire()
 {
+	CHARACTERBR_SCOPE(Fire);
+
 	if (PlayMovementState == APlayerMovementState::PMS_Dodgging && IsFiring)
 	{
-		GetWorld()->GetTimerManager().SetTimer(FireDelay, this, &APlayerCharacter::Fire, 0.1f, false);
+		CHARACTERBR_COUNT(TimerSet, 1);
+		GetWorld()->GetTimerManager().SetTimer(FireDelay, this, &APlayerCharacter::Fire, EquippedWeaponDefinition.GetFireInterval(), false);
 		return;
 	}
-	if (FireAnimMontage && IsFiring && !IsRifleReloading && LoadedBullet > 0 && ContinuityFire < MaxContinuityFire)
+	if (EquippedWeaponDefinition.bCanFire && IsFiring && CanPerform(ECharacterAction::Fire) && LoadedBullet > 0 && ContinuityFire < MaxContinuityFire)
 	{	
 		AddControllerPitchInput(-1 * GunRebound * BaseTurnRate * GetWorld()->GetDeltaSeconds());
 
 		ContinuityFire++;
 		BulletFire = true;
-		if(RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWk_HandGun) PlayAnimMontage(FireHandGunAnimMontage, 1, NAME_None);
-		if(RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWK_AssaultRifle) PlayAnimMontage(FireAnimMontage, 1, NAME_None);
+		PlayAnimMontage(EquippedWeaponDefinition.FireMontage.LoadSynchronous(), 1, NAME_None);
 		RightHandEquippedWeapon->PlayFireMontage();
-		GetWorld()->GetTimerManager().SetTimer(FireDelay, this, &APlayerCharacter::Fire, 0.1f, false);
+		PlayFireSound();
+		FireShot();
+		CHARACTERBR_COUNT(TimerSet, 1);
+		GetWorld()->GetTimerManager().SetTimer(FireDelay, this, &APlayerCharacter::Fire, EquippedWeaponDefinition.GetFireInterval(), false);
 		LoadedBullet--;
+		NotifyAmmoChanged();
 	}
-	else if (LoadedBullet <= 0)
+	else
 	{
-		BulletFire = false;
-		Reload();
+		StopFireSound();
+
+		if (LoadedBullet <= 0)
+		{
+			BulletFire = false;
+			Reload();
+		}
+	}
+}
+
+void APlayerCharacter::PlayFireSound()
+{
+	UWeaponAudioSubsystem* WeaponAudio = GetWorld()->GetSubsystem<UWeaponAudioSubsystem>();
+	if (!WeaponAudio)
+		return;
+
+	const FWeaponDefinition& Definition = EquippedWeaponDefinition;
+	if (!WeaponAudio->UsesLoop(Definition, MaxContinuityFire))
+	{
+		WeaponAudio->PlayOneShot(Definition.WeaponKind, Definition.FireSound.Get(), RightHandEquippedWeapon->GetActorLocation(), this);
+	}
+	else if (!FireLoopVoice.IsValid())
+	{
+		FireLoopVoice = WeaponAudio->StartLoop(Definition.WeaponKind, Definition.FireLoopSound.Get(), RightHandEquippedWeapon->SkeletalMesh, this);
+	}
+}
+
+void APlayerCharacter::StopFireSound()
+{
+	if (UWeaponAudioSubsystem* WeaponAudio = GetWorld()->GetSubsystem<UWeaponAudioSubsystem>())
+	{
+		WeaponAudio->StopLoop(FireLoopVoice, EquippedWeaponDefinition.FireEndSound.Get(), this);
 	}
 }
 
@@ -764,37 +1286,172 @@ void APlayerCharacter::ReleaseFire()
 	if (!RightHandEquippedWeapon)
 		return;
 
-	if (FireAnimMontage 
-		&& (RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWk_HandGun || RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWK_AssaultRifle))
+	if (EquippedWeaponDefinition.bCanFire)
 	{
 		BulletFire = false;
 		IsFiring = false;
+		StopFireSound();
 	}
 }
 
+void APlayerCharacter::FireShot()
+{
+	if (!Controller || !RightHandEquippedWeapon)
+		return;
+
+	FVector Start;
+	FRotator Rotation;
+	Controller->GetPlayerViewPoint(Start, Rotation);
+	const FVector Direction = Rotation.Vector();
+
+	//Resolved locally for effects, the server's copy applies the damage
+	const int32 Seed = ShotCount++;
+	EmitShot(Start, Direction, Seed, -1.f);
+
+	if (!HasAuthority())
+	{
+		//The server time our view of the other characters was replicated at
+		const AGameStateBase* GameState = GetWorld()->GetGameState();
+		ServerFireShot(Start, Direction, GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds(), Seed);
+	}
+}
+
+bool APlayerCharacter::ServerFireShot_Validate(FVector_NetQuantize Start, FVector_NetQuantizeNormal Direction, float ShotTime, int32 Seed)
+{
+	return Direction.IsNormalized() && Seed >= 0;
+}
+
+void APlayerCharacter::ServerFireShot_Implementation(FVector_NetQuantize Start, FVector_NetQuantizeNormal Direction, float ShotTime, int32 Seed)
+{
+	//Lost shots skip seeds, late or repeated ones can't reuse a spread the client liked
+	if (Seed < ShotCount)
+		return;
+
+	ShotCount = Seed + 1;
+
+	if (!RightHandEquippedWeapon || RightHandEquippedWeapon->GetOwner() != this || !EquippedWeaponDefinition.bCanFire)
+		return;
+
+	//The view is the third person camera at the end of the boom, or the head camera inside its reach
+	const float MaxOriginDistance = CameraBoom->TargetArmLength + CameraBoom->SocketOffset.Size() + CameraBoom->TargetOffset.Size() + MaxShotOriginOffset;
+	if (FVector::DistSquared(Start, CameraBoom->GetComponentLocation()) > FMath::Square(MaxOriginDistance))
+		return;
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	ShotAllowance = FMath::Min(ShotAllowance + (Now - LastServerShotTime) / EquippedWeaponDefinition.GetFireInterval(), 2.f);
+	LastServerShotTime = Now;
+	if (ShotAllowance < 1.f)
+		return;
+
+	//Our reload started half a round trip after the client's, as did this shot, so only jitter is left to wait for
+	if (IsRifleReloading && GetWorldTimerManager().GetTimerRemaining(ReloadDelay) <= EquippedWeaponDefinition.GetFireInterval())
+	{
+		GetWorldTimerManager().ClearTimer(ReloadDelay);
+		FinishReload();
+	}
+
+	if (IsRifleReloading || LoadedBullet <= 0)
+		return;
+
+	ShotAllowance -= 1.f;
+	LoadedBullet--;
+	NotifyAmmoChanged();
+
+	//Lag compensation, but never further back than MaxShotRewind or into the future
+	EmitShot(Start, Direction, Seed, FMath::Clamp(ShotTime, FMath::Max(Now - MaxShotRewind, 0.f), Now));
+}
+
+void APlayerCharacter::EmitShot(const FVector& Start, const FVector& Direction, int32 Seed, float RewindTime)
+{
+	CHARACTERBR_SCOPE(EmitShot);
+
+	AWeapon* Weapon = RightHandEquippedWeapon;
+	const FWeaponDefinition& Definition = EquippedWeaponDefinition;
+
+	UProjectileSubsystem* Projectiles = GetWorld()->GetSubsystem<UProjectileSubsystem>();
+	UHitscanSubsystem* Hitscan = GetWorld()->GetSubsystem<UHitscanSubsystem>();
+
+	const float SpreadRadians = FMath::DegreesToRadians(Definition.SpreadAngle);
+	const float Damage = Weapon && Weapon->bOverrideDamage ? Weapon->Damage : Definition.Damage;
+
+	//Client and server draw the same pellets, and replays the same spread
+	FRandomStream Spread(Seed);
+
+	for (int32 Pellet = 0; Pellet < Definition.PelletCount; ++Pellet)
+	{
+		const FVector PelletDirection = SpreadRadians > 0.f ? Spread.VRandCone(Direction, SpreadRadians) : Direction;
+
+		if (Definition.MuzzleSpeed > 0.f)
+		{
+			if (Projectiles)
+				Projectiles->Fire(this, Weapon, Start, PelletDirection * Definition.MuzzleSpeed, Damage, Definition.ProjectileDrag, Definition.ProjectileLifetime);
+		}
+		else if (Hitscan)
+		{
+			Hitscan->QueueShot(this, Weapon, Start, PelletDirection, Definition.Range, Damage, RewindTime);
+		}
+	}
+}
+
+float APlayerCharacter::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+{
+	const float ActualDamage = Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
+	if (ActualDamage <= 0.f)
+		return ActualDamage;
+
+	//Every damage type lands here, Blueprint damage events are only notified
+	const float NewHealth = FMath::Max(Health - ActualDamage, 0.f);
+
+	UCharacterStatusSubsystem* StatusSubsystem = GetWorld()->GetSubsystem<UCharacterStatusSubsystem>();
+	if (StatusSubsystem && StatusIndex != INDEX_NONE)
+	{
+		StatusSubsystem->SetHealth(StatusIndex, NewHealth);
+	}
+	else
+	{
+		Health = NewHealth;
+		NotifyStatusChanged();
+	}
+
+	return ActualDamage;
+}
+
 void APlayerCharacter::Reload()
 {
-	if (!RightHandEquippedWeapon || IsRifleReloading)
+	CHARACTERBR_SCOPE(Reload);
+
+	if (!RightHandEquippedWeapon || !CanPerform(ECharacterAction::Reload))
 		return;
 
-	if ((LoadedBullet == WeaponMaxBullet || InventoryBulletCount == 0)
-		&& (RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWk_HandGun || RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWK_AssaultRifle)
-		&& (PlayMovementState != APlayerMovementState::PMS_Common || PlayMovementState != APlayerMovementState::PMS_Swimming))
+	if (LoadedBullet >= WeaponMaxBullet || InventoryBulletCount == 0)
 		return;
 
 	ReleaseAiming();
 	BulletFire = false;
 	IsRifleReloading = true;
-	if (RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWK_AssaultRifle)
+	PlayAnimMontage(EquippedWeaponDefinition.ReloadMontage.LoadSynchronous(), 1, NAME_None);
+	if (UWeaponAudioSubsystem* WeaponAudio = GetWorld()->GetSubsystem<UWeaponAudioSubsystem>())
 	{
-		PlayAnimMontage(RifleReloadingAnimMontage, 1, NAME_None);
+		WeaponAudio->PlayOneShot(EquippedWeaponDefinition.WeaponKind, EquippedWeaponDefinition.ReloadSound.Get(), RightHandEquippedWeapon->GetActorLocation(), this);
 	}
-	else if (RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWk_HandGun)
+
+	CHARACTERBR_COUNT(TimerSet, 1);
+	GetWorld()->GetTimerManager().SetTimer(ReloadDelay, this, &APlayerCharacter::FinishReload, EquippedWeaponDefinition.ReloadTime, false);
+
+	if (!HasAuthority())
 	{
-		PlayAnimMontage(HandGunReloadingAnimMontage, 1, NAME_None);
+		ServerReload();
 	}
+}
 
-	GetWorld()->GetTimerManager().SetTimer(ReloadDelay, this, &APlayerCharacter::FinishReload, 2.5f, false);
+bool APlayerCharacter::ServerReload_Validate()
+{
+	return true;
+}
+
+void APlayerCharacter::ServerReload_Implementation()
+{
+	Reload();
 }
 
 void APlayerCharacter::FinishReload()
@@ -803,22 +1460,25 @@ void APlayerCharacter::FinishReload()
 	
 	InventoryBulletCount -= ReloadBullet;
 	LoadedBullet += ReloadBullet;
+	NotifyAmmoChanged();
 
 	IsRifleReloading = false;
-	if (IsFiring)
+
+	//The server's copy only refills, the owner keeps the trigger
+	if (IsFiring && IsLocallyControlled())
 		Fire();
 }
 
 void APlayerCharacter::SwitchCamera()
 {
-	if (IsAiming == false && IsFiring == false)
+	if (CanPerform(ECharacterAction::SwitchCamera))
 	{
 		TPCamera->SetFieldOfView(70);
 		if (IsSwitched)
 		{
 			if (RightHandEquippedWeapon)
 			{
-				if (!(RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWk_HandGun || RightHandEquippedWeapon->WeaponKind == EWeaponKind::EWK_AssaultRifle))
+				if (!EquippedWeaponDefinition.bCanFire)
 				{
 					APawn::bUseControllerRotationYaw = false;
 					GetCharacterMovement()->bOrientRotationToMovement = true;
@@ -837,6 +1497,9 @@ void APlayerCharacter::SwitchCamera()
 			FPCamera->SetActive(true);
 			IsSwitched = true;
 		}
+
+		FocusTarget->TraceDistance = (IsSwitched) ? 200 : 500;
+		FocusTarget->Invalidate();
 	}
 }
 
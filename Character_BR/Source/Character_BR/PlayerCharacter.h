@@ -4,6 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "PlayerCharacterState.h"
+#include "CharacterActionTable.h"
+#include "WeaponDefinition.h"
+#include "WeaponAudioSubsystem.h"
+#include "Engine/StreamableManager.h"
 #include "PlayerCharacter.generated.h"
 
 UENUM(BlueprintType)
@@ -32,15 +37,27 @@ class CHARACTER_BR_API APlayerCharacter : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	class UCameraComponent* TPCamera;
 
+	/** Movement component with the climbing and dodging modes */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true"))
+	class UPlayerCharacterMovementComponent* PlayerMovement;
+
+	/** Actor under our view, traced on a budget by UFocusTargetSubsystem */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Interaction, meta = (AllowPrivateAccess = "true"))
+	class UFocusTargetComponent* FocusTarget;
+
+	/** Past hitbox poses, for rewinding shots on the server */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	class UHitboxHistoryComponent* HitboxHistory;
+
 public:
 
 	// Sets default values for this character's properties
-	APlayerCharacter();
+	APlayerCharacter(const FObjectInitializer& ObjectInitializer);
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Movemnet")
 	APlayerMovementState PlayMovementState;
 
-	FORCEINLINE void SetPlayerMovementStatus(APlayerMovementState Status) { PlayMovementState = Status; }
+	void SetPlayerMovementStatus(APlayerMovementState Status);
 
 	int NormalSpeed;
 
@@ -55,12 +72,6 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Animation)
 	bool IsEquippedWeapon;
 
-	FVector ClimbingLocation;
-
-	float ClimbTraceDistance;
-
-	float TraceDistance;
-
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Collision)
 	bool ClimbReady;
 
@@ -70,23 +81,11 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	bool IsClimbing;
 
-	FTimerHandle ClimbDelay;
-
-	FTimerHandle ClimbUpDelay;
-
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Animations)
-	UAnimMontage* RollMontage;
+	TSoftObjectPtr<UAnimMontage> RollMontage;
 
 	bool IsDogging;
 
-	FVector DoggingVector;
-	int DoggingForce;
-
-	FTimerHandle DoggingDelay;
-	FTimerHandle ReleaseDoggingDelay;
-
-	FVector DoggingLocation;
-
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	bool IsSwimming;
 
@@ -99,17 +98,37 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = PlayerStat)
 	float MaxStamina;
 
-	//void TakeDamage(float DamageAmount, APlayerCharacter* PlayerCharacter);
+	/** Slot in UCharacterStatusSubsystem, which drains Stamina and Health for us */
+	int32 StatusIndex;
 
+	/** Lowers Health by the damage of any type, through UCharacterStatusSubsystem when registered */
+	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, AActor* DamageCauser) override;
+
+	/** How much further than the camera boom reaches a client's shot may start, for movement since it was fired. Shots from further out are dropped */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Weapon)
+	float MaxShotOriginOffset;
+
+	/** Furthest back the server rewinds the hitboxes for a client's shot */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Weapon)
+	float MaxShotRewind;
+
+	/** Kept for the Blueprints, pickups are found through ULootRegistrySubsystem and the box generates no overlaps */
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Interaction")
 	class UBoxComponent* InteractionCollision;
 
-	//Weapon
-	UFUNCTION()
-	void InteractionOnOverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+	/** How far around us pickups are found */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interaction")
+	float LootSearchRadius;
 
-	UFUNCTION()
-	void InteractionOnOverlapEnd(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
+	/** Minimum facing (dot product) towards a pickup, -1 takes pickups behind us too */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interaction")
+	float LootSearchMinDot;
+
+	/** How often HitWeapon is refreshed for the local player */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interaction")
+	float LootSearchInterval;
+
+	FTimerHandle LootSearchTimer;
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Weapon)
 	int WeaponDamage;
@@ -117,23 +136,24 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Weapon)
 	int EquippedWeaponNumber;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Weapon)
+	/** Pickups and equips are made by the server, the owner predicts them and the others follow the replicated slots */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, ReplicatedUsing = OnRep_RightHandEquippedWeapon, Category = Weapon)
 	class AWeapon* RightHandEquippedWeapon;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Weapon)
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, ReplicatedUsing = OnRep_CarriedWeapons, Category = Weapon)
 	class AWeapon* FirstEquippedWeapon;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Weapon)
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, ReplicatedUsing = OnRep_CarriedWeapons, Category = Weapon)
 	class AWeapon* SecondEquippedWeapon;
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Weapon)
 	class AWeapon* HitWeapon;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Animations)
-	UAnimMontage* EquipAnimMonatage;
+	TSoftObjectPtr<UAnimMontage> EquipAnimMonatage;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Animations)
-	UAnimMontage* UnEquipAnimMonatage;
+	TSoftObjectPtr<UAnimMontage> UnEquipAnimMonatage;
 
 	bool IsEquipping;
 
@@ -148,6 +168,18 @@ public:
 	UPROPERTY()
 	UUserWidget* PlayerStatus;
 
+	/** Values shown by PlayerStatus, only exists for the local player */
+	UPROPERTY(Transient, BlueprintReadOnly, Category = Widgets)
+	class UPlayerStatusViewModel* StatusViewModel;
+
+	/** Creates the status HUD once a local player controls the character */
+	void CreateStatusWidget();
+
+	/** Pushes Health and Stamina to the HUD, which ignores changes smaller than its step */
+	void NotifyStatusChanged();
+
+	void NotifyAmmoChanged();
+
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera)
 	float BaseTurnRate;
@@ -166,7 +198,7 @@ public:
 	float MoveRightValue;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Weapon)
-	class USoundCue* OnEquipSound;
+	TSoftObjectPtr<class USoundCue> OnEquipSound;
 
 	UPROPERTY(BlueprintReadWrite, Category = Rifle)
 	bool IsAiming;
@@ -184,10 +216,10 @@ public:
 	FTimerHandle FireDelay;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Animations)
-	UAnimMontage* FireAnimMontage; 
+	TSoftObjectPtr<UAnimMontage> FireAnimMontage;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Animations)
-	UAnimMontage* FireHandGunAnimMontage;
+	TSoftObjectPtr<UAnimMontage> FireHandGunAnimMontage;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Animations)
 	float GunRebound;
@@ -201,10 +233,10 @@ public:
 	bool Sprinted;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Animations)
-	UAnimMontage* RifleReloadingAnimMontage;
+	TSoftObjectPtr<UAnimMontage> RifleReloadingAnimMontage;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Animations)
-	UAnimMontage* HandGunReloadingAnimMontage;
+	TSoftObjectPtr<UAnimMontage> HandGunReloadingAnimMontage;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	bool IsRifleReloading;
@@ -212,6 +244,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	int WeaponMaxBullet;
 
+	/** Definition of the weapon in the right hand, copied on equip */
+	UPROPERTY(Transient, BlueprintReadOnly, Category = Weapon)
+	FWeaponDefinition EquippedWeaponDefinition;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	int LoadedBullet;
 		
@@ -220,11 +256,62 @@ public:
 
 	FTimerHandle ReloadDelay;
 
+	/** The montages and sounds above for Blueprints, loaded on the spot if the preload hasn't finished */
+	UFUNCTION(BlueprintPure, Category = Animations)
+	UAnimMontage* GetRollMontage() const;
+
+	UFUNCTION(BlueprintPure, Category = Animations)
+	UAnimMontage* GetEquipAnimMonatage() const;
+
+	UFUNCTION(BlueprintPure, Category = Animations)
+	UAnimMontage* GetUnEquipAnimMonatage() const;
+
+	UFUNCTION(BlueprintPure, Category = Animations)
+	UAnimMontage* GetFireAnimMontage() const;
+
+	UFUNCTION(BlueprintPure, Category = Animations)
+	UAnimMontage* GetFireHandGunAnimMontage() const;
+
+	UFUNCTION(BlueprintPure, Category = Animations)
+	UAnimMontage* GetRifleReloadingAnimMontage() const;
+
+	UFUNCTION(BlueprintPure, Category = Animations)
+	UAnimMontage* GetHandGunReloadingAnimMontage() const;
+
+	UFUNCTION(BlueprintPure, Category = Weapon)
+	class USoundCue* GetOnEquipSound() const;
+
 protected:
 
 	virtual void BeginPlay() override;
 
-	void FindFrontObject();
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Local and remote characters tick their mesh differently off-screen */
+	virtual void PossessedBy(AController* NewController) override;
+
+	virtual void OnRep_Controller() override;
+
+	/** Current state as ECharacterCondition bits */
+	uint16 GetConditions() const;
+
+	/** Looks the action up in CharacterActionTable for the current state */
+	FORCEINLINE bool CanPerform(ECharacterAction Action) const { return CharacterActionTable::CanPerform(GetConditions(), Action); }
+
+	/** Pushes the stamina/health drain of the current movement state and sprint to the status subsystem, call after either changes */
+	void UpdateStatusDrain();
+
+	/** Pickup we look at, otherwise the best one around us */
+	class AWeapon* FindBestLoot() const;
+
+	/** True for a pickup lying on the ground within LootSearchRadius */
+	bool CanReachLoot(const class AWeapon* Weapon) const;
+
+	/** Points HitWeapon at FindBestLoot for the local player */
+	void UpdateHitWeapon();
+
+	UFUNCTION()
+	void OnFocusChanged(AActor* NewFocus, AActor* OldFocus);
 
 	/** Called for forwards/backward input */
 	void MoveForward(float Value);
@@ -236,25 +323,16 @@ protected:
 
 	void ReleaseSprint();
 
-	void ClimbTracer();
-
 	void StartClimbing();
 
-	void Climbing();
-
-	void ClimbingMovement();
-
 	void ReleaseClimbing();
 
 	void ClimbingUp();
 
-	void ClimbingUpMovement();
-
 	void Rolling();
 
-	void RollingMovement();
-
-	void ReleaseRolling();
+	/** Keeps PlayMovementState in step when a custom movement mode ends */
+	virtual void OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode = 0) override;
 
 	/** Called for CameraX rotate */
 	void TurnAtRate(float Rate);
@@ -264,14 +342,68 @@ protected:
 
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
+	friend struct FPlayerCharacterInputBindings;
+
+	/** Receives the bound input while it records */
+	UPROPERTY(Transient)
+	class UInputRecordingSubsystem* InputRecorder;
+
+	void RecordAction(FName Action, EInputEvent Event);
+
+	void RecordAxis(float Value, FName Axis);
+
 	void TakeItem();
 
+	/** Puts Weapon in a free slot, or swaps it with the one in hand when both are taken */
+	void PickUp(class AWeapon* Weapon);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerTakeItem(class AWeapon* Weapon);
+
 	void EquipFirstWeapon();
 
 	void EquipSecondWeapon();
+
+	/** Starts drawing slot Number, 0 puts the weapon away. Runs on the owner right away and on the server through ServerEquipWeapon */
+	bool EquipWeapon(int32 Number);
+
+	void RequestEquipWeapon(int32 Number);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerEquipWeapon(uint8 Number);
+
+	UFUNCTION()
+	void OnRep_RightHandEquippedWeapon();
+
+	UFUNCTION()
+	void OnRep_CarriedWeapons();
 	
 	void AttachWeapon();
 
+	/** Takes magazine size, burst, recoil and montages from the definition of the weapon in the right hand */
+	void ApplyWeaponDefinition();
+
+	/** Definition of Kind with the character Blueprint's montages filling the empty rows */
+	FWeaponDefinition ResolveWeaponDefinition(EWeaponKind Kind) const;
+
+	/** Streams in the dodge and equip montages and the equip sound, the getters load whatever hasn't arrived when it is first needed */
+	void PreloadCharacterAssets();
+
+	/** Streams in the assets of the carried weapons and lets those of dropped weapons unload */
+	void PreloadWeaponAssets();
+
+	TSharedPtr<FStreamableHandle> CharacterAssetsHandle;
+
+	TSharedPtr<FStreamableHandle> WeaponAssetsHandle;
+
+	/** Plays the shot cue, or starts the loop on the first round of a long burst */
+	void PlayFireSound();
+
+	/** Ends the burst loop with its tail cue */
+	void StopFireSound();
+
+	FWeaponVoiceHandle FireLoopVoice;
+
 	void UnEquipWeapon();
 
 	void Aiming();
@@ -284,19 +416,80 @@ protected:
 
 	void ReleaseFire();
 
+	/** Sends a hitscan shot of the right hand weapon along our view */
+	void FireShot();
+
+	/** Hands the shot to the hitscan or projectile subsystem, depending on the weapon. Seed picks the pellet spread,
+	 *  a RewindTime of 0 or more tests hitscan pellets against the hitboxes as they were then */
+	void EmitShot(const FVector& Start, const FVector& Direction, int32 Seed, float RewindTime);
+
+	/** Shots fired so far, seeds the spread of the next one. The client sends its seed with the shot, the server only takes newer ones */
+	int32 ShotCount;
+
+	/** Shots the server lets through right away, refilled at the weapon's fire rate up to two for network jitter */
+	float ShotAllowance;
+
+	float LastServerShotTime;
+
+	/** Unreliable, a lost shot is a miss rather than a stall of every reliable call behind it */
+	UFUNCTION(Server, Unreliable, WithValidation)
+	void ServerFireShot(FVector_NetQuantize Start, FVector_NetQuantizeNormal Direction, float ShotTime, int32 Seed);
+
 	void SwitchCamera();
 
 	void Reload();
 
+	/** The server refills its own magazine, shots it receives are checked against it */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerReload();
+
 	void FinishReload();
 
 public:	
 
-	virtual void Tick(float DeltaTime) override;
+	/** Flags, movement state and weapon slot for remotes and the anim instance. Packed by the server, owners only send their intent */
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedState)
+	FPlayerCharacterState ReplicatedState;
+
+	/** Packs our state, and on an owning client sends it on when it changed. Called after every movement update */
+	void SyncReplicatedState();
+
+	FPlayerCharacterState PackState() const;
+
+	void UnpackState(const FPlayerCharacterState& State);
+
+	UFUNCTION()
+	void OnRep_ReplicatedState();
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerSetReplicatedState(FPlayerCharacterState NewState);
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Called by UClimbProbeSubsystem with the result of the probe in front of us */
+	void OnClimbProbeResult(bool bBlocked);
+
+	/** Runs the handlers bound to an input action, for scripted and replayed input */
+	UFUNCTION(BlueprintCallable, Category = Input)
+	void InjectAction(FName Action, TEnumAsByte<EInputEvent> Event);
+
+	/** Runs the handlers bound to an input axis */
+	UFUNCTION(BlueprintCallable, Category = Input)
+	void InjectAxis(FName Axis, float Value);
 
+	/** Returns PlayerMovement subobject **/
+	FORCEINLINE class UPlayerCharacterMovementComponent* GetPlayerMovement() const { return PlayerMovement; }
+	/** Returns FocusTarget subobject **/
+	FORCEINLINE class UFocusTargetComponent* GetFocusTarget() const { return FocusTarget; }
+	/** Returns HitboxHistory subobject **/
+	FORCEINLINE class UHitboxHistoryComponent* GetHitboxHistory() const { return HitboxHistory; }
 	/** Returns CameraBoom subobject **/
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
 	/** Returns FollowCamera subobject **/
 	FORCEINLINE class UCameraComponent* GetFollowCamera() const { return FPCamera; }
+	/** Returns the weapon in the right hand, null when unarmed **/
+	FORCEINLINE class AWeapon* GetEquippedWeapon() const { return RightHandEquippedWeapon; }
+	/** Returns the rounds in the magazine **/
+	FORCEINLINE int32 GetLoadedBullet() const { return LoadedBullet; }
 };
                                                                                                                                                                                                                                                                                                                                                                             
\ No newline at end of file
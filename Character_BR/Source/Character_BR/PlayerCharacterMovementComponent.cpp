@@ -0,0 +1,410 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlayerCharacterMovementComponent.h"
+#include "CharacterBRStats.h"
+#include "Character_BR.h"
+#include "ClimbLedgeIndexSubsystem.h"
+#include "PlayerCharacter.h"
+#include "GameFramework/Character.h"
+#include "Engine/World.h"
+
+UPlayerCharacterMovementComponent::UPlayerCharacterMovementComponent()
+{
+	ClimbSpeed = 200.f;
+	ClimbUpHeight = 100.f;
+	ClimbUpForwardSpeed = 180.f;
+	ClimbUpDuration = 1.3f;
+
+	DodgeSpeed = 600.f;
+	DodgeDuration = 1.f;
+
+	ClimbProbeDistance = 70.f;
+	ClimbProbeHeight = 70.f;
+
+	SprintSpeed = 450.f;
+	AimingSpeed = 200.f;
+	AimingJumpZVelocity = 300.f;
+
+	bWantsToSprint = false;
+	bWantsToAim = false;
+	bWantsToDodge = false;
+	bWantsToClimb = false;
+
+	CustomModeTime = 0.f;
+	DodgeDirection = FVector::ForwardVector;
+	bClimbUpRaised = false;
+
+	NumServerCorrections = 0;
+}
+
+void UPlayerCharacterMovementComponent::StartClimbing()
+{
+	SetMovementMode(MOVE_Custom, (uint8)ECustomMovementMode::CMOVE_Climbing);
+}
+
+void UPlayerCharacterMovementComponent::StartClimbingUp()
+{
+	SetMovementMode(MOVE_Custom, (uint8)ECustomMovementMode::CMOVE_ClimbingUp);
+}
+
+void UPlayerCharacterMovementComponent::StopClimbing()
+{
+	if (IsInCustomMode(ECustomMovementMode::CMOVE_Climbing))
+	{
+		SetMovementMode(MOVE_Walking);
+	}
+}
+
+void UPlayerCharacterMovementComponent::StartDodge(const FVector& Direction)
+{
+	DodgeDirection = Direction.GetSafeNormal2D();
+	Velocity = DodgeDirection * DodgeSpeed;
+	SetMovementMode(MOVE_Custom, (uint8)ECustomMovementMode::CMOVE_Dodging);
+}
+
+bool UPlayerCharacterMovementComponent::IsWallInFront() const
+{
+	const FVector Location = UpdatedComponent->GetComponentLocation();
+	const FVector Forward = UpdatedComponent->GetForwardVector();
+
+	const UClimbLedgeIndexSubsystem* LedgeIndex = GetWorld()->GetSubsystem<UClimbLedgeIndexSubsystem>();
+	if (LedgeIndex && LedgeIndex->IsBuilt())
+	{
+		float LedgeTop;
+		return LedgeIndex->FindLedge(Location, Forward, ClimbProbeDistance, ClimbProbeHeight, LedgeTop);
+	}
+
+	const FVector Start = FVector(Location.X, Location.Y, Location.Z + ClimbProbeHeight);
+	const FVector End = Location + FVector(Forward.X * ClimbProbeDistance, Forward.Y * ClimbProbeDistance, Forward.Z + ClimbProbeHeight);
+
+	FHitResult Hit;
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(ClimbWallCheck), false, CharacterOwner);
+	CHARACTERBR_COUNT(ClimbWallTrace, 1);
+	return GetWorld()->LineTraceSingleByChannel(Hit, Start, End, COLLISION_CLIMB, TraceParams);
+}
+
+void UPlayerCharacterMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	//Runs on the owning client, on the server for every received move and on every replay,
+	//so mode changes triggered here happen on the same move everywhere
+	if (bWantsToDodge)
+	{
+		bWantsToDodge = false;
+
+		if (MovementMode == MOVE_Walking || MovementMode == MOVE_NavWalking)
+		{
+			StartDodge(UpdatedComponent->GetForwardVector());
+		}
+	}
+
+	if (bWantsToClimb)
+	{
+		//The probe result only drives the animation, replays need the wall where this move starts
+		if (MovementMode != MOVE_Custom && IsWallInFront())
+		{
+			StartClimbing();
+		}
+	}
+	else
+	{
+		StopClimbing();
+	}
+}
+
+bool UPlayerCharacterMovementComponent::IsMovingOnGround() const
+{
+	//Dodging is ground movement, it reuses the walking physics
+	return Super::IsMovingOnGround() || (UpdatedComponent && IsInCustomMode(ECustomMovementMode::CMOVE_Dodging));
+}
+
+float UPlayerCharacterMovementComponent::GetMaxSpeed() const
+{
+	if (MovementMode == MOVE_Custom)
+	{
+		switch ((ECustomMovementMode)CustomMovementMode)
+		{
+		case ECustomMovementMode::CMOVE_Climbing:	return ClimbSpeed;
+		case ECustomMovementMode::CMOVE_ClimbingUp:	return ClimbUpForwardSpeed;
+		case ECustomMovementMode::CMOVE_Dodging:	return DodgeSpeed;
+		default: break;
+		}
+	}
+
+	if (MovementMode == MOVE_Walking || MovementMode == MOVE_NavWalking || MovementMode == MOVE_Falling)
+	{
+		if (bWantsToAim) return AimingSpeed;
+		if (bWantsToSprint) return SprintSpeed;
+	}
+
+	return Super::GetMaxSpeed();
+}
+
+bool UPlayerCharacterMovementComponent::DoJump(bool bReplayingMoves)
+{
+	const float DefaultJumpZVelocity = JumpZVelocity;
+	if (bWantsToAim)
+	{
+		JumpZVelocity = AimingJumpZVelocity;
+	}
+
+	const bool bJumped = Super::DoJump(bReplayingMoves);
+
+	JumpZVelocity = DefaultJumpZVelocity;
+	return bJumped;
+}
+
+void UPlayerCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	bWantsToSprint = (Flags & FSavedMove_PlayerCharacter::FLAG_Sprint) != 0;
+	bWantsToAim = (Flags & FSavedMove_PlayerCharacter::FLAG_Aim) != 0;
+	bWantsToDodge = (Flags & FSavedMove_PlayerCharacter::FLAG_Dodge) != 0;
+	bWantsToClimb = (Flags & FSavedMove_PlayerCharacter::FLAG_Climb) != 0;
+}
+
+FNetworkPredictionData_Client* UPlayerCharacterMovementComponent::GetPredictionData_Client() const
+{
+	check(PawnOwner != nullptr);
+
+	if (ClientPredictionData == nullptr)
+	{
+		UPlayerCharacterMovementComponent* MutableThis = const_cast<UPlayerCharacterMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_PlayerCharacter(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+void UPlayerCharacterMovementComponent::ServerMoveHandleClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode)
+{
+	Super::ServerMoveHandleClientError(ClientTimeStamp, DeltaTime, Accel, RelativeClientLocation, ClientMovementBase, ClientBaseBoneName, ClientMovementMode);
+
+	const FNetworkPredictionData_Server_Character* ServerData = GetPredictionData_Server_Character();
+	if (ServerData && !ServerData->PendingAdjustment.bAckGoodMove)
+	{
+		++NumServerCorrections;
+		CHARACTERBR_COUNT(MoveCorrection, 1);
+	}
+}
+
+void UPlayerCharacterMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	CustomModeTime = 0.f;
+	bClimbUpRaised = false;
+
+	//A finished or interrupted climb needs a fresh jump press
+	if (PreviousMovementMode == MOVE_Custom && PreviousCustomMode == (uint8)ECustomMovementMode::CMOVE_Climbing)
+	{
+		bWantsToClimb = false;
+	}
+
+	//Custom modes don't keep the velocity they were entered with
+	if (IsInCustomMode(ECustomMovementMode::CMOVE_Climbing) || IsInCustomMode(ECustomMovementMode::CMOVE_ClimbingUp))
+	{
+		Velocity = FVector::ZeroVector;
+	}
+
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+}
+
+void UPlayerCharacterMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
+{
+	switch ((ECustomMovementMode)CustomMovementMode)
+	{
+	case ECustomMovementMode::CMOVE_Climbing:
+		PhysClimbing(deltaTime, Iterations);
+		break;
+	case ECustomMovementMode::CMOVE_ClimbingUp:
+		PhysClimbingUp(deltaTime, Iterations);
+		break;
+	case ECustomMovementMode::CMOVE_Dodging:
+		PhysDodging(deltaTime, Iterations);
+		break;
+	default:
+		Super::PhysCustom(deltaTime, Iterations);
+		break;
+	}
+}
+
+void UPlayerCharacterMovementComponent::MoveWithSlide(const FVector& Delta)
+{
+	FHitResult Hit(1.f);
+	SafeMoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), true, Hit);
+
+	if (Hit.Time < 1.f)
+	{
+		HandleImpact(Hit, 0.f, Delta);
+		SlideAlongSurface(Delta, 1.f - Hit.Time, Hit.Normal, Hit, true);
+	}
+}
+
+void UPlayerCharacterMovementComponent::OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity)
+{
+	Super::OnMovementUpdated(DeltaSeconds, OldLocation, OldVelocity);
+
+	if (APlayerCharacter* PlayerCharacter = Cast<APlayerCharacter>(CharacterOwner))
+	{
+		PlayerCharacter->SyncReplicatedState();
+	}
+}
+
+void UPlayerCharacterMovementComponent::PhysClimbing(float deltaTime, int32 Iterations)
+{
+	if (deltaTime < MIN_TICK_TIME)
+		return;
+
+	//Past the top of the wall, pull up over the ledge. Checked once per move from where it starts,
+	//so a replay of the move sees the same wall
+	if (!IsWallInFront())
+	{
+		StartClimbingUp();
+		StartNewPhysics(deltaTime, Iterations);
+		return;
+	}
+
+	float RemainingTime = deltaTime;
+	while (RemainingTime >= MIN_TICK_TIME && Iterations < MaxSimulationIterations && IsInCustomMode(ECustomMovementMode::CMOVE_Climbing))
+	{
+		Iterations++;
+		const float TimeTick = GetSimulationTimeStep(RemainingTime, Iterations);
+		RemainingTime -= TimeTick;
+
+		Velocity = FVector(0.f, 0.f, ClimbSpeed);
+		MoveWithSlide(Velocity * TimeTick);
+	}
+}
+
+void UPlayerCharacterMovementComponent::PhysClimbingUp(float deltaTime, int32 Iterations)
+{
+	if (deltaTime < MIN_TICK_TIME)
+		return;
+
+	//Lift over the ledge first, then walk onto it
+	if (!bClimbUpRaised)
+	{
+		bClimbUpRaised = true;
+		MoveWithSlide(FVector(0.f, 0.f, ClimbUpHeight));
+	}
+
+	float RemainingTime = deltaTime;
+	while (RemainingTime >= MIN_TICK_TIME && Iterations < MaxSimulationIterations && IsInCustomMode(ECustomMovementMode::CMOVE_ClimbingUp))
+	{
+		Iterations++;
+		const float TimeTick = FMath::Min(GetSimulationTimeStep(RemainingTime, Iterations), ClimbUpDuration - CustomModeTime);
+		RemainingTime -= TimeTick;
+		CustomModeTime += TimeTick;
+
+		Velocity = UpdatedComponent->GetForwardVector().GetSafeNormal2D() * ClimbUpForwardSpeed;
+		MoveWithSlide(Velocity * TimeTick);
+
+		if (CustomModeTime >= ClimbUpDuration)
+		{
+			Velocity = FVector::ZeroVector;
+			SetMovementMode(MOVE_Walking);
+			StartNewPhysics(RemainingTime, Iterations);
+			return;
+		}
+	}
+}
+
+void UPlayerCharacterMovementComponent::PhysDodging(float deltaTime, int32 Iterations)
+{
+	if (deltaTime < MIN_TICK_TIME)
+		return;
+
+	const float DodgeTime = FMath::Min(deltaTime, DodgeDuration - CustomModeTime);
+	CustomModeTime += DodgeTime;
+
+	//Input is ignored, the dodge always accelerates along its start direction
+	Acceleration = DodgeDirection * GetMaxAcceleration();
+	PhysWalking(DodgeTime, Iterations);
+
+	if (CustomModeTime >= DodgeDuration && IsInCustomMode(ECustomMovementMode::CMOVE_Dodging))
+	{
+		SetMovementMode(MOVE_Walking);
+		StartNewPhysics(deltaTime - DodgeTime, Iterations);
+	}
+}
+
+void FSavedMove_PlayerCharacter::Clear()
+{
+	Super::Clear();
+
+	bSavedWantsToSprint = false;
+	bSavedWantsToAim = false;
+	bSavedWantsToDodge = false;
+	bSavedWantsToClimb = false;
+	SavedCustomModeTime = 0.f;
+	SavedDodgeDirection = FVector::ZeroVector;
+}
+
+uint8 FSavedMove_PlayerCharacter::GetCompressedFlags() const
+{
+	uint8 Result = Super::GetCompressedFlags();
+
+	if (bSavedWantsToSprint) Result |= FLAG_Sprint;
+	if (bSavedWantsToAim) Result |= FLAG_Aim;
+	if (bSavedWantsToDodge) Result |= FLAG_Dodge;
+	if (bSavedWantsToClimb) Result |= FLAG_Climb;
+
+	return Result;
+}
+
+bool FSavedMove_PlayerCharacter::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	const FSavedMove_PlayerCharacter* NewPlayerMove = static_cast<const FSavedMove_PlayerCharacter*>(NewMove.Get());
+
+	if (bSavedWantsToSprint != NewPlayerMove->bSavedWantsToSprint
+		|| bSavedWantsToAim != NewPlayerMove->bSavedWantsToAim
+		|| bSavedWantsToClimb != NewPlayerMove->bSavedWantsToClimb
+		|| bSavedWantsToDodge || NewPlayerMove->bSavedWantsToDodge)
+	{
+		return false;
+	}
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_PlayerCharacter::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	if (const UPlayerCharacterMovementComponent* Movement = Cast<UPlayerCharacterMovementComponent>(C->GetCharacterMovement()))
+	{
+		bSavedWantsToSprint = Movement->bWantsToSprint;
+		bSavedWantsToAim = Movement->bWantsToAim;
+		bSavedWantsToDodge = Movement->bWantsToDodge;
+		bSavedWantsToClimb = Movement->bWantsToClimb;
+		SavedCustomModeTime = Movement->CustomModeTime;
+		SavedDodgeDirection = Movement->DodgeDirection;
+	}
+}
+
+void FSavedMove_PlayerCharacter::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	if (UPlayerCharacterMovementComponent* Movement = Cast<UPlayerCharacterMovementComponent>(C->GetCharacterMovement()))
+	{
+		Movement->bWantsToSprint = bSavedWantsToSprint;
+		Movement->bWantsToAim = bSavedWantsToAim;
+		Movement->bWantsToDodge = bSavedWantsToDodge;
+		Movement->bWantsToClimb = bSavedWantsToClimb;
+		Movement->CustomModeTime = SavedCustomModeTime;
+		Movement->DodgeDirection = SavedDodgeDirection;
+		Movement->bClimbUpRaised = SavedCustomModeTime > 0.f;
+	}
+}
+
+FNetworkPredictionData_Client_PlayerCharacter::FNetworkPredictionData_Client_PlayerCharacter(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_PlayerCharacter::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_PlayerCharacter());
+}
@@ -0,0 +1,180 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "PlayerCharacterMovementComponent.generated.h"
+
+UENUM(BlueprintType)
+enum class ECustomMovementMode : uint8
+{
+	CMOVE_None			UMETA(Hidden),
+	CMOVE_Climbing		UMETA(DisplayName = "Climbing"),
+	CMOVE_ClimbingUp	UMETA(DisplayName = "ClimbingUp"),
+	CMOVE_Dodging		UMETA(DisplayName = "Dodging"),
+
+	CMOVE_MAX			UMETA(Hidden)
+};
+
+/** Saved move carrying the sprint, aim, dodge and climb requests in the compressed flags */
+class FSavedMove_PlayerCharacter : public FSavedMove_Character
+{
+public:
+
+	typedef FSavedMove_Character Super;
+
+	enum CompressedFlags
+	{
+		FLAG_Sprint	= FLAG_Custom_0,
+		FLAG_Aim	= FLAG_Custom_1,
+		FLAG_Dodge	= FLAG_Custom_2,
+		FLAG_Climb	= FLAG_Custom_3,
+	};
+
+	virtual void Clear() override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+
+	uint8 bSavedWantsToSprint : 1;
+	uint8 bSavedWantsToAim : 1;
+	uint8 bSavedWantsToDodge : 1;
+	uint8 bSavedWantsToClimb : 1;
+
+	/** Custom mode progress at the start of the move, so replays end dodges and climb-ups on the same move */
+	float SavedCustomModeTime;
+	FVector SavedDodgeDirection;
+};
+
+class FNetworkPredictionData_Client_PlayerCharacter : public FNetworkPredictionData_Client_Character
+{
+public:
+
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_PlayerCharacter(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
+
+/**
+ * Character movement with MOVE_Custom modes for climbing a wall, pulling up over its ledge and dodging,
+ * so these run inside the regular movement update instead of on per-frame timers.
+ * Sprint, aim, dodge and climb are requested through flags that travel with the saved moves,
+ * so clients predict them and the server replays them.
+ */
+UCLASS()
+class CHARACTER_BR_API UPlayerCharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UPlayerCharacterMovementComponent();
+
+	/** Vertical speed while climbing a wall */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing")
+	float ClimbSpeed;
+
+	/** How far the character is lifted once it reaches the ledge */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing")
+	float ClimbUpHeight;
+
+	/** Forward speed while pulling up over the ledge */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing")
+	float ClimbUpForwardSpeed;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing")
+	float ClimbUpDuration;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Dodging")
+	float DodgeSpeed;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Dodging")
+	float DodgeDuration;
+
+	/** Reach and height of the wall check while climbing */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing")
+	float ClimbProbeDistance;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Climbing")
+	float ClimbProbeHeight;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Walking")
+	float SprintSpeed;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Walking")
+	float AimingSpeed;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement: Jumping / Falling")
+	float AimingJumpZVelocity;
+
+	uint8 bWantsToSprint : 1;
+
+	uint8 bWantsToAim : 1;
+
+	/** One shot, consumed by the next movement update */
+	uint8 bWantsToDodge : 1;
+
+	/** Held while the jump key is down, cleared once the climb ends */
+	uint8 bWantsToClimb : 1;
+
+	/** True when there is a climbable wall in front at probe height */
+	bool IsWallInFront() const;
+
+	void StartClimbing();
+
+	void StartClimbingUp();
+
+	void StopClimbing();
+
+	void StartDodge(const FVector& Direction);
+
+	FORCEINLINE bool IsInCustomMode(ECustomMovementMode Mode) const { return MovementMode == MOVE_Custom && CustomMovementMode == (uint8)Mode; }
+
+	virtual bool IsMovingOnGround() const override;
+
+	virtual float GetMaxSpeed() const override;
+
+	virtual bool DoJump(bool bReplayingMoves) override;
+
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+	virtual void ServerMoveHandleClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& RelativeClientLocation, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+
+	/** Client moves the server had to correct, read by the movement benchmark */
+	int32 NumServerCorrections;
+
+protected:
+
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+
+	virtual void PhysCustom(float deltaTime, int32 Iterations) override;
+
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+
+	/** Lets the owner publish its packed state once the move is done */
+	virtual void OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity) override;
+
+	void PhysClimbing(float deltaTime, int32 Iterations);
+
+	void PhysClimbingUp(float deltaTime, int32 Iterations);
+
+	void PhysDodging(float deltaTime, int32 Iterations);
+
+	/** Sweeps by Delta and slides along whatever blocks it */
+	void MoveWithSlide(const FVector& Delta);
+
+	/** Time spent in the current custom mode */
+	float CustomModeTime;
+
+	FVector DodgeDirection;
+
+	bool bClimbUpRaised;
+
+	friend class FSavedMove_PlayerCharacter;
+};
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlayerCharacterState.h"
+
+bool FPlayerCharacterState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 Packed = 0;
+
+	if (Ar.IsSaving())
+	{
+		Packed = (Flags & ((1 << NumFlagBits) - 1))
+			| ((MovementState & ((1 << NumMovementStateBits) - 1)) << NumFlagBits)
+			| ((EquippedWeaponNumber & ((1 << NumWeaponNumberBits) - 1)) << (NumFlagBits + NumMovementStateBits));
+	}
+
+	Ar.SerializeBits(&Packed, NumFlagBits + NumMovementStateBits + NumWeaponNumberBits);
+
+	if (Ar.IsLoading())
+	{
+		Flags = Packed & ((1 << NumFlagBits) - 1);
+		MovementState = (Packed >> NumFlagBits) & ((1 << NumMovementStateBits) - 1);
+		EquippedWeaponNumber = (Packed >> (NumFlagBits + NumMovementStateBits)) & ((1 << NumWeaponNumberBits) - 1);
+	}
+
+	bOutSuccess = true;
+	return true;
+}
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlayerCharacterState.generated.h"
+
+/** One bit per flag of FPlayerCharacterState */
+enum class EPlayerStateFlag : uint16
+{
+	Aiming			= 1 << 0,
+	Firing			= 1 << 1,
+	BulletFire		= 1 << 2,
+	Sprinting		= 1 << 3,
+	Jumping			= 1 << 4,
+	Climbing		= 1 << 5,
+	ClimbReady		= 1 << 6,
+	ClimbUp			= 1 << 7,
+	Swimming		= 1 << 8,
+	Equipping		= 1 << 9,
+	Reloading		= 1 << 10,
+	Dodging			= 1 << 11,
+	Switched		= 1 << 12,
+	EquippedWeapon	= 1 << 13,
+};
+
+/**
+ * Replicated gameplay state of a player character, packed into 18 bits on the wire:
+ * 14 flags, 2 bits of APlayerMovementState and 2 bits of EquippedWeaponNumber.
+ */
+USTRUCT(BlueprintType)
+struct FPlayerCharacterState
+{
+	GENERATED_BODY()
+
+	enum
+	{
+		NumFlagBits = 14,
+		NumMovementStateBits = 2,
+		NumWeaponNumberBits = 2,
+	};
+
+	uint16 Flags = 0;
+
+	uint8 MovementState = 0;
+
+	uint8 EquippedWeaponNumber = 0;
+
+	FORCEINLINE bool HasFlag(EPlayerStateFlag Flag) const { return (Flags & (uint16)Flag) != 0; }
+
+	FORCEINLINE void SetFlag(EPlayerStateFlag Flag, bool bValue) { Flags = bValue ? (Flags | (uint16)Flag) : (Flags & ~(uint16)Flag); }
+
+	FORCEINLINE bool operator==(const FPlayerCharacterState& Other) const
+	{
+		return Flags == Other.Flags && MovementState == Other.MovementState && EquippedWeaponNumber == Other.EquippedWeaponNumber;
+	}
+
+	FORCEINLINE bool operator!=(const FPlayerCharacterState& Other) const { return !(*this == Other); }
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FPlayerCharacterState> : public TStructOpsTypeTraitsBase2<FPlayerCharacterState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true,
+	};
+};
@@ -0,0 +1,189 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlayerInputRecording.h"
+#include "PlayerCharacter.h"
+#include "GameFramework/Controller.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace PlayerInputRecording
+{
+	static const uint32 Magic = 0x49524243; // "CBRI"
+	static const uint8 Version = 1;
+}
+
+FRecordedInput& FPlayerInputRecording::Add(float Time, ERecordedInputKind Kind, FName Name)
+{
+	int32 NameIndex = Names.Find(Name);
+	if (NameIndex == INDEX_NONE)
+	{
+		check(Names.Num() < MAX_uint8);
+		NameIndex = Names.Add(Name);
+	}
+
+	FRecordedInput& Input = Inputs.AddDefaulted_GetRef();
+	Input.Time = Time;
+	Input.Kind = Kind;
+	Input.NameIndex = (uint8)NameIndex;
+	Input.Event = 0;
+	Input.Value = 0.f;
+	Input.Rotation = FRotator::ZeroRotator;
+	return Input;
+}
+
+void FPlayerInputRecording::AddAction(float Time, FName Name, EInputEvent Event)
+{
+	Add(Time, ERecordedInputKind::Action, Name).Event = (uint8)Event;
+}
+
+void FPlayerInputRecording::AddAxis(float Time, FName Name, float Value)
+{
+	Add(Time, ERecordedInputKind::Axis, Name).Value = Value;
+}
+
+void FPlayerInputRecording::AddControlRotation(float Time, const FRotator& Rotation)
+{
+	Add(Time, ERecordedInputKind::ControlRotation, NAME_None).Rotation = Rotation;
+}
+
+void FPlayerInputRecording::Serialize(FArchive& Ar)
+{
+	uint32 Magic = PlayerInputRecording::Magic;
+	uint8 Version = PlayerInputRecording::Version;
+	Ar << Magic << Version;
+
+	if (Magic != PlayerInputRecording::Magic || Version != PlayerInputRecording::Version)
+	{
+		Ar.SetError();
+		return;
+	}
+
+	Ar << StartLocation << StartRotation << Names;
+
+	int32 Count = Inputs.Num();
+	Ar << Count;
+	if (Ar.IsLoading())
+	{
+		Inputs.SetNumZeroed(FMath::Max(Count, 0));
+	}
+
+	//Times are packed deltas in milliseconds, kind and event share a byte
+	uint32 PreviousMs = 0;
+	for (FRecordedInput& Input : Inputs)
+	{
+		uint32 Ms = FMath::RoundToInt(Input.Time * 1000.f);
+		uint32 DeltaMs = Ms - PreviousMs;
+		Ar.SerializeIntPacked(DeltaMs);
+
+		uint8 Header = ((uint8)Input.Kind << 4) | (Input.Event & 0x0F);
+		Ar << Header;
+
+		if (Ar.IsLoading())
+		{
+			Ms = PreviousMs + DeltaMs;
+			Input.Time = Ms / 1000.f;
+			Input.Kind = (ERecordedInputKind)(Header >> 4);
+			Input.Event = Header & 0x0F;
+			Input.Value = 0.f;
+			Input.Rotation = FRotator::ZeroRotator;
+		}
+		PreviousMs = Ms;
+
+		switch (Input.Kind)
+		{
+		case ERecordedInputKind::Action:
+			Ar << Input.NameIndex;
+			break;
+		case ERecordedInputKind::Axis:
+			Ar << Input.NameIndex << Input.Value;
+			break;
+		case ERecordedInputKind::ControlRotation:
+			Ar << Input.Rotation.Pitch << Input.Rotation.Yaw;
+			break;
+		default:
+			Ar.SetError();
+			return;
+		}
+
+		if (Ar.IsLoading() && Input.Kind != ERecordedInputKind::ControlRotation && !Names.IsValidIndex(Input.NameIndex))
+		{
+			Ar.SetError();
+			return;
+		}
+	}
+}
+
+bool FPlayerInputRecording::SaveToFile(const FString& Path) const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	const_cast<FPlayerInputRecording*>(this)->Serialize(Writer);
+
+	return FFileHelper::SaveArrayToFile(Bytes, *Path);
+}
+
+bool FPlayerInputRecording::LoadFromFile(const FString& Path)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path))
+		return false;
+
+	FMemoryReader Reader(Bytes);
+	Serialize(Reader);
+
+	return !Reader.IsError();
+}
+
+FPlayerInputPlayback::FPlayerInputPlayback(const FPlayerInputRecording& InRecording)
+	: Recording(&InRecording)
+	, Cursor(0)
+	, ControlRotation(FRotator::ZeroRotator)
+	, bHasControlRotation(false)
+{
+	AxisValues.SetNumZeroed(Recording->Names.Num());
+
+	for (const FRecordedInput& Input : Recording->Inputs)
+	{
+		if (Input.Kind == ERecordedInputKind::Axis)
+		{
+			AxisNames.AddUnique(Input.NameIndex);
+		}
+	}
+}
+
+void FPlayerInputPlayback::Advance(APlayerCharacter* Character, float Time)
+{
+	const TArray<FRecordedInput>& Inputs = Recording->Inputs;
+
+	for (; Cursor < Inputs.Num() && Inputs[Cursor].Time <= Time; ++Cursor)
+	{
+		const FRecordedInput& Input = Inputs[Cursor];
+
+		switch (Input.Kind)
+		{
+		case ERecordedInputKind::Action:
+			Character->InjectAction(Recording->Names[Input.NameIndex], (EInputEvent)Input.Event);
+			break;
+		case ERecordedInputKind::Axis:
+			AxisValues[Input.NameIndex] = Input.Value;
+			break;
+		case ERecordedInputKind::ControlRotation:
+			ControlRotation = Input.Rotation;
+			bHasControlRotation = true;
+			break;
+		}
+	}
+
+	//Applied every step, the controller may have turned the view back to the pawn in between
+	AController* Controller = Character->GetController();
+	if (Controller && bHasControlRotation)
+	{
+		Controller->SetControlRotation(ControlRotation);
+	}
+
+	for (uint8 NameIndex : AxisNames)
+	{
+		Character->InjectAxis(Recording->Names[NameIndex], AxisValues[NameIndex]);
+	}
+}
@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+
+class APlayerCharacter;
+
+enum class ERecordedInputKind : uint8
+{
+	Action,
+	Axis,
+	ControlRotation,
+};
+
+/** One input of a recording */
+struct FRecordedInput
+{
+	/** Seconds since the recording started, stored in milliseconds */
+	float Time;
+	ERecordedInputKind Kind;
+	uint8 NameIndex;
+	uint8 Event;
+	float Value;
+	FRotator Rotation;
+};
+
+/**
+ * The action and axis stream of one player, in time order.
+ * Axes are stored when their value changes, look axes as the control rotation they produced.
+ */
+struct CHARACTER_BR_API FPlayerInputRecording
+{
+	FVector StartLocation = FVector::ZeroVector;
+	FRotator StartRotation = FRotator::ZeroRotator;
+	TArray<FName> Names;
+	TArray<FRecordedInput> Inputs;
+
+	float GetLength() const { return Inputs.Num() > 0 ? Inputs.Last().Time : 0.f; }
+
+	void AddAction(float Time, FName Name, EInputEvent Event);
+
+	void AddAxis(float Time, FName Name, float Value);
+
+	void AddControlRotation(float Time, const FRotator& Rotation);
+
+	bool SaveToFile(const FString& Path) const;
+
+	bool LoadFromFile(const FString& Path);
+
+	void Serialize(FArchive& Ar);
+
+private:
+
+	FRecordedInput& Add(float Time, ERecordedInputKind Kind, FName Name);
+};
+
+/** Feeds a recording back through the input bindings of a character */
+struct CHARACTER_BR_API FPlayerInputPlayback
+{
+	explicit FPlayerInputPlayback(const FPlayerInputRecording& InRecording);
+
+	/** Sends every input up to Time, then the held axis values like an input component does each frame */
+	void Advance(APlayerCharacter* Character, float Time);
+
+	bool IsFinished() const { return Cursor >= Recording->Inputs.Num(); }
+
+private:
+
+	const FPlayerInputRecording* Recording;
+
+	int32 Cursor;
+
+	/** Held value per name, only sent for names in AxisNames */
+	TArray<float> AxisValues;
+
+	TArray<uint8> AxisNames;
+
+	/** Last recorded control rotation, held until the next one like a real view */
+	FRotator ControlRotation;
+
+	bool bHasControlRotation;
+};
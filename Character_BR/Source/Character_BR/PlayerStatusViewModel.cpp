@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlayerStatusViewModel.h"
+
+UPlayerStatusViewModel::UPlayerStatusViewModel()
+{
+	Health = 0.f;
+	MaxHealth = 0.f;
+	Stamina = 0.f;
+	MaxStamina = 0.f;
+	LoadedBullet = 0;
+	InventoryBulletCount = 0;
+	QuantizationStep = 0.5f;
+}
+
+void UPlayerStatusViewModel::SetHealth(float Value, float MaxValue)
+{
+	if (SetQuantized(Health, MaxHealth, Value, MaxValue))
+	{
+		OnHealthChanged.Broadcast(Health, MaxHealth);
+	}
+}
+
+void UPlayerStatusViewModel::SetStamina(float Value, float MaxValue)
+{
+	if (SetQuantized(Stamina, MaxStamina, Value, MaxValue))
+	{
+		OnStaminaChanged.Broadcast(Stamina, MaxStamina);
+	}
+}
+
+void UPlayerStatusViewModel::SetAmmo(int32 InLoadedBullet, int32 InInventoryBulletCount)
+{
+	if (LoadedBullet != InLoadedBullet || InventoryBulletCount != InInventoryBulletCount)
+	{
+		LoadedBullet = InLoadedBullet;
+		InventoryBulletCount = InInventoryBulletCount;
+		OnAmmoChanged.Broadcast(LoadedBullet, InventoryBulletCount);
+	}
+}
+
+void UPlayerStatusViewModel::BroadcastAll()
+{
+	OnHealthChanged.Broadcast(Health, MaxHealth);
+	OnStaminaChanged.Broadcast(Stamina, MaxStamina);
+	OnAmmoChanged.Broadcast(LoadedBullet, InventoryBulletCount);
+}
+
+bool UPlayerStatusViewModel::SetQuantized(float& Value, float& MaxValue, float NewValue, float NewMaxValue) const
+{
+	const float Step = FMath::Max(QuantizationStep, KINDA_SMALL_NUMBER);
+	const bool bChanged = MaxValue != NewMaxValue || FMath::FloorToInt(Value / Step) != FMath::FloorToInt(NewValue / Step);
+
+	//The stored value only moves on a step change, so a slow drain is compared against what listeners last saw
+	if (bChanged)
+	{
+		Value = NewValue;
+		MaxValue = NewMaxValue;
+	}
+	return bChanged;
+}
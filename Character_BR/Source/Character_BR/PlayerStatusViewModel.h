@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "PlayerStatusViewModel.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnStatusValueChanged, float, Value, float, MaxValue);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnAmmoChanged, int32, LoadedBullet, int32, InventoryBulletCount);
+
+/**
+ * What the player status HUD shows. The character pushes its values in,
+ * and listeners only hear about health and stamina when they cross a QuantizationStep
+ * and about ammo when a count changes, so nothing has to poll the character.
+ */
+UCLASS(BlueprintType)
+class CHARACTER_BR_API UPlayerStatusViewModel : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UPlayerStatusViewModel();
+
+	void SetHealth(float Value, float MaxValue);
+
+	void SetStamina(float Value, float MaxValue);
+
+	void SetAmmo(int32 InLoadedBullet, int32 InInventoryBulletCount);
+
+	/** Broadcasts every value once, for a listener that just bound */
+	UFUNCTION(BlueprintCallable, Category = "Status")
+	void BroadcastAll();
+
+	UPROPERTY(BlueprintAssignable, Category = "Status")
+	FOnStatusValueChanged OnHealthChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "Status")
+	FOnStatusValueChanged OnStaminaChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "Status")
+	FOnAmmoChanged OnAmmoChanged;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Status")
+	float Health;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Status")
+	float MaxHealth;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Status")
+	float Stamina;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Status")
+	float MaxStamina;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Status")
+	int32 LoadedBullet;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Status")
+	int32 InventoryBulletCount;
+
+	/** Smallest health or stamina change that is worth redrawing */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Status")
+	float QuantizationStep;
+
+private:
+
+	/** Updates Value and returns true when it moved to another step */
+	bool SetQuantized(float& Value, float& MaxValue, float NewValue, float NewMaxValue) const;
+};
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlayerStatusWidget.h"
+#include "PlayerStatusViewModel.h"
+#include "Components/InvalidationBox.h"
+
+void UPlayerStatusWidget::SetViewModel(UPlayerStatusViewModel* InViewModel)
+{
+	Unbind();
+
+	ViewModel = InViewModel;
+	if (!ViewModel)
+		return;
+
+	ViewModel->OnHealthChanged.AddDynamic(this, &UPlayerStatusWidget::HandleHealthChanged);
+	ViewModel->OnStaminaChanged.AddDynamic(this, &UPlayerStatusWidget::HandleStaminaChanged);
+	ViewModel->OnAmmoChanged.AddDynamic(this, &UPlayerStatusWidget::HandleAmmoChanged);
+
+	HandleHealthChanged(ViewModel->Health, ViewModel->MaxHealth);
+	HandleStaminaChanged(ViewModel->Stamina, ViewModel->MaxStamina);
+	HandleAmmoChanged(ViewModel->LoadedBullet, ViewModel->InventoryBulletCount);
+}
+
+void UPlayerStatusWidget::NativeConstruct()
+{
+	Super::NativeConstruct();
+
+	if (StatusInvalidationBox)
+	{
+		StatusInvalidationBox->SetCanCache(true);
+	}
+
+	//Rebind when the widget is added back to the viewport
+	if (ViewModel)
+	{
+		SetViewModel(ViewModel);
+	}
+}
+
+void UPlayerStatusWidget::NativeDestruct()
+{
+	Unbind();
+
+	Super::NativeDestruct();
+}
+
+void UPlayerStatusWidget::HandleHealthChanged(float Value, float MaxValue)
+{
+	OnHealthChanged(Value, MaxValue);
+}
+
+void UPlayerStatusWidget::HandleStaminaChanged(float Value, float MaxValue)
+{
+	OnStaminaChanged(Value, MaxValue);
+}
+
+void UPlayerStatusWidget::HandleAmmoChanged(int32 LoadedBullet, int32 InventoryBulletCount)
+{
+	OnAmmoChanged(LoadedBullet, InventoryBulletCount);
+}
+
+void UPlayerStatusWidget::Unbind()
+{
+	if (ViewModel)
+	{
+		ViewModel->OnHealthChanged.RemoveAll(this);
+		ViewModel->OnStaminaChanged.RemoveAll(this);
+		ViewModel->OnAmmoChanged.RemoveAll(this);
+	}
+}
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "PlayerStatusWidget.generated.h"
+
+class UPlayerStatusViewModel;
+
+/**
+ * Base of the player status HUD. It updates from the view-model's events instead of property bindings,
+ * and keeps its contents in StatusInvalidationBox so an idle HUD is drawn from cache.
+ */
+UCLASS()
+class CHARACTER_BR_API UPlayerStatusWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+
+	UFUNCTION(BlueprintCallable, Category = "Status")
+	void SetViewModel(UPlayerStatusViewModel* InViewModel);
+
+	UFUNCTION(BlueprintPure, Category = "Status")
+	UPlayerStatusViewModel* GetViewModel() const { return ViewModel; }
+
+protected:
+
+	virtual void NativeConstruct() override;
+
+	virtual void NativeDestruct() override;
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Status")
+	void OnHealthChanged(float Health, float MaxHealth);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Status")
+	void OnStaminaChanged(float Stamina, float MaxStamina);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Status")
+	void OnAmmoChanged(int32 LoadedBullet, int32 InventoryBulletCount);
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	class UInvalidationBox* StatusInvalidationBox;
+
+private:
+
+	UFUNCTION()
+	void HandleHealthChanged(float Value, float MaxValue);
+
+	UFUNCTION()
+	void HandleStaminaChanged(float Value, float MaxValue);
+
+	UFUNCTION()
+	void HandleAmmoChanged(int32 LoadedBullet, int32 InventoryBulletCount);
+
+	void Unbind();
+
+	UPROPERTY(Transient)
+	UPlayerStatusViewModel* ViewModel;
+};
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "PoolableActor.generated.h"
+
+UINTERFACE(MinimalAPI, Blueprintable)
+class UPoolableActor : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Optional hooks for actors handed out by UActorPoolSubsystem.
+ * The pool already hides the actor, disables its collision and tick and detaches it;
+ * implement these to reset gameplay state of your own.
+ */
+class CHARACTER_BR_API IPoolableActor
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Called after the actor was placed at its new transform and made visible again */
+	UFUNCTION(BlueprintNativeEvent, Category = "Pool")
+	void OnAcquiredFromPool();
+
+	/** Called before the actor is hidden and put back into the pool */
+	UFUNCTION(BlueprintNativeEvent, Category = "Pool")
+	void OnReleasedToPool();
+};
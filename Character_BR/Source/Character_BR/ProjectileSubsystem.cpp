@@ -0,0 +1,253 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ProjectileSubsystem.h"
+#include "CharacterBRStats.h"
+#include "Character_BR.h"
+#include "ProjectileTracerActor.h"
+#include "Weapon.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+
+UProjectileSubsystem::UProjectileSubsystem()
+{
+	TracerMesh = TSoftObjectPtr<UStaticMesh>(FSoftObjectPath(TEXT("/Engine/BasicShapes/Cylinder.Cylinder")));
+	TracerLength = 150.f;
+	TracerWidth = 1.5f;
+	TracerActor = nullptr;
+}
+
+void UProjectileSubsystem::Deinitialize()
+{
+	PositionX.Reset(); PositionY.Reset(); PositionZ.Reset();
+	VelocityX.Reset(); VelocityY.Reset(); VelocityZ.Reset();
+	PreviousX.Reset(); PreviousY.Reset(); PreviousZ.Reset();
+	Drag.Reset();
+	Lifetime.Reset();
+	Damage.Reset();
+	Shooters.Reset();
+	Weapons.Reset();
+	Handles.Reset();
+	Dead.Reset();
+	Records.Reset();
+	TracerTransforms.Reset();
+	TracerActor = nullptr;
+
+	Super::Deinitialize();
+}
+
+void UProjectileSubsystem::Fire(AActor* Shooter, AWeapon* Weapon, const FVector& Start, const FVector& Velocity, float InDamage, float InDrag, float InLifetime)
+{
+	PositionX.Add(Start.X); PositionY.Add(Start.Y); PositionZ.Add(Start.Z);
+	VelocityX.Add(Velocity.X); VelocityY.Add(Velocity.Y); VelocityZ.Add(Velocity.Z);
+	PreviousX.Add(Start.X); PreviousY.Add(Start.Y); PreviousZ.Add(Start.Z);
+	Drag.Add(InDrag);
+	Lifetime.Add(InLifetime);
+	Damage.Add(InDamage);
+	Shooters.Add(Shooter);
+	Weapons.Add(Weapon);
+	Handles.AddDefaulted();
+	Dead.Add(false);
+}
+
+void UProjectileSubsystem::Tick(float DeltaTime)
+{
+	CHARACTERBR_SCOPE(ProjectileTick);
+
+	ReadBackHits();
+	RemoveDeadRounds();
+	Integrate(DeltaTime);
+	TraceSegments();
+	UpdateTracers();
+}
+
+void UProjectileSubsystem::ReadBackHits()
+{
+	UWorld* World = GetWorld();
+
+	Records.Reset();
+
+	for (int32 Index = 0; Index < Handles.Num(); ++Index)
+	{
+		if (!Handles[Index].IsValid())
+			continue;
+
+		FHitResult Hit;
+		bool bHit = false;
+
+		FTraceDatum Datum;
+		if (World->QueryTraceData(Handles[Index], Datum))
+		{
+			bHit = Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit;
+			if (bHit)
+			{
+				Hit = Datum.OutHits[0];
+			}
+		}
+		else
+		{
+			//The async batch missed this segment, sweep it now rather than let the round pass through.
+			//Integrate hasn't run yet, so the arrays still hold last frame's segment
+			CHARACTERBR_COUNT(RoundTrace, 1);
+			bHit = World->LineTraceSingleByChannel(Hit,
+				FVector(PreviousX[Index], PreviousY[Index], PreviousZ[Index]),
+				FVector(PositionX[Index], PositionY[Index], PositionZ[Index]),
+				COLLISION_WEAPON, MakeTraceParams(Index));
+		}
+
+		Handles[Index].Invalidate();
+
+		if (!bHit)
+			continue;
+
+		AActor* Shooter = Shooters[Index].Get();
+
+		FWeaponHitRecord& Record = Records.AddDefaulted_GetRef();
+		Record.Shooter = Shooter;
+		Record.Weapon = Weapons[Index].Get();
+		Record.HitActor = Hit.GetActor();
+		Record.TraceStart = Hit.TraceStart;
+		Record.ImpactPoint = Hit.ImpactPoint;
+		Record.ImpactNormal = Hit.ImpactNormal;
+		Record.BoneName = Hit.BoneName;
+		Record.Damage = Damage[Index];
+		Record.bAuthoritative = Shooter && Shooter->HasAuthority();
+
+		UHitscanSubsystem::ApplyHitDamage(Record, Hit);
+
+		Dead[Index] = true;
+	}
+
+	if (Records.Num() > 0)
+	{
+		OnHitsResolved.Broadcast(Records);
+	}
+}
+
+void UProjectileSubsystem::RemoveDeadRounds()
+{
+	for (int32 Index = Dead.Num() - 1; Index >= 0; --Index)
+	{
+		if (Dead[Index] || Lifetime[Index] <= 0.f)
+		{
+			RemoveAt(Index);
+		}
+	}
+}
+
+void UProjectileSubsystem::Integrate(float DeltaTime)
+{
+	const int32 Count = PositionX.Num();
+	const float GravityStep = GetWorld()->GetGravityZ() * DeltaTime;
+
+	float* RESTRICT PX = PositionX.GetData();
+	float* RESTRICT PY = PositionY.GetData();
+	float* RESTRICT PZ = PositionZ.GetData();
+	float* RESTRICT VX = VelocityX.GetData();
+	float* RESTRICT VY = VelocityY.GetData();
+	float* RESTRICT VZ = VelocityZ.GetData();
+	float* RESTRICT LX = PreviousX.GetData();
+	float* RESTRICT LY = PreviousY.GetData();
+	float* RESTRICT LZ = PreviousZ.GetData();
+	const float* RESTRICT D = Drag.GetData();
+	float* RESTRICT L = Lifetime.GetData();
+
+	//Straight loop over packed floats without branches, so the compiler can vectorize it
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		LX[Index] = PX[Index];
+		LY[Index] = PY[Index];
+		LZ[Index] = PZ[Index];
+
+		const float Speed = FMath::Sqrt(VX[Index] * VX[Index] + VY[Index] * VY[Index] + VZ[Index] * VZ[Index]);
+		const float DragScale = FMath::Max(1.f - D[Index] * Speed * DeltaTime, 0.f);
+
+		VX[Index] *= DragScale;
+		VY[Index] *= DragScale;
+		VZ[Index] = VZ[Index] * DragScale + GravityStep;
+
+		PX[Index] += VX[Index] * DeltaTime;
+		PY[Index] += VY[Index] * DeltaTime;
+		PZ[Index] += VZ[Index] * DeltaTime;
+
+		L[Index] -= DeltaTime;
+	}
+}
+
+void UProjectileSubsystem::TraceSegments()
+{
+	UWorld* World = GetWorld();
+
+	CHARACTERBR_COUNT(RoundTrace, PositionX.Num());
+	for (int32 Index = 0; Index < PositionX.Num(); ++Index)
+	{
+		Handles[Index] = World->AsyncLineTraceByChannel(EAsyncTraceType::Single,
+			FVector(PreviousX[Index], PreviousY[Index], PreviousZ[Index]),
+			FVector(PositionX[Index], PositionY[Index], PositionZ[Index]),
+			COLLISION_WEAPON, MakeTraceParams(Index));
+	}
+}
+
+FCollisionQueryParams UProjectileSubsystem::MakeTraceParams(int32 Index) const
+{
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(ProjectileSweep), true, Shooters[Index].Get());
+	TraceParams.AddIgnoredActor(Weapons[Index].Get());
+	return TraceParams;
+}
+
+void UProjectileSubsystem::UpdateTracers()
+{
+	UWorld* World = GetWorld();
+	if (World->GetNetMode() == NM_DedicatedServer)
+		return;
+
+	if (!TracerActor)
+	{
+		if (PositionX.Num() == 0)
+			return;
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		TracerActor = World->SpawnActor<AProjectileTracerActor>(SpawnParams);
+		if (!TracerActor)
+			return;
+
+		TracerActor->GetTracers()->SetStaticMesh(TracerMesh.LoadSynchronous());
+	}
+
+	const FVector Scale(TracerWidth / 100.f, TracerWidth / 100.f, TracerLength / 100.f);
+
+	TracerTransforms.Reset(PositionX.Num());
+	for (int32 Index = 0; Index < PositionX.Num(); ++Index)
+	{
+		const FVector Velocity(VelocityX[Index], VelocityY[Index], VelocityZ[Index]);
+		const FQuat Rotation = FRotationMatrix::MakeFromZ(Velocity).ToQuat();
+		TracerTransforms.Emplace(Rotation, FVector(PositionX[Index], PositionY[Index], PositionZ[Index]), Scale);
+	}
+
+	TracerActor->UpdateTracers(TracerTransforms);
+}
+
+void UProjectileSubsystem::RemoveAt(int32 Index)
+{
+	PositionX.RemoveAtSwap(Index, 1, false); PositionY.RemoveAtSwap(Index, 1, false); PositionZ.RemoveAtSwap(Index, 1, false);
+	VelocityX.RemoveAtSwap(Index, 1, false); VelocityY.RemoveAtSwap(Index, 1, false); VelocityZ.RemoveAtSwap(Index, 1, false);
+	PreviousX.RemoveAtSwap(Index, 1, false); PreviousY.RemoveAtSwap(Index, 1, false); PreviousZ.RemoveAtSwap(Index, 1, false);
+	Drag.RemoveAtSwap(Index, 1, false);
+	Lifetime.RemoveAtSwap(Index, 1, false);
+	Damage.RemoveAtSwap(Index, 1, false);
+	Shooters.RemoveAtSwap(Index, 1, false);
+	Weapons.RemoveAtSwap(Index, 1, false);
+	Handles.RemoveAtSwap(Index, 1, false);
+	Dead.RemoveAtSwap(Index, 1, false);
+}
+
+bool UProjectileSubsystem::IsTickable() const
+{
+	return !IsTemplate() && (PositionX.Num() > 0 || (TracerActor && TracerActor->GetTracers()->GetInstanceCount() > 0));
+}
+
+TStatId UProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UProjectileSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+#include "HitscanSubsystem.h"
+#include "ProjectileSubsystem.generated.h"
+
+class AWeapon;
+class AProjectileTracerActor;
+
+/**
+ * Simulates every non-hitscan round without spawning an actor for it.
+ * Rounds live in packed arrays and are integrated in one loop per frame with gravity and quadratic drag.
+ * Each frame's swept segments are sent as one batch of async traces and read back the next frame.
+ * Tracers are drawn as instances of TracerMesh on a single AProjectileTracerActor.
+ */
+UCLASS(Config = Game)
+class CHARACTER_BR_API UProjectileSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UProjectileSubsystem();
+
+	virtual void Deinitialize() override;
+
+	/**
+	 * Adds a round.
+	 * @param Drag	quadratic drag coefficient, speed lost per second is Drag * Speed^2
+	 */
+	void Fire(AActor* Shooter, AWeapon* Weapon, const FVector& Start, const FVector& Velocity, float Damage, float Drag, float Lifetime);
+
+	FORCEINLINE int32 Num() const { return PositionX.Num(); }
+
+	UPROPERTY(BlueprintAssignable, Category = "Projectile")
+	FOnWeaponHitsResolved OnHitsResolved;
+
+	/** Mesh drawn for each tracer, stretched along the velocity. Expected to be 100 units long on Z. */
+	UPROPERTY(Config)
+	TSoftObjectPtr<class UStaticMesh> TracerMesh;
+
+	UPROPERTY(Config)
+	float TracerLength;
+
+	UPROPERTY(Config)
+	float TracerWidth;
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+private:
+
+	void ReadBackHits();
+
+	void RemoveDeadRounds();
+
+	void Integrate(float DeltaTime);
+
+	void TraceSegments();
+
+	/** Ignores the round's shooter and weapon */
+	FCollisionQueryParams MakeTraceParams(int32 Index) const;
+
+	void UpdateTracers();
+
+	void RemoveAt(int32 Index);
+
+	TArray<float> PositionX;
+	TArray<float> PositionY;
+	TArray<float> PositionZ;
+
+	TArray<float> VelocityX;
+	TArray<float> VelocityY;
+	TArray<float> VelocityZ;
+
+	/** Position at the start of the frame, the swept segment runs from here */
+	TArray<float> PreviousX;
+	TArray<float> PreviousY;
+	TArray<float> PreviousZ;
+
+	TArray<float> Drag;
+	TArray<float> Lifetime;
+	TArray<float> Damage;
+
+	TArray<TWeakObjectPtr<AActor>> Shooters;
+	TArray<TWeakObjectPtr<AWeapon>> Weapons;
+	TArray<FTraceHandle> Handles;
+
+	/** Set when a round hit something or ran out of lifetime */
+	TArray<bool> Dead;
+
+	UPROPERTY(Transient)
+	TArray<FWeaponHitRecord> Records;
+
+	UPROPERTY(Transient)
+	AProjectileTracerActor* TracerActor;
+
+	TArray<FTransform> TracerTransforms;
+};
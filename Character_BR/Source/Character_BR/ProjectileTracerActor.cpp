@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ProjectileTracerActor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+
+AProjectileTracerActor::AProjectileTracerActor()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	SetCanBeDamaged(false);
+
+	Tracers = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Tracers"));
+	Tracers->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Tracers->SetGenerateOverlapEvents(false);
+	Tracers->CastShadow = false;
+	Tracers->SetMobility(EComponentMobility::Movable);
+	RootComponent = Tracers;
+}
+
+void AProjectileTracerActor::UpdateTracers(const TArray<FTransform>& Transforms)
+{
+	const int32 Count = Transforms.Num();
+
+	//One removal for all the expired tracers, removing them one by one rebuilds the instance data each time
+	const int32 InstanceCount = Tracers->GetInstanceCount();
+	if (InstanceCount > Count)
+	{
+		TArray<int32> Removed;
+		Removed.Reserve(InstanceCount - Count);
+		for (int32 Index = Count; Index < InstanceCount; ++Index)
+		{
+			Removed.Add(Index);
+		}
+		Tracers->RemoveInstances(Removed);
+	}
+
+	while (Tracers->GetInstanceCount() < Count)
+	{
+		Tracers->AddInstanceWorldSpace(Transforms[Tracers->GetInstanceCount()]);
+	}
+
+	if (Count > 0)
+	{
+		Tracers->BatchUpdateInstancesTransforms(0, Transforms, true, true, true);
+	}
+	else
+	{
+		Tracers->MarkRenderStateDirty();
+	}
+}
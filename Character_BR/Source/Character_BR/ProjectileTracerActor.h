@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ProjectileTracerActor.generated.h"
+
+/** Draws the tracers of every in-flight projectile as instances of one mesh, owned by UProjectileSubsystem */
+UCLASS(NotPlaceable, Transient)
+class CHARACTER_BR_API AProjectileTracerActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	AProjectileTracerActor();
+
+	/** Resizes the instance list to Transforms and moves every instance in one render update */
+	void UpdateTracers(const TArray<FTransform>& Transforms);
+
+	FORCEINLINE class UInstancedStaticMeshComponent* GetTracers() const { return Tracers; }
+
+private:
+
+	UPROPERTY(VisibleAnywhere, Category = "Tracer")
+	class UInstancedStaticMeshComponent* Tracers;
+};
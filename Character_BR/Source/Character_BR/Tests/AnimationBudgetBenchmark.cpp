@@ -0,0 +1,173 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "IAnimationBudgetAllocator.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "PlayerCharacter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace AnimationBudgetBenchmark
+{
+	/** The character CharacterBenchmarkGameMode spawns */
+	static const TCHAR* CharacterClassPath = TEXT("/Game/Character/MyPlayerCharacter_BP_2021-04-13-13-44-47.MyPlayerCharacter_BP_C");
+
+	static const int32 CharactersPerTier = 50;
+	static const int32 WarmUpFrames = 30;
+	static const int32 NumFrames = 300;
+	static const float DeltaTime = 1.f / 60.f;
+
+	/**
+	 * Nothing is rendered headless, so on-screen tiers tick even if not rendered and the off-screen one ticks only when rendered,
+	 * as UAnimationBudgetSubsystem::ConfigureCharacterMesh sets up other players on a client
+	 */
+	struct FTier
+	{
+		const TCHAR* Name;
+		float Significance;
+		bool bNeverSkip;
+		bool bOnScreen;
+	};
+
+	static const FTier Tiers[] =
+	{
+		{ TEXT("Near"), 1.f, true, true },
+		{ TEXT("Mid"), 0.5f, false, true },
+		{ TEXT("Far"), 0.1f, false, true },
+		{ TEXT("Off-screen"), 0.05f, false, false },
+	};
+
+	static const int32 NumTiers = UE_ARRAY_COUNT(Tiers);
+
+	struct FResult
+	{
+		double TickMs = 0.0;
+		int32 Characters = 0;
+		int64 PoseTicks[NumTiers] = {};
+	};
+
+	/** Average World->Tick and pose ticks per tier with CharactersPerTier characters in every tier */
+	static FResult Measure(UClass* CharacterClass, bool bBudget)
+	{
+		UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+		World->InitializeActorsForPlay(FURL());
+		World->BeginPlay();
+
+		IAnimationBudgetAllocator* Allocator = IAnimationBudgetAllocator::Get(World);
+		if (Allocator)
+		{
+			Allocator->SetEnabled(bBudget);
+		}
+
+		const int32 NumCharacters = CharactersPerTier * NumTiers;
+		const int32 Columns = FMath::CeilToInt(FMath::Sqrt((float)NumCharacters));
+		const float Spacing = 400.f;
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		//No controllers, like other players' characters seen by a client
+		FResult Result;
+		TArray<USkeletalMeshComponentBudgeted*> Meshes[NumTiers];
+		for (int32 Index = 0; Index < NumCharacters; ++Index)
+		{
+			const FVector Location((Index / Columns) * Spacing, (Index % Columns) * Spacing, 0.f);
+			APlayerCharacter* Character = World->SpawnActor<APlayerCharacter>(CharacterClass, Location, FRotator::ZeroRotator, SpawnParams);
+			USkeletalMeshComponentBudgeted* Mesh = Character ? Cast<USkeletalMeshComponentBudgeted>(Character->GetMesh()) : nullptr;
+			if (!Mesh)
+				continue;
+
+			const int32 TierIndex = Index % NumTiers;
+			const FTier& Tier = Tiers[TierIndex];
+			Meshes[TierIndex].Add(Mesh);
+			++Result.Characters;
+
+			//The tier stands in for what UAnimationBudgetSubsystem::CalculateSignificance would give at that distance
+			Mesh->SetAutoCalculateSignificance(false);
+			Mesh->VisibilityBasedAnimTickOption = Tier.bOnScreen ? EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones : EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+			if (Allocator)
+			{
+				Allocator->SetComponentSignificance(Mesh, Tier.Significance, Tier.bNeverSkip, Tier.bOnScreen);
+			}
+		}
+
+		for (int32 Frame = 0; Frame < WarmUpFrames + NumFrames; ++Frame)
+		{
+			//The budget and the pose tick count engine frames
+			++GFrameCounter;
+
+			const double StartTime = FPlatformTime::Seconds();
+			World->Tick(LEVELTICK_All, DeltaTime);
+			if (Frame < WarmUpFrames)
+				continue;
+
+			Result.TickMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+			for (int32 TierIndex = 0; TierIndex < NumTiers; ++TierIndex)
+			{
+				for (const USkeletalMeshComponentBudgeted* Mesh : Meshes[TierIndex])
+				{
+					Result.PoseTicks[TierIndex] += Mesh->PoseTickedThisFrame() ? 1 : 0;
+				}
+			}
+		}
+		Result.TickMs /= NumFrames;
+
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+
+		return Result;
+	}
+}
+
+/**
+ * Spawns 50 characters in each of four significance tiers, runs them with the animation budget off and on,
+ * and reports the update rate and animation time of every tier in the log.
+ * A tier's time is its pose ticks at the cost of one pose tick measured with the budget off.
+ * Runs headless: UE4Editor-Cmd Character_BR.uproject -nullrhi -unattended -ExecCmds="Automation RunTests Character_BR.Animation.BudgetBenchmark; Quit"
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAnimationBudgetBenchmark, "Character_BR.Animation.BudgetBenchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FAnimationBudgetBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace AnimationBudgetBenchmark;
+
+	UClass* CharacterClass = LoadClass<APlayerCharacter>(nullptr, CharacterClassPath);
+	if (!TestNotNull(TEXT("Character class"), CharacterClass))
+		return false;
+
+	const FResult Full = Measure(CharacterClass, false);
+	const FResult Budgeted = Measure(CharacterClass, true);
+
+	TestEqual(TEXT("Characters spawned"), Budgeted.Characters, CharactersPerTier * NumTiers);
+
+	int64 FullPoseTicks = 0;
+	for (int32 TierIndex = 0; TierIndex < NumTiers; ++TierIndex)
+	{
+		FullPoseTicks += Full.PoseTicks[TierIndex];
+	}
+	const double PoseTickMs = FullPoseTicks > 0 ? Full.TickMs * NumFrames / FullPoseTicks : 0.0;
+
+	AddInfo(FString::Printf(TEXT("%d characters: %.3f ms per frame without the budget, %.3f ms per frame with it, %.4f ms per pose tick"),
+		Budgeted.Characters, Full.TickMs, Budgeted.TickMs, PoseTickMs));
+
+	for (int32 TierIndex = 0; TierIndex < NumTiers; ++TierIndex)
+	{
+		const FTier& Tier = Tiers[TierIndex];
+		const double UpdateRate = (double)Budgeted.PoseTicks[TierIndex] / (CharactersPerTier * (double)NumFrames);
+
+		AddInfo(FString::Printf(TEXT("%s (significance %.2f): updated %.0f%% of frames, %.3f ms per frame, %.3f ms without the budget"),
+			Tier.Name, Tier.Significance, UpdateRate * 100.0, Budgeted.PoseTicks[TierIndex] * PoseTickMs / NumFrames, Full.PoseTicks[TierIndex] * PoseTickMs / NumFrames));
+	}
+
+	//Never skipped meshes keep their full rate whatever the budget
+	TestEqual(TEXT("Near tier updates every frame"), Budgeted.PoseTicks[0], (int64)CharactersPerTier * NumFrames);
+
+	return true;
+}
+
+#endif
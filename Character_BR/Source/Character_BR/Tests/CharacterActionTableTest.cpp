@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "CharacterActionTable.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace CharacterActionTableTest
+{
+	static const TCHAR* ActionNames[] = { TEXT("Sprint"), TEXT("Climb"), TEXT("Dodge"), TEXT("Aim"), TEXT("Fire"), TEXT("Reload"), TEXT("Equip"), TEXT("UnEquip"), TEXT("SwitchCamera") };
+	static_assert(UE_ARRAY_COUNT(ActionNames) == CharacterActionTable::NumActions, "A name for every action");
+}
+
+/** Every state and action against the conditions that block it, and the transitions the old checks made */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCharacterActionTableTest, "Character_BR.Actions.Table", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCharacterActionTableTest::RunTest(const FString& Parameters)
+{
+	using namespace ECharacterCondition;
+
+	for (uint32 State = 0; State < CharacterActionTable::NumStates; ++State)
+	{
+		for (uint32 Action = 0; Action < CharacterActionTable::NumActions; ++Action)
+		{
+			const bool bExpected = (State & CharacterActionTable::BlockedBy[Action]) == 0;
+			if (CharacterActionTable::CanPerform(State, (ECharacterAction)Action) != bExpected)
+			{
+				AddError(FString::Printf(TEXT("%s in state 0x%03x should be %s"), CharacterActionTableTest::ActionNames[Action], State, bExpected ? TEXT("allowed") : TEXT("blocked")));
+			}
+		}
+	}
+
+	struct FCase
+	{
+		uint16 State;
+		ECharacterAction Action;
+		bool bAllowed;
+	};
+
+	const FCase Cases[] =
+	{
+		{ 0, ECharacterAction::Climb, true },
+		{ Armed, ECharacterAction::Climb, false },
+		{ Armed | Jumping, ECharacterAction::Fire, true },
+		{ Armed | Reloading, ECharacterAction::Fire, false },
+		{ Armed | Reloading, ECharacterAction::Reload, false },
+		{ Armed | Swimming, ECharacterAction::Reload, true },
+		{ Armed | Jumping, ECharacterAction::Reload, false },
+		{ Armed | Falling, ECharacterAction::Reload, false },
+		{ Armed | Aiming, ECharacterAction::Equip, false },
+		{ Armed | Equipping, ECharacterAction::UnEquip, false },
+		{ Armed | Firing, ECharacterAction::Equip, true },
+		{ Armed | Equipping, ECharacterAction::Aim, false },
+		{ Aiming, ECharacterAction::Sprint, false },
+		{ Falling, ECharacterAction::Dodge, false },
+		{ Jumping, ECharacterAction::Dodge, true },
+		{ Dodging, ECharacterAction::Climb, false },
+		{ Firing, ECharacterAction::SwitchCamera, false },
+		{ Swimming | Armed, ECharacterAction::SwitchCamera, true },
+	};
+
+	for (const FCase& Case : Cases)
+	{
+		TestEqual(FString::Printf(TEXT("%s in state 0x%03x"), CharacterActionTableTest::ActionNames[(uint32)Case.Action], Case.State),
+			CharacterActionTable::CanPerform(Case.State, Case.Action), Case.bAllowed);
+	}
+
+	//Bits above the table wrap instead of reading past it
+	TestEqual(TEXT("Unknown condition bits are ignored"), CharacterActionTable::CanPerform(1 << NumBits, ECharacterAction::Equip), true);
+
+	return true;
+}
+
+/** Cost of a permission check, reported in the log */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCharacterActionTableBenchmark, "Character_BR.Actions.TableBenchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FCharacterActionTableBenchmark::RunTest(const FString& Parameters)
+{
+	const int32 NumChecks = 10000000;
+
+	FRandomStream Random(1);
+	TArray<uint16> States;
+	States.SetNumUninitialized(4096);
+	for (uint16& State : States)
+	{
+		State = (uint16)Random.RandHelper(CharacterActionTable::NumStates);
+	}
+
+	int32 Allowed = 0;
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Check = 0; Check < NumChecks; ++Check)
+	{
+		Allowed += CharacterActionTable::CanPerform(States[Check & 4095], (ECharacterAction)(Check % CharacterActionTable::NumActions)) ? 1 : 0;
+	}
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+	AddInfo(FString::Printf(TEXT("%d checks in %.2f ms, %.2f ns per check, %d allowed"), NumChecks, Seconds * 1000.0, Seconds * 1e9 / NumChecks, Allowed));
+	return true;
+}
+
+#endif
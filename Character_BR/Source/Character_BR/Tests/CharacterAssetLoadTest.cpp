@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "PlayerCharacter.h"
+#include "Weapon.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Loads the character and weapon Blueprints and reports how long each takes.
+ * Their montages and sounds are soft references and must not come in with the class.
+ * Runs headless: UE4Editor-Cmd Character_BR.uproject -nullrhi -unattended -ExecCmds="Automation RunTests Character_BR.Loading; Quit"
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCharacterAssetLoadTest, "Character_BR.Loading.CharacterAssets", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCharacterAssetLoadTest::RunTest(const FString& Parameters)
+{
+	static const TCHAR* ClassPaths[] =
+	{
+		TEXT("/Game/Character/MyPlayerCharacter_BP_2021-04-13-13-44-47.MyPlayerCharacter_BP_C"),
+		TEXT("/Game/Character/Weapon/AR/AR_Weapon_BP.AR_Weapon_BP_C"),
+		TEXT("/Game/Character/Weapon/HG/HG_Weapon_BP.HG_Weapon_BP_C"),
+	};
+
+	for (const TCHAR* Path : ClassPaths)
+	{
+		const FSoftClassPath ClassPath(Path);
+
+		//Timing and the soft reference check only mean something for a cold load
+		const bool bWasLoaded = ClassPath.ResolveClass() != nullptr;
+
+		const double StartTime = FPlatformTime::Seconds();
+		UClass* Class = ClassPath.TryLoadClass<AActor>();
+		const double LoadMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		if (!TestNotNull(FString::Printf(TEXT("%s loads"), Path), Class))
+			continue;
+
+		AddInfo(FString::Printf(TEXT("%s: %.2f ms%s"), Path, LoadMs, bWasLoaded ? TEXT(" (already loaded)") : TEXT("")));
+
+		if (bWasLoaded)
+			continue;
+
+		TArray<FSoftObjectPath> SoftPaths;
+		if (const APlayerCharacter* Character = Cast<APlayerCharacter>(Class->GetDefaultObject()))
+		{
+			for (const FSoftObjectPath& SoftPath : { Character->RollMontage.ToSoftObjectPath(), Character->EquipAnimMonatage.ToSoftObjectPath(), Character->UnEquipAnimMonatage.ToSoftObjectPath(),
+				Character->FireAnimMontage.ToSoftObjectPath(), Character->FireHandGunAnimMontage.ToSoftObjectPath(), Character->RifleReloadingAnimMontage.ToSoftObjectPath(),
+				Character->HandGunReloadingAnimMontage.ToSoftObjectPath(), Character->OnEquipSound.ToSoftObjectPath() })
+			{
+				SoftPaths.Add(SoftPath);
+			}
+		}
+		else if (const AWeapon* Weapon = Cast<AWeapon>(Class->GetDefaultObject()))
+		{
+			Weapon->GetAssetPaths(SoftPaths);
+		}
+
+		for (const FSoftObjectPath& SoftPath : SoftPaths)
+		{
+			if (!SoftPath.IsNull())
+			{
+				TestNull(FString::Printf(TEXT("%s is not loaded with %s"), *SoftPath.ToString(), Path), SoftPath.ResolveObject());
+			}
+		}
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/Package.h"
+#include "CharacterStatusSubsystem.h"
+#include "PlayerCharacter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace CharacterStatusTest
+{
+	/** The drain APlayerCharacter::Tick used to run, one virtual call per character */
+	class FTickedCharacter
+	{
+	public:
+
+		virtual ~FTickedCharacter() {}
+
+		virtual void Tick(float DeltaTime)
+		{
+			if (PlayMovementState != APlayerMovementState::PMS_Common || IsSprinting)
+			{
+				if (PlayMovementState == APlayerMovementState::PMS_Climbing)
+				{
+					if (Stamina > 0) Stamina -= 2.5f * DeltaTime;
+					else if (Stamina <= 0) Health -= 5 * DeltaTime;
+				}
+				else if (PlayMovementState == APlayerMovementState::PMS_Dodgging)
+				{
+					if (Stamina > 0) Stamina -= 2 * DeltaTime;
+					else if (Stamina <= 0) Health -= 4 * DeltaTime;
+				}
+				else if (PlayMovementState == APlayerMovementState::PMS_Swimming)
+				{
+					if (Stamina > 0) Stamina -= 2 * DeltaTime;
+					else if (Stamina <= 0) Health -= 4 * DeltaTime;
+				}
+				else if (IsSprinting)
+				{
+					if (Stamina > 0) Stamina -= 1 * DeltaTime;
+					else if (Stamina <= 0) Health -= 2 * DeltaTime;
+				}
+			}
+		}
+
+		APlayerMovementState PlayMovementState = APlayerMovementState::PMS_Common;
+		bool IsSprinting = false;
+		float Stamina = 100.f;
+		float Health = 100.f;
+
+		/** Stands in for the rest of the actor, so characters are as far apart in memory as real ones */
+		uint8 ActorData[1024] = {};
+	};
+
+	static APlayerCharacter* NewCharacter(float Stamina)
+	{
+		APlayerCharacter* Character = NewObject<APlayerCharacter>(GetTransientPackage(), NAME_None, RF_Transient);
+		Character->Stamina = Stamina;
+		return Character;
+	}
+}
+
+/** Drain rates, health draining once stamina is empty and the swap on removal */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCharacterStatusTest, "Character_BR.Status.Drain", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FCharacterStatusTest::RunTest(const FString& Parameters)
+{
+	UCharacterStatusSubsystem* Status = NewObject<UCharacterStatusSubsystem>(GetTransientPackage());
+
+	APlayerCharacter* Sprinter = CharacterStatusTest::NewCharacter(100.f);
+	APlayerCharacter* Idle = CharacterStatusTest::NewCharacter(100.f);
+	APlayerCharacter* Exhausted = CharacterStatusTest::NewCharacter(0.f);
+
+	for (APlayerCharacter* Character : { Sprinter, Idle, Exhausted })
+	{
+		Status->Register(Character);
+	}
+	TestEqual(TEXT("Registered"), Status->Num(), 3);
+	TestEqual(TEXT("StatusIndex is the slot"), Exhausted->StatusIndex, 2);
+
+	Status->Register(Sprinter);
+	TestEqual(TEXT("Registering twice is ignored"), Status->Num(), 3);
+
+	Status->SetDrainRates(Sprinter->StatusIndex, 1.f, 2.f);
+	Status->SetDrainRates(Exhausted->StatusIndex, 2.5f, 5.f);
+	Status->Tick(2.f);
+
+	TestEqual(TEXT("Sprinter loses stamina"), Sprinter->Stamina, 98.f);
+	TestEqual(TEXT("Sprinter keeps health"), Sprinter->Health, 100.f);
+	TestEqual(TEXT("Idle keeps stamina"), Idle->Stamina, 100.f);
+	TestEqual(TEXT("Exhausted keeps no stamina"), Exhausted->Stamina, 0.f);
+	TestEqual(TEXT("Exhausted loses health"), Exhausted->Health, 90.f);
+
+	//Exhausted moves into Sprinter's slot and keeps draining
+	Status->Unregister(Sprinter);
+	TestEqual(TEXT("Removed character leaves the subsystem"), Sprinter->StatusIndex, (int32)INDEX_NONE);
+	TestEqual(TEXT("Last character moved into the freed slot"), Exhausted->StatusIndex, 0);
+
+	Status->Tick(1.f);
+	TestEqual(TEXT("Removed character no longer drains"), Sprinter->Stamina, 98.f);
+	TestEqual(TEXT("Moved character keeps its rates"), Exhausted->Health, 85.f);
+
+	Status->SetHealth(Idle->StatusIndex, 50.f);
+	TestEqual(TEXT("SetHealth reaches the character"), Idle->Health, 50.f);
+
+	Status->Unregister(Sprinter);
+	TestEqual(TEXT("Unregistering twice is ignored"), Status->Num(), 2);
+
+	Status->Deinitialize();
+	TestEqual(TEXT("Deinitialize clears the slots"), Idle->StatusIndex, (int32)INDEX_NONE);
+
+	return true;
+}
+
+/** Per-frame drain cost with 100, 1k and 10k characters, ticked one by one as before and in one pass as now, reported in the log */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCharacterStatusBenchmark, "Character_BR.Status.DrainBenchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FCharacterStatusBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace CharacterStatusTest;
+
+	const int32 NumFrames = 1000;
+	const float DeltaTime = 1.f / 60.f;
+
+	for (const int32 NumCharacters : { 100, 1000, 10000 })
+	{
+		FRandomStream Random(NumCharacters);
+
+		//Half of them idle, the rest spread over sprinting, climbing, dodging and swimming
+		TArray<TUniquePtr<FTickedCharacter>> Ticked;
+		TArray<float> Stamina;
+		TArray<float> Health;
+		TArray<float> StaminaDrain;
+		TArray<float> HealthDrain;
+		for (int32 Index = 0; Index < NumCharacters; ++Index)
+		{
+			FTickedCharacter* Character = Ticked.Add_GetRef(MakeUnique<FTickedCharacter>()).Get();
+
+			const int32 Kind = Random.RandHelper(8);
+			Character->IsSprinting = Kind == 4;
+			Character->PlayMovementState = Kind == 5 ? APlayerMovementState::PMS_Climbing : Kind == 6 ? APlayerMovementState::PMS_Dodgging
+				: Kind == 7 ? APlayerMovementState::PMS_Swimming : APlayerMovementState::PMS_Common;
+
+			Stamina.Add(Character->Stamina);
+			Health.Add(Character->Health);
+			StaminaDrain.Add(Kind == 4 ? 1.f : Kind == 5 ? 2.5f : Kind >= 6 ? 2.f : 0.f);
+			HealthDrain.Add(Kind == 4 ? 2.f : Kind == 5 ? 5.f : Kind >= 6 ? 4.f : 0.f);
+		}
+
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			for (const TUniquePtr<FTickedCharacter>& Character : Ticked)
+			{
+				Character->Tick(DeltaTime);
+			}
+		}
+		const double TickedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumFrames;
+
+		//One pass and the mirror back UCharacterStatusSubsystem::Tick does
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			UCharacterStatusSubsystem::Drain(DeltaTime, NumCharacters, Stamina.GetData(), Health.GetData(), StaminaDrain.GetData(), HealthDrain.GetData());
+
+			for (int32 Index = 0; Index < NumCharacters; ++Index)
+			{
+				if (StaminaDrain[Index] != 0.f || HealthDrain[Index] != 0.f)
+				{
+					Ticked[Index]->Stamina = Stamina[Index];
+					Ticked[Index]->Health = Health[Index];
+				}
+			}
+		}
+		const double BatchedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumFrames;
+
+		int32 Mismatches = 0;
+		for (int32 Index = 0; Index < NumCharacters; ++Index)
+		{
+			FTickedCharacter Reference = *Ticked[Index];
+			Reference.Stamina = 100.f;
+			Reference.Health = 100.f;
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				Reference.Tick(DeltaTime);
+			}
+
+			Mismatches += FMath::IsNearlyEqual(Reference.Stamina, Stamina[Index], 0.01f) && FMath::IsNearlyEqual(Reference.Health, Health[Index], 0.01f) ? 0 : 1;
+		}
+		TestEqual(FString::Printf(TEXT("%d characters drain like the ticked ones"), NumCharacters), Mismatches, 0);
+
+		AddInfo(FString::Printf(TEXT("%d characters: ticked %.4f ms per frame, batched %.4f ms per frame (%.1fx)"),
+			NumCharacters, TickedMs, BatchedMs, BatchedMs > 0.0 ? TickedMs / BatchedMs : 0.0));
+	}
+
+	return true;
+}
+
+#endif
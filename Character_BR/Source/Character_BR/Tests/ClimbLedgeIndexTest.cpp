@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/Package.h"
+#include "ClimbLedgeIndexSubsystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/** Ledge queries against boxes added straight to the index, no world or physics scene involved */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClimbLedgeIndexTest, "Character_BR.Climbing.LedgeIndex", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FClimbLedgeIndexTest::RunTest(const FString& Parameters)
+{
+	UClimbLedgeIndexSubsystem* Index = NewObject<UClimbLedgeIndexSubsystem>(GetTransientPackage());
+	TestFalse(TEXT("Empty index is not built"), Index->IsBuilt());
+
+	TArray<FClimbLedgeFace> Faces;
+
+	//A low step is walked over, not climbed
+	Index->AddBoxFaces(FBox(FVector(-50.f), FVector(50.f, 50.f, 30.f)), FTransform::Identity, Faces);
+	TestEqual(TEXT("Low box has no faces"), Faces.Num(), 0);
+
+	//A 3m block around the origin, a thin 2m wall in front of its -X side,
+	//a block rotated 45 degrees further along Y and one just across a cell border
+	Index->AddBoxFaces(FBox(FVector(-100.f, -100.f, 0.f), FVector(100.f, 100.f, 300.f)), FTransform::Identity, Faces);
+	TestEqual(TEXT("Upright box has four faces"), Faces.Num(), 4);
+	Index->AddBoxFaces(FBox(FVector(-130.f, -100.f, 0.f), FVector(-120.f, 100.f, 200.f)), FTransform::Identity, Faces);
+	Index->AddBoxFaces(FBox(FVector(-100.f, -100.f, 0.f), FVector(100.f, 100.f, 250.f)), FTransform(FRotator(0.f, 45.f, 0.f), FVector(0.f, 1000.f, 0.f)), Faces);
+	Index->AddBoxFaces(FBox(FVector(350.f, -100.f, 0.f), FVector(398.f, 100.f, 400.f)), FTransform::Identity, Faces);
+
+	Index->AddFaces(Faces);
+	TestTrue(TEXT("Index is built"), Index->IsBuilt());
+
+	struct FCase
+	{
+		const TCHAR* Name;
+		FVector Location;
+		FVector Forward;
+		float Reach;
+		float Height;
+		bool bFound;
+		float LedgeTop;
+	};
+
+	const FCase Cases[] =
+	{
+		{ TEXT("Closest wall wins"), FVector(-150.f, 0.f, 0.f), FVector::ForwardVector, 100.f, 50.f, true, 200.f },
+		{ TEXT("Taller block behind a low wall"), FVector(-150.f, 0.f, 0.f), FVector::ForwardVector, 100.f, 250.f, true, 300.f },
+		{ TEXT("Facing away"), FVector(-150.f, 0.f, 0.f), -FVector::ForwardVector, 100.f, 50.f, false, 0.f },
+		{ TEXT("Out of reach"), FVector(-150.f, 0.f, 0.f), FVector::ForwardVector, 10.f, 50.f, false, 0.f },
+		{ TEXT("Above the ledge"), FVector(-150.f, 0.f, 0.f), FVector::ForwardVector, 100.f, 350.f, false, 0.f },
+		{ TEXT("Block side"), FVector(0.f, -150.f, 0.f), FVector::RightVector, 100.f, 50.f, true, 300.f },
+		{ TEXT("Rotated block"), FVector(-200.f, 1020.f, 0.f), FVector::ForwardVector, 100.f, 50.f, true, 250.f },
+		{ TEXT("Wall in the next cell"), FVector(450.f, 0.f, 0.f), -FVector::ForwardVector, 100.f, 50.f, true, 400.f },
+		{ TEXT("Open ground"), FVector(3000.f, 3000.f, 0.f), FVector::ForwardVector, 100.f, 50.f, false, 0.f },
+	};
+
+	for (const FCase& Case : Cases)
+	{
+		float LedgeTop = 0.f;
+		const bool bFound = Index->FindLedge(Case.Location, Case.Forward, Case.Reach, Case.Height, LedgeTop);
+
+		TestEqual(Case.Name, bFound, Case.bFound);
+		if (bFound && Case.bFound)
+		{
+			TestEqual(FString::Printf(TEXT("%s ledge top"), Case.Name), LedgeTop, Case.LedgeTop, 0.01f);
+		}
+	}
+
+	return true;
+}
+
+#endif
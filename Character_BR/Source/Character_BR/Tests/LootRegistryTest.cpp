@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/Package.h"
+#include "LootRegistrySubsystem.h"
+#include "Weapon.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace LootRegistryTest
+{
+	/** Never spawned, the registry only needs the pointer and LootIndex */
+	static AWeapon* NewWeapon()
+	{
+		return NewObject<AWeapon>(GetTransientPackage(), NAME_None, RF_Transient);
+	}
+}
+
+/** Best pickup queries and the swap on removal, against weapons registered at given locations */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLootRegistryTest, "Character_BR.Loot.Registry", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FLootRegistryTest::RunTest(const FString& Parameters)
+{
+	ULootRegistrySubsystem* Registry = NewObject<ULootRegistrySubsystem>(GetTransientPackage());
+
+	AWeapon* Front = LootRegistryTest::NewWeapon();
+	AWeapon* Behind = LootRegistryTest::NewWeapon();
+	AWeapon* Side = LootRegistryTest::NewWeapon();
+	AWeapon* Far = LootRegistryTest::NewWeapon();
+	AWeapon* NextCell = LootRegistryTest::NewWeapon();
+
+	Registry->Register(Front, FVector(150.f, 0.f, 0.f));
+	Registry->Register(Behind, FVector(-120.f, 0.f, 0.f));
+	Registry->Register(Side, FVector(0.f, 120.f, 0.f));
+	Registry->Register(Far, FVector(250.f, 0.f, 0.f));
+	Registry->Register(NextCell, FVector(560.f, 0.f, 0.f));
+
+	TestEqual(TEXT("Registered"), Registry->Num(), 5);
+	TestEqual(TEXT("LootIndex is the slot"), Front->LootIndex, 0);
+
+	Registry->Register(Front, FVector(150.f, 0.f, 0.f));
+	TestEqual(TEXT("Registering twice is ignored"), Registry->Num(), 5);
+
+	const float Radius = 200.f;
+	const float MinDot = -0.2f;
+
+	TestTrue(TEXT("In front beats closer behind and to the side"), Registry->FindBestLoot(FVector::ZeroVector, FVector::ForwardVector, Radius, MinDot) == Front);
+	TestTrue(TEXT("Facing the other way"), Registry->FindBestLoot(FVector::ZeroVector, -FVector::ForwardVector, Radius, MinDot) == Behind);
+	TestTrue(TEXT("Across a cell border"), Registry->FindBestLoot(FVector(490.f, 0.f, 0.f), FVector::ForwardVector, Radius, MinDot) == NextCell);
+	TestNull(TEXT("Nothing in range"), Registry->FindBestLoot(FVector(3000.f, 0.f, 0.f), FVector::ForwardVector, Radius, MinDot));
+
+	//Front's slot is taken over by the last weapon
+	Registry->Unregister(Front);
+	TestEqual(TEXT("Removed weapon leaves the registry"), Front->LootIndex, (int32)INDEX_NONE);
+	TestEqual(TEXT("Last weapon moved into the freed slot"), NextCell->LootIndex, 0);
+	TestTrue(TEXT("Side is next best"), Registry->FindBestLoot(FVector::ZeroVector, FVector::ForwardVector, Radius, MinDot) == Side);
+	TestTrue(TEXT("Moved weapon is still found"), Registry->FindBestLoot(FVector(490.f, 0.f, 0.f), FVector::ForwardVector, Radius, MinDot) == NextCell);
+
+	Registry->Unregister(Front);
+	TestEqual(TEXT("Unregistering twice is ignored"), Registry->Num(), 4);
+
+	for (AWeapon* Weapon : { NextCell, Behind, Side, Far })
+	{
+		Registry->Unregister(Weapon);
+	}
+
+	TestEqual(TEXT("Empty"), Registry->Num(), 0);
+	TestNull(TEXT("Nothing left to find"), Registry->FindBestLoot(FVector::ZeroVector, FVector::ForwardVector, Radius, MinDot));
+
+	return true;
+}
+
+/** Register, query and unregister costs with 5k and 50k pickups spread over a 4km map, reported in the log */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLootRegistryBenchmark, "Character_BR.Loot.RegistryBenchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FLootRegistryBenchmark::RunTest(const FString& Parameters)
+{
+	const float MapSize = 400000.f;
+	const int32 NumQueries = 100000;
+
+	for (const int32 NumWeapons : { 5000, 50000 })
+	{
+		ULootRegistrySubsystem* Registry = NewObject<ULootRegistrySubsystem>(GetTransientPackage());
+		FRandomStream Random(NumWeapons);
+
+		TArray<AWeapon*> Weapons;
+		TArray<FVector> Locations;
+		Weapons.Reserve(NumWeapons);
+		Locations.Reserve(NumWeapons);
+		for (int32 Index = 0; Index < NumWeapons; ++Index)
+		{
+			Weapons.Add(LootRegistryTest::NewWeapon());
+			Locations.Add(FVector(Random.FRandRange(0.f, MapSize), Random.FRandRange(0.f, MapSize), 0.f));
+		}
+
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < NumWeapons; ++Index)
+		{
+			Registry->Register(Weapons[Index], Locations[Index]);
+		}
+		const double RegisterMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		int32 Found = 0;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Query = 0; Query < NumQueries; ++Query)
+		{
+			const FVector Location(Random.FRandRange(0.f, MapSize), Random.FRandRange(0.f, MapSize), 0.f);
+			Found += Registry->FindBestLoot(Location, Random.GetUnitVector(), 200.f, -0.2f) ? 1 : 0;
+		}
+		const double QueryMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		StartTime = FPlatformTime::Seconds();
+		for (AWeapon* Weapon : Weapons)
+		{
+			Registry->Unregister(Weapon);
+		}
+		const double UnregisterMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		TestEqual(FString::Printf(TEXT("%d weapons unregistered"), NumWeapons), Registry->Num(), 0);
+
+		AddInfo(FString::Printf(TEXT("%d weapons: register %.2f ms, query %.1f ns (%d of %d found), unregister %.2f ms"),
+			NumWeapons, RegisterMs, QueryMs * 1e6 / NumQueries, Found, NumQueries, UnregisterMs));
+	}
+
+	return true;
+}
+
+#endif
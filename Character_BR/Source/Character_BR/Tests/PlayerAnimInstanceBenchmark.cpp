@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Components/StaticMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "IAnimationBudgetAllocator.h"
+#include "PlayerAnimInstance.h"
+#include "PlayerCharacter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace PlayerAnimInstanceBenchmark
+{
+	/** The character CharacterBenchmarkGameMode spawns */
+	static const TCHAR* CharacterClassPath = TEXT("/Game/Character/MyPlayerCharacter_BP_2021-04-13-13-44-47.MyPlayerCharacter_BP_C");
+
+	static const int32 WarmUpFrames = 30;
+	static const int32 NumFrames = 300;
+	static const float DeltaTime = 1.f / 60.f;
+
+	struct FResult
+	{
+		double TickMs = 0.0;
+		int32 Characters = 0;
+		int32 NativeInstances = 0;
+	};
+
+	/** Average game thread World->Tick with NumCharacters running around a floor, every mesh updated every frame */
+	static FResult Measure(UClass* CharacterClass, int32 NumCharacters, bool bParallelAnimUpdate)
+	{
+		IConsoleVariable* ParallelAnimUpdate = IConsoleManager::Get().FindConsoleVariable(TEXT("a.ParallelAnimUpdate"));
+		const int32 PreviousParallelAnimUpdate = ParallelAnimUpdate ? ParallelAnimUpdate->GetInt() : 1;
+		if (ParallelAnimUpdate)
+		{
+			ParallelAnimUpdate->Set(bParallelAnimUpdate ? 1 : 0);
+		}
+
+		UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+		World->InitializeActorsForPlay(FURL());
+		World->BeginPlay();
+
+		//The budget would skip meshes once over its time, both runs update every mesh
+		if (IAnimationBudgetAllocator* Allocator = IAnimationBudgetAllocator::Get(World))
+		{
+			Allocator->SetEnabled(false);
+		}
+
+		const int32 Columns = FMath::CeilToInt(FMath::Sqrt((float)NumCharacters));
+		const float Spacing = 400.f;
+
+		AStaticMeshActor* Floor = World->SpawnActor<AStaticMeshActor>(FVector(Columns * Spacing * 0.5f, Columns * Spacing * 0.5f, -50.f), FRotator::ZeroRotator);
+		Floor->SetMobility(EComponentMobility::Movable);
+		Floor->GetStaticMeshComponent()->SetStaticMesh(LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube")));
+		Floor->SetActorScale3D(FVector(Columns * Spacing / 50.f, Columns * Spacing / 50.f, 1.f));
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+		FResult Result;
+		TArray<APlayerCharacter*> Characters;
+		for (int32 Index = 0; Index < NumCharacters; ++Index)
+		{
+			const FVector Location((Index / Columns) * Spacing, (Index % Columns) * Spacing, 100.f);
+			APlayerCharacter* Character = World->SpawnActor<APlayerCharacter>(CharacterClass, Location, FRotator(0.f, Index * 37.f, 0.f), SpawnParams);
+			if (!Character)
+				continue;
+
+			Character->SpawnDefaultController();
+			Characters.Add(Character);
+			Result.NativeInstances += Cast<UPlayerAnimInstance>(Character->GetMesh()->GetAnimInstance()) ? 1 : 0;
+		}
+		Result.Characters = Characters.Num();
+
+		for (int32 Frame = 0; Frame < WarmUpFrames + NumFrames; ++Frame)
+		{
+			//Every character walks a different curve, so speed, direction and aim differ
+			for (int32 Index = 0; Index < Characters.Num(); ++Index)
+			{
+				Characters[Index]->InjectAxis(TEXT("MoveForward"), 1.f);
+				Characters[Index]->InjectAxis(TEXT("MoveRight"), FMath::Sin(Frame * DeltaTime + Index));
+			}
+
+			//Meshes tick their pose once per engine frame
+			++GFrameCounter;
+
+			const double StartTime = FPlatformTime::Seconds();
+			World->Tick(LEVELTICK_All, DeltaTime);
+			if (Frame >= WarmUpFrames)
+			{
+				Result.TickMs += (FPlatformTime::Seconds() - StartTime) * 1000.0;
+			}
+		}
+		Result.TickMs /= NumFrames;
+
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+
+		if (ParallelAnimUpdate)
+		{
+			ParallelAnimUpdate->Set(PreviousParallelAnimUpdate);
+		}
+
+		return Result;
+	}
+}
+
+/**
+ * Game thread time of 50 and 100 walking characters with the anim update forced onto the game thread, as the Blueprint graph ran,
+ * and moved to the worker threads by UPlayerAnimInstance's proxy, reported in the log.
+ * Runs headless: UE4Editor-Cmd Character_BR.uproject -nullrhi -unattended -ExecCmds="Automation RunTests Character_BR.Animation.AnimInstanceBenchmark; Quit"
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayerAnimInstanceBenchmark, "Character_BR.Animation.AnimInstanceBenchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FPlayerAnimInstanceBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace PlayerAnimInstanceBenchmark;
+
+	UClass* CharacterClass = LoadClass<APlayerCharacter>(nullptr, CharacterClassPath);
+	if (!TestNotNull(TEXT("Character class"), CharacterClass))
+		return false;
+
+	for (const int32 NumCharacters : { 50, 100 })
+	{
+		const FResult GameThread = Measure(CharacterClass, NumCharacters, false);
+		const FResult Parallel = Measure(CharacterClass, NumCharacters, true);
+
+		TestEqual(FString::Printf(TEXT("%d characters spawned"), NumCharacters), Parallel.Characters, NumCharacters);
+		TestEqual(FString::Printf(TEXT("%d characters use UPlayerAnimInstance"), NumCharacters), Parallel.NativeInstances, Parallel.Characters);
+
+		AddInfo(FString::Printf(TEXT("%d characters: game thread update %.3f ms per frame, worker update %.3f ms per frame (%.3f ms saved)"),
+			NumCharacters, GameThread.TickMs, Parallel.TickMs, GameThread.TickMs - Parallel.TickMs));
+	}
+
+	return true;
+}
+
+#endif
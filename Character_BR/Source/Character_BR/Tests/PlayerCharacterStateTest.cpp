@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+#include "PlayerCharacterState.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace PlayerCharacterStateTest
+{
+	static FPlayerCharacterState RoundTrip(FPlayerCharacterState State, int64& OutNumBits)
+	{
+		bool bSuccess = false;
+
+		FBitWriter Writer(32, true);
+		State.NetSerialize(Writer, nullptr, bSuccess);
+		OutNumBits = Writer.GetNumBits();
+
+		FPlayerCharacterState Read;
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		Read.NetSerialize(Reader, nullptr, bSuccess);
+		return Read;
+	}
+}
+
+/** Every combination of flags, movement state and weapon slot comes back unchanged in 18 bits */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayerCharacterStateNetSerializeTest, "Character_BR.Network.PlayerCharacterState", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPlayerCharacterStateNetSerializeTest::RunTest(const FString& Parameters)
+{
+	const int64 ExpectedBits = FPlayerCharacterState::NumFlagBits + FPlayerCharacterState::NumMovementStateBits + FPlayerCharacterState::NumWeaponNumberBits;
+
+	int32 Mismatches = 0;
+	for (uint32 Flags = 0; Flags < (1 << FPlayerCharacterState::NumFlagBits); ++Flags)
+	{
+		for (uint8 MovementState = 0; MovementState < (1 << FPlayerCharacterState::NumMovementStateBits); ++MovementState)
+		{
+			for (uint8 WeaponNumber = 0; WeaponNumber <= 2; ++WeaponNumber)
+			{
+				FPlayerCharacterState State;
+				State.Flags = (uint16)Flags;
+				State.MovementState = MovementState;
+				State.EquippedWeaponNumber = WeaponNumber;
+
+				int64 NumBits = 0;
+				if (PlayerCharacterStateTest::RoundTrip(State, NumBits) != State || NumBits != ExpectedBits)
+				{
+					//Report the first few, not thousands
+					if (++Mismatches <= 10)
+					{
+						AddError(FString::Printf(TEXT("Flags 0x%04x, movement %d, weapon %d did not survive in %lld bits"), Flags, MovementState, WeaponNumber, NumBits));
+					}
+				}
+			}
+		}
+	}
+
+	TestEqual(TEXT("Round trip mismatches"), Mismatches, 0);
+
+	FPlayerCharacterState Named;
+	Named.SetFlag(EPlayerStateFlag::Aiming, true);
+	Named.SetFlag(EPlayerStateFlag::EquippedWeapon, true);
+	Named.SetFlag(EPlayerStateFlag::Aiming, false);
+	TestFalse(TEXT("Cleared flag"), Named.HasFlag(EPlayerStateFlag::Aiming));
+	TestTrue(TEXT("Highest flag"), Named.HasFlag(EPlayerStateFlag::EquippedWeapon));
+
+	//Values wider than their bits are cut rather than spilling into the next field
+	FPlayerCharacterState Wide;
+	Wide.Flags = 0xFFFF;
+	Wide.MovementState = 0xFF;
+	Wide.EquippedWeaponNumber = 0;
+
+	int64 NumBits = 0;
+	const FPlayerCharacterState Read = PlayerCharacterStateTest::RoundTrip(Wide, NumBits);
+	TestEqual(TEXT("Flags are cut to their bits"), (int32)Read.Flags, (1 << FPlayerCharacterState::NumFlagBits) - 1);
+	TestEqual(TEXT("Movement state is cut to its bits"), (int32)Read.MovementState, (1 << FPlayerCharacterState::NumMovementStateBits) - 1);
+	TestEqual(TEXT("Weapon number is untouched"), (int32)Read.EquippedWeaponNumber, 0);
+
+	return true;
+}
+
+#endif
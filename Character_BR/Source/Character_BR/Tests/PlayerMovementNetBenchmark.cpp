@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "PlayerCharacter.h"
+#include "PlayerCharacterMovementComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "Editor.h"
+#include "EngineUtils.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/GameMapsSettings.h"
+#include "GameFramework/PlayerController.h"
+#include "Settings/LevelEditorPlaySettings.h"
+#include "Tests/AutomationCommon.h"
+#include "Tests/AutomationEditorCommon.h"
+
+namespace PlayerMovementNetBenchmark
+{
+	static const int32 NumPlayers = 4;
+	static const float WarmUpSeconds = 5.f;
+	static const float DurationSeconds = 60.f;
+
+	/** Runs, sprints, rolls and jumps at walls, each player on its own offset so they don't move in lockstep */
+	static void DriveInput(APlayerCharacter* Character, int32 PlayerIndex, float PreviousTime, float Time)
+	{
+		const float Offset = PlayerIndex * 0.7f;
+		auto Crossed = [PreviousTime, Time, Offset](float Period, float At)
+		{
+			return FMath::FloorToInt((PreviousTime + Offset - At) / Period) != FMath::FloorToInt((Time + Offset - At) / Period);
+		};
+
+		Character->InjectAxis(TEXT("MoveForward"), 1.f);
+		Character->InjectAxis(TEXT("Turn"), FMath::Sin((Time + Offset) * 0.5f) * 0.5f);
+
+		if (Crossed(6.f, 0.f)) Character->InjectAction(TEXT("Sprint"), IE_Pressed);
+		if (Crossed(6.f, 3.f)) Character->InjectAction(TEXT("Sprint"), IE_Released);
+		if (Crossed(5.f, 1.5f)) Character->InjectAction(TEXT("Roll"), IE_Pressed);
+		if (Crossed(4.f, 2.f)) Character->InjectAction(TEXT("Jump"), IE_Pressed);
+		if (Crossed(4.f, 3.5f)) Character->InjectAction(TEXT("Jump"), IE_Released);
+	}
+
+	/** Drives every PIE player, then reports the server's corrections and the clients' upload once DurationSeconds have been measured */
+	class FMeasureCommand : public IAutomationLatentCommand
+	{
+	public:
+
+		FMeasureCommand(FAutomationTestBase* InTest)
+			: Test(InTest)
+		{
+		}
+
+		virtual bool Update() override
+		{
+			if (StartTime == 0.0)
+			{
+				StartTime = FPlatformTime::Seconds();
+			}
+
+			UWorld* ServerWorld = nullptr;
+			int32 PlayerIndex = 0;
+			const float Time = (float)(FPlatformTime::Seconds() - StartTime);
+
+			for (const FWorldContext& Context : GEngine->GetWorldContexts())
+			{
+				UWorld* World = Context.World();
+				if (Context.WorldType != EWorldType::PIE || !World)
+					continue;
+
+				if (World->GetNetMode() == NM_ListenServer)
+				{
+					ServerWorld = World;
+				}
+
+				for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+				{
+					APlayerController* Controller = It->Get();
+					APlayerCharacter* Character = Controller && Controller->IsLocalController() ? Cast<APlayerCharacter>(Controller->GetPawn()) : nullptr;
+					if (Character)
+					{
+						DriveInput(Character, PlayerIndex++, LastTime, Time);
+					}
+				}
+			}
+
+			LastTime = Time;
+
+			//Clients are still joining
+			const UNetDriver* NetDriver = ServerWorld ? ServerWorld->GetNetDriver() : nullptr;
+			if (!NetDriver || NetDriver->ClientConnections.Num() < NumPlayers - 1)
+			{
+				if (Time > 60.f)
+				{
+					Test->AddError(FString::Printf(TEXT("Only %d of %d clients joined"), NetDriver ? NetDriver->ClientConnections.Num() : 0, NumPlayers - 1));
+					return true;
+				}
+				return false;
+			}
+
+			if (MeasureStartTime < 0.f)
+			{
+				MeasureStartTime = Time + WarmUpSeconds;
+			}
+
+			if (Time < MeasureStartTime)
+			{
+				StartCorrections = CountCorrections(ServerWorld);
+				return false;
+			}
+
+			//Client to server traffic is almost only ServerMove
+			for (const UNetConnection* Connection : NetDriver->ClientConnections)
+			{
+				InBytesPerSecondSum += Connection ? Connection->InBytesPerSecond : 0;
+				OutBytesPerSecondSum += Connection ? Connection->OutBytesPerSecond : 0;
+			}
+			ConnectionSamples += NetDriver->ClientConnections.Num();
+
+			if (Time < MeasureStartTime + DurationSeconds)
+				return false;
+
+			const int32 Corrections = CountCorrections(ServerWorld) - StartCorrections;
+			const int32 Clients = NetDriver->ClientConnections.Num();
+			const float Minutes = DurationSeconds / 60.f;
+
+			Test->AddInfo(FString::Printf(TEXT("%d clients over %.0fs: %d corrections, %.1f per minute per client, upload %.0f B/s per client, download %.0f B/s per client"),
+				Clients, DurationSeconds, Corrections, Corrections / (Minutes * Clients),
+				ConnectionSamples > 0 ? InBytesPerSecondSum / ConnectionSamples : 0.0, ConnectionSamples > 0 ? OutBytesPerSecondSum / ConnectionSamples : 0.0));
+			return true;
+		}
+
+	private:
+
+		/** Remote players only, the listen server's own player is never corrected */
+		static int32 CountCorrections(UWorld* World)
+		{
+			int32 Corrections = 0;
+			for (TActorIterator<APlayerCharacter> It(World); It; ++It)
+			{
+				if (!It->IsLocallyControlled() && It->GetPlayerMovement())
+				{
+					Corrections += It->GetPlayerMovement()->NumServerCorrections;
+				}
+			}
+			return Corrections;
+		}
+
+		FAutomationTestBase* Test;
+		double StartTime = 0.0;
+		float LastTime = 0.f;
+		float MeasureStartTime = -1.f;
+		int32 StartCorrections = 0;
+		double InBytesPerSecondSum = 0.0;
+		double OutBytesPerSecondSum = 0.0;
+		int32 ConnectionSamples = 0;
+	};
+}
+
+/**
+ * Plays the default map as a listen server with three clients in one editor process, drives every player through
+ * sprints, rolls and climbs and reports corrections per minute and bandwidth per client, from the server's side.
+ * Runs from the editor: UE4Editor-Cmd Character_BR.uproject -unattended -ExecCmds="Automation RunTests Character_BR.Network.MovementBenchmark; Quit"
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayerMovementNetBenchmark, "Character_BR.Network.MovementBenchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPlayerMovementNetBenchmark::RunTest(const FString& Parameters)
+{
+	FAutomationEditorCommonUtils::LoadMap(UGameMapsSettings::GetGameDefaultMap());
+
+	ULevelEditorPlaySettings* PlaySettings = DuplicateObject(GetDefault<ULevelEditorPlaySettings>(), GetTransientPackage());
+	PlaySettings->SetPlayNetMode(EPlayNetMode::PIE_ListenServer);
+	PlaySettings->SetPlayNumberOfClients(PlayerMovementNetBenchmark::NumPlayers);
+	PlaySettings->SetRunUnderOneProcess(true);
+	PlaySettings->bLaunchSeparateServer = false;
+
+	FRequestPlaySessionParams Params;
+	Params.EditorPlaySettings = PlaySettings;
+	GEditor->RequestPlaySession(Params);
+
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForMapToLoadCommand());
+	ADD_LATENT_AUTOMATION_COMMAND(PlayerMovementNetBenchmark::FMeasureCommand(this));
+	ADD_LATENT_AUTOMATION_COMMAND(FEndPlayMapCommand());
+	return true;
+}
+
+#endif
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "ProjectileSubsystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Keeps 1k and then 10k rounds in flight in an empty game world and reports the world tick per frame,
+ * which is the projectile subsystem's integration, async sweeps and tracers.
+ * Runs headless: UE4Editor-Cmd Character_BR.uproject -nullrhi -unattended -ExecCmds="Automation RunTests Character_BR.Projectiles; Quit"
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FProjectileSubsystemBenchmark, "Character_BR.Projectiles.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FProjectileSubsystemBenchmark::RunTest(const FString& Parameters)
+{
+	const int32 NumFrames = 300;
+	const float DeltaTime = 1.f / 60.f;
+
+	for (const int32 NumRounds : { 1000, 10000 })
+	{
+		UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+		World->InitializeActorsForPlay(FURL());
+		World->BeginPlay();
+
+		UProjectileSubsystem* Projectiles = World->GetSubsystem<UProjectileSubsystem>();
+		if (!TestNotNull(TEXT("Projectile subsystem"), Projectiles))
+			return false;
+
+		FRandomStream Random(NumRounds);
+		auto FireRounds = [Projectiles, &Random](int32 Count)
+		{
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				const FVector Start(Random.FRandRange(-5000.f, 5000.f), Random.FRandRange(-5000.f, 5000.f), 1000.f);
+				const FVector Velocity = Random.VRandCone(FVector::ForwardVector, PI / 4.f) * 30000.f;
+				Projectiles->Fire(nullptr, nullptr, Start, Velocity, 25.f, 0.0001f, Random.FRandRange(1.f, 3.f));
+			}
+		};
+
+		FireRounds(NumRounds);
+
+		double TickSeconds = 0.0;
+		double MaxTickSeconds = 0.0;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			//Expired rounds are replaced, so about NumRounds stay in flight. Lifetimes differ so they don't all expire at once
+			FireRounds(NumRounds - Projectiles->Num());
+
+			const double StartTime = FPlatformTime::Seconds();
+			World->Tick(LEVELTICK_All, DeltaTime);
+			const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+			TickSeconds += Seconds;
+			MaxTickSeconds = FMath::Max(MaxTickSeconds, Seconds);
+		}
+
+		//Rounds that expired in the last tick are only removed on the next one
+		TestTrue(FString::Printf(TEXT("%d rounds in flight"), NumRounds), Projectiles->Num() > NumRounds / 2);
+
+		AddInfo(FString::Printf(TEXT("%d rounds: %.3f ms per frame avg, %.3f ms max, %.1f ns per round"),
+			NumRounds, TickSeconds * 1000.0 / NumFrames, MaxTickSeconds * 1000.0, TickSeconds * 1e9 / (NumFrames * (double)NumRounds)));
+
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "CharacterBRReplicationGraph.h"
+#include "PlayerBotController.h"
+#include "PlayerCharacter.h"
+#include "Weapon.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "Editor.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/GameMapsSettings.h"
+#include "GameFramework/GameModeBase.h"
+#include "Settings/LevelEditorPlaySettings.h"
+#include "Tests/AutomationCommon.h"
+#include "Tests/AutomationEditorCommon.h"
+
+namespace ReplicationSoakTest
+{
+	/** The character and weapon BotLoadTestGameMode spawns */
+	static const TCHAR* CharacterClassPath = TEXT("/Game/Character/MyPlayerCharacter_BP_2021-04-13-13-44-47.MyPlayerCharacter_BP_C");
+	static const TCHAR* WeaponClassPath = TEXT("/Game/Character/Weapon/AR/AR_Weapon_BP.AR_Weapon_BP_C");
+
+	static const int32 NumPlayers = 4;
+	static const int32 NumBots = 96;
+	static const float Spacing = 300.f;
+	static const float WarmUpSeconds = 10.f;
+	static const float SoakSeconds = 300.f;
+
+	/** Fills the listen server with bots once every client joined, then samples the replication graph and every connection each frame */
+	class FSoakCommand : public IAutomationLatentCommand
+	{
+	public:
+
+		FSoakCommand(FAutomationTestBase* InTest)
+			: Test(InTest)
+		{
+		}
+
+		virtual bool Update() override
+		{
+			if (StartTime == 0.0)
+			{
+				StartTime = FPlatformTime::Seconds();
+			}
+
+			const float Time = (float)(FPlatformTime::Seconds() - StartTime);
+
+			UWorld* ServerWorld = nullptr;
+			for (const FWorldContext& Context : GEngine->GetWorldContexts())
+			{
+				if (Context.WorldType == EWorldType::PIE && Context.World() && Context.World()->GetNetMode() == NM_ListenServer)
+				{
+					ServerWorld = Context.World();
+				}
+			}
+
+			//Clients are still joining
+			const UNetDriver* NetDriver = ServerWorld ? ServerWorld->GetNetDriver() : nullptr;
+			if (!NetDriver || NetDriver->ClientConnections.Num() < NumPlayers - 1)
+			{
+				if (Time > 60.f)
+				{
+					Test->AddError(FString::Printf(TEXT("Only %d of %d clients joined"), NetDriver ? NetDriver->ClientConnections.Num() : 0, NumPlayers - 1));
+					return true;
+				}
+				return false;
+			}
+
+			if (MeasureStartTime < 0.f)
+			{
+				if (!SpawnBots(ServerWorld))
+					return true;
+
+				MeasureStartTime = Time + WarmUpSeconds;
+			}
+
+			if (Time < MeasureStartTime)
+			{
+				StartMemoryMB = FPlatformMemory::GetStats().UsedPhysical / (1024.f * 1024.f);
+				return false;
+			}
+
+			const UCharacterBRReplicationGraph* ReplicationGraph = Cast<UCharacterBRReplicationGraph>(NetDriver->GetReplicationDriver());
+			if (!ReplicationGraph)
+			{
+				Test->AddError(TEXT("The server doesn't replicate through UCharacterBRReplicationGraph"));
+				return true;
+			}
+
+			NetMsSum += ReplicationGraph->LastReplicateMs;
+			NetMsMax = FMath::Max(NetMsMax, ReplicationGraph->LastReplicateMs);
+			++Frames;
+
+			for (const UNetConnection* Connection : NetDriver->ClientConnections)
+			{
+				const int32 OutBytesPerSecond = Connection ? Connection->OutBytesPerSecond : 0;
+				OutBytesPerSecondSum += OutBytesPerSecond;
+				OutBytesPerSecondMax = FMath::Max(OutBytesPerSecondMax, OutBytesPerSecond);
+			}
+			ConnectionSamples += NetDriver->ClientConnections.Num();
+
+			if (Time < MeasureStartTime + SoakSeconds)
+				return false;
+
+			const float EndMemoryMB = FPlatformMemory::GetStats().UsedPhysical / (1024.f * 1024.f);
+
+			Test->AddInfo(FString::Printf(TEXT("%d bots, %d clients over %.0fs: net tick %.3f ms avg %.3f ms max, %.0f B/s per connection avg %d B/s max, memory %+.1f MB"),
+				NumSpawned, NetDriver->ClientConnections.Num(), SoakSeconds, Frames > 0 ? NetMsSum / Frames : 0.0, NetMsMax,
+				ConnectionSamples > 0 ? OutBytesPerSecondSum / ConnectionSamples : 0.0, OutBytesPerSecondMax, EndMemoryMB - StartMemoryMB));
+			return true;
+		}
+
+	private:
+
+		/** Bots and weapons around the first player start, as BotLoadTestGameMode::SpawnBots does */
+		bool SpawnBots(UWorld* World)
+		{
+			UClass* CharacterClass = LoadClass<APlayerCharacter>(nullptr, CharacterClassPath);
+			UClass* WeaponClass = LoadClass<AWeapon>(nullptr, WeaponClassPath);
+			if (!CharacterClass)
+			{
+				Test->AddError(FString::Printf(TEXT("Can't load %s"), CharacterClassPath));
+				return false;
+			}
+
+			AGameModeBase* GameMode = World->GetAuthGameMode();
+			const AActor* Start = GameMode ? GameMode->FindPlayerStart(nullptr) : nullptr;
+			const FVector Origin = Start ? Start->GetActorLocation() : FVector::ZeroVector;
+			const int32 Columns = FMath::CeilToInt(FMath::Sqrt((float)NumBots));
+
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+			for (int32 Index = 0; Index < NumBots; ++Index)
+			{
+				const FVector Location = Origin + FVector((Index / Columns + 1) * Spacing, (Index % Columns) * Spacing, 0.f);
+
+				APlayerCharacter* Character = World->SpawnActor<APlayerCharacter>(CharacterClass, Location, FRotator::ZeroRotator, SpawnParams);
+				APlayerBotController* Bot = Character ? World->SpawnActor<APlayerBotController>(Location, FRotator::ZeroRotator, SpawnParams) : nullptr;
+				if (!Bot)
+					continue;
+
+				Bot->InitBot(Index + 1);
+				Bot->Possess(Character);
+				++NumSpawned;
+
+				if (WeaponClass)
+				{
+					World->SpawnActor<AWeapon>(WeaponClass, Location, FRotator::ZeroRotator, SpawnParams);
+				}
+			}
+
+			Test->TestEqual(TEXT("Bots spawned"), NumSpawned, NumBots);
+			return true;
+		}
+
+		FAutomationTestBase* Test;
+		double StartTime = 0.0;
+		float MeasureStartTime = -1.f;
+		int32 NumSpawned = 0;
+		float StartMemoryMB = 0.f;
+		double NetMsSum = 0.0;
+		float NetMsMax = 0.f;
+		int32 Frames = 0;
+		double OutBytesPerSecondSum = 0.0;
+		int32 OutBytesPerSecondMax = 0;
+		int32 ConnectionSamples = 0;
+	};
+}
+
+/**
+ * Plays the default map as a listen server with three clients in one editor process, adds 96 bots with a weapon each
+ * and soaks for five minutes, then reports the replication graph's net tick time, the bytes sent to every connection
+ * and the server's memory growth.
+ * Runs from the editor: UE4Editor-Cmd Character_BR.uproject -unattended -ExecCmds="Automation RunTests Character_BR.Network.ReplicationSoak; Quit"
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FReplicationSoakTest, "Character_BR.Network.ReplicationSoak", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FReplicationSoakTest::RunTest(const FString& Parameters)
+{
+	FAutomationEditorCommonUtils::LoadMap(UGameMapsSettings::GetGameDefaultMap());
+
+	ULevelEditorPlaySettings* PlaySettings = DuplicateObject(GetDefault<ULevelEditorPlaySettings>(), GetTransientPackage());
+	PlaySettings->SetPlayNetMode(EPlayNetMode::PIE_ListenServer);
+	PlaySettings->SetPlayNumberOfClients(ReplicationSoakTest::NumPlayers);
+	PlaySettings->SetRunUnderOneProcess(true);
+	PlaySettings->bLaunchSeparateServer = false;
+
+	FRequestPlaySessionParams Params;
+	Params.EditorPlaySettings = PlaySettings;
+	GEditor->RequestPlaySession(Params);
+
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForMapToLoadCommand());
+	ADD_LATENT_AUTOMATION_COMMAND(ReplicationSoakTest::FSoakCommand(this));
+	ADD_LATENT_AUTOMATION_COMMAND(FEndPlayMapCommand());
+	return true;
+}
+
+#endif
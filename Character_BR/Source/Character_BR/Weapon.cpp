@@ -10,16 +10,29 @@
 #include "PlayerCharacter.h"
 #include "Particles/ParticleSystemComponent.h"
 #include "GameFramework/Actor.h"
+#include "LootPresentationSubsystem.h"
+#include "LootRegistrySubsystem.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "Net/UnrealNetwork.h"
+
+FOnWeaponOwnerChanged AWeapon::OnWeaponOwnerChanged;
 
 AWeapon::AWeapon()
 {
-	PrimaryActorTick.bCanEverTick = true;
-	SetActorTickEnabled(true);
+	PrimaryActorTick.bCanEverTick = false;
+
+	//Pickups on the ground stay dormant until someone takes them
+	bReplicates = true;
+	SetReplicatingMovement(true);
+	NetDormancy = DORM_Initial;
 
 	SceneCompoennt = CreateDefaultSubobject<USceneComponent>(TEXT("SceneComponent"));
 	SceneCompoennt->SetupAttachment(GetRootComponent());
 
-	SkeletalMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("SkeletalMesh"));
+	//Budgeted so a carried weapon updates at the same rate as its owner
+	USkeletalMeshComponentBudgeted* BudgetedMesh = CreateDefaultSubobject<USkeletalMeshComponentBudgeted>(TEXT("SkeletalMesh"));
+	BudgetedMesh->SetAutoCalculateSignificance(true);
+	SkeletalMesh = BudgetedMesh;
 	SkeletalMesh->SetupAttachment(SceneCompoennt);
 
 	CombatCollision = CreateDefaultSubobject<UBoxComponent>(TEXT("CombatCollision"));
@@ -27,7 +40,12 @@ AWeapon::AWeapon()
 
 	WeaponState = EWeaponState::EWS_NoOwner;
 
+	bOverrideDamage = false;
 	Damage = 25.f;
+
+	bRotate = true;
+	PresentationIndex = INDEX_NONE;
+	LootIndex = INDEX_NONE;
 }
 
 void AWeapon::BeginPlay()
@@ -42,19 +60,115 @@ void AWeapon::BeginPlay()
 	CombatCollision->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
 	CombatCollision->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Overlap);
 
-	bRotate = true;
+	SetRotate(bRotate && WeaponState == EWeaponState::EWS_NoOwner);
+	SetLootAvailable(WeaponState == EWeaponState::EWS_NoOwner);
+}
+
+void AWeapon::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	SetRotate(false);
+	SetLootAvailable(false);
 
+	Super::EndPlay(EndPlayReason);
 }
 
-void AWeapon::Tick(float DeltaTime)
+void AWeapon::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
-	Super::Tick(DeltaTime);
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AWeapon, WeaponState);
+}
+
+void AWeapon::OnRep_WeaponState()
+{
+	if (WeaponState == EWeaponState::EWS_NoOwner)
+	{
+		SetRotate(GetClass()->GetDefaultObject<AWeapon>()->bRotate);
+		SetLootAvailable(true);
+	}
+	else
+	{
+		SetRotate(false);
+		SetLootAvailable(false);
+
+		SkeletalMesh->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore);
+		SkeletalMesh->SetCollisionResponseToChannel(ECollisionChannel::ECC_Pawn, ECollisionResponse::ECR_Ignore);
+		SkeletalMesh->SetSimulatePhysics(false);
+	}
+}
+
+void AWeapon::SetRotate(bool bInRotate)
+{
+	bRotate = bInRotate;
+
+	ULootPresentationSubsystem* LootPresentation = GetWorld() ? GetWorld()->GetSubsystem<ULootPresentationSubsystem>() : nullptr;
+	if (!LootPresentation)
+		return;
+
 	if (bRotate)
+		LootPresentation->Register(this);
+	else
+		LootPresentation->Unregister(this);
+}
+
+void AWeapon::SetLootAvailable(bool bAvailable)
+{
+	ULootRegistrySubsystem* LootRegistry = GetWorld() ? GetWorld()->GetSubsystem<ULootRegistrySubsystem>() : nullptr;
+	if (!LootRegistry)
+		return;
+
+	if (bAvailable)
+		LootRegistry->Register(this);
+	else
+		LootRegistry->Unregister(this);
+}
+
+//Back on the ground as a fresh pickup
+void AWeapon::OnAcquiredFromPool_Implementation()
+{
+	const AWeapon* Default = GetClass()->GetDefaultObject<AWeapon>();
+
+	WeaponState = EWeaponState::EWS_NoOwner;
+	SetInstigator(nullptr);
+
+	SkeletalMesh->SetCollisionResponseToChannels(Default->SkeletalMesh->GetCollisionResponseToChannels());
+	SkeletalMesh->SetSimulatePhysics(Default->SkeletalMesh->BodyInstance.bSimulatePhysics);
+	DeactivateCollision();
+
+	SetRotate(Default->bRotate);
+	SetLootAvailable(true);
+}
+
+void AWeapon::SetWeaponOwner(AActor* NewOwner)
+{
+	AActor* OldOwner = GetOwner();
+	if (OldOwner == NewOwner)
+		return;
+
+	SetOwner(NewOwner);
+
+	if (NewOwner)
+	{
+		SetNetDormancy(DORM_Awake);
+	}
+	else
 	{
-		FRotator Rotation = GetActorRotation();
-		Rotation.Yaw += DeltaTime * 45.f;
-		SetActorRotation(Rotation);
+		FlushNetDormancy();
+		SetNetDormancy(DORM_DormantAll);
 	}
+
+	OnWeaponOwnerChanged.Broadcast(this, OldOwner, NewOwner);
+}
+
+void AWeapon::OnReleasedToPool_Implementation()
+{
+	SetRotate(false);
+	SetLootAvailable(false);
+	SetWeaponOwner(nullptr);
+	DeactivateCollision();
+
+	WeaponState = EWeaponState::EWS_NoOwner;
+	SetInstigator(nullptr);
 }
 
 //Player Equip
@@ -62,10 +176,12 @@ void AWeapon::Equip(APlayerCharacter* Char)
 {
 	if (Char && WeaponState == EWeaponState::EWS_NoOwner)
 	{
-		bRotate = false;
+		SetRotate(false);
+		SetLootAvailable(false);
 
 		WeaponState = EWeaponState::EWS_PickUp;
 
+		SetWeaponOwner(Char);
 		SetInstigator(Char->GetController());
 
 		SkeletalMesh->SetCollisionResponseToChannel(ECollisionChannel::ECC_Camera, ECollisionResponse::ECR_Ignore);
@@ -175,5 +291,29 @@ void AWeapon::DeactivateCollision()
 
 void AWeapon::PlayFireMontage()
 {
-	SkeletalMesh->PlayAnimation(FireMontage, false);
+	SkeletalMesh->PlayAnimation(GetFireMontage(), false);
+}
+
+void AWeapon::GetAssetPaths(TArray<FSoftObjectPath>& OutPaths) const
+{
+	for (const FSoftObjectPath& Path : { FireMontage.ToSoftObjectPath(), OnEquipSound.ToSoftObjectPath(), SwingSound.ToSoftObjectPath() })
+	{
+		if (!Path.IsNull())
+			OutPaths.AddUnique(Path);
+	}
+}
+
+UAnimMontage* AWeapon::GetFireMontage() const
+{
+	return FireMontage.LoadSynchronous();
+}
+
+USoundCue* AWeapon::GetOnEquipSound() const
+{
+	return OnEquipSound.LoadSynchronous();
+}
+
+USoundCue* AWeapon::GetSwingSound() const
+{
+	return SwingSound.LoadSynchronous();
 }
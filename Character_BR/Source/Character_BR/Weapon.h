@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "PoolableActor.h"
 #include "Weapon.generated.h"
 
 UENUM(BlueprintType)
@@ -20,11 +21,18 @@ UENUM(BlueprintType)
 enum class EWeaponKind : uint8
 {
 	EWK_AssaultRifle		UMETA(DisplayName = "AssaultRifle"),
-	EWk_HandGun				UMETA(DisplayName = "HandGun")
+	EWk_HandGun				UMETA(DisplayName = "HandGun"),
+	EWK_Shotgun				UMETA(DisplayName = "Shotgun"),
+	EWK_SniperRifle			UMETA(DisplayName = "SniperRifle"),
+	EWK_RocketLauncher		UMETA(DisplayName = "RocketLauncher"),
+
+	EWK_MAX					UMETA(Hidden)
 };
 
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnWeaponOwnerChanged, class AWeapon* /*Weapon*/, AActor* /*OldOwner*/, AActor* /*NewOwner*/);
+
 UCLASS()
-class CHARACTER_BR_API AWeapon : public AActor
+class CHARACTER_BR_API AWeapon : public AActor, public IPoolableActor
 {
 	GENERATED_BODY()
 	
@@ -35,17 +43,18 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category = "SavedData")
 		FString Name;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Item")
+	/** Set by the server on pickup and equip, clients follow it in OnRep_WeaponState */
+	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, ReplicatedUsing = OnRep_WeaponState, Category = "Item")
 		EWeaponState WeaponState;
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Item")
 		EWeaponKind WeaponKind;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | Sound")
-		class USoundCue* OnEquipSound;
+		TSoftObjectPtr<class USoundCue> OnEquipSound;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | Sound")
-		USoundCue* SwingSound;
+		TSoftObjectPtr<USoundCue> SwingSound;
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "SceneComponent")
 		class USceneComponent* SceneCompoennt;
@@ -56,22 +65,56 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item | Combat")
 		class UBoxComponent* CombatCollision;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | Combat")
+	/** Uses Damage instead of the weapon definition's damage for this weapon */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | Combat", meta = (InlineEditConditionToggle))
+		bool bOverrideDamage;
+
+	/** Damage of each pellet when bOverrideDamage is set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | Combat", meta = (EditCondition = "bOverrideDamage"))
 		float Damage;
 
+	/** Idle spin while lying on the ground, driven by ULootPresentationSubsystem. Clearing it pauses the spin, SetRotate also (un)registers the weapon */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Item | ItemProperties")
 		bool bRotate;
 
+	/** Slot in ULootPresentationSubsystem, INDEX_NONE while not spinning */
+	int32 PresentationIndex;
+
+	/** Slot in ULootRegistrySubsystem, INDEX_NONE while not lying on the ground */
+	int32 LootIndex;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Animations)
-		UAnimMontage* FireMontage;
+		TSoftObjectPtr<UAnimMontage> FireMontage;
 
 protected:
 
 	void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Stops or restarts the ground presentation, the attachment replicates on its own */
+	UFUNCTION()
+	void OnRep_WeaponState();
+
 public:
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	UFUNCTION(BlueprintCallable)
+	void SetRotate(bool bInRotate);
+
+	/** Adds or removes the weapon from the pickups characters can find */
+	void SetLootAvailable(bool bAvailable);
+
+	/** Fired when a weapon is picked up or dropped, the replication graph reroutes it */
+	static FOnWeaponOwnerChanged OnWeaponOwnerChanged;
+
+	/** Sets the owner and wakes or puts the weapon back to sleep for replication */
+	void SetWeaponOwner(AActor* NewOwner);
+
+	// IPoolableActor
+	virtual void OnAcquiredFromPool_Implementation() override;
+	virtual void OnReleasedToPool_Implementation() override;
 
 	void Equip(class APlayerCharacter* Char);
 	void SetWeaponRightHand(class APlayerCharacter* Char);
@@ -79,6 +122,19 @@ public:
 
 	void PlayFireMontage();
 
+	/** Assets the carrier streams in while holding this weapon */
+	void GetAssetPaths(TArray<FSoftObjectPath>& OutPaths) const;
+
+	/** The montage and sounds for Blueprints, loaded on the spot if the carrier's preload hasn't finished */
+	UFUNCTION(BlueprintPure, Category = Animations)
+	UAnimMontage* GetFireMontage() const;
+
+	UFUNCTION(BlueprintPure, Category = "Item | Sound")
+	USoundCue* GetOnEquipSound() const;
+
+	UFUNCTION(BlueprintPure, Category = "Item | Sound")
+	USoundCue* GetSwingSound() const;
+
 	FORCEINLINE void SetWeaponState(EWeaponState State) { WeaponState = State; }
 	FORCEINLINE EWeaponState GetWaponState() { return WeaponState; }
 
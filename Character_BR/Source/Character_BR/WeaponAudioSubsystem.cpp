@@ -0,0 +1,242 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "WeaponAudioSubsystem.h"
+#include "Character_BR.h"
+#include "Components/AudioComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/WorldSettings.h"
+#include "Sound/SoundAttenuation.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+namespace WeaponAudio
+{
+	static FAutoConsoleCommandWithWorld StatsCommand(
+		TEXT("WeaponAudio.Stats"),
+		TEXT("Prints requested, played, culled and stolen weapon voices."),
+		FConsoleCommandWithWorldDelegate::CreateStatic([](UWorld* World)
+		{
+			if (UWeaponAudioSubsystem* WeaponAudio = World ? World->GetSubsystem<UWeaponAudioSubsystem>() : nullptr)
+			{
+				WeaponAudio->DumpStats();
+			}
+		}));
+}
+
+UWeaponAudioSubsystem::UWeaponAudioSubsystem()
+{
+	PoolSize = 32;
+	MaxVoices = 24;
+	MaxVoicesPerKind = 8;
+	CullDistance = 6000.f;
+	LoopBurstLength = 3;
+}
+
+void UWeaponAudioSubsystem::Deinitialize()
+{
+	for (FWeaponVoice& Voice : Voices)
+	{
+		if (Voice.Component)
+		{
+			Voice.Component->Stop();
+			Voice.Component->DestroyComponent();
+		}
+	}
+	Voices.Reset();
+
+	Super::Deinitialize();
+}
+
+FWeaponVoiceHandle UWeaponAudioSubsystem::PlayOneShot(EWeaponKind Kind, USoundBase* Sound, const FVector& Location, const AActor* Shooter)
+{
+	return Play(Kind, Sound, Location, Shooter, nullptr);
+}
+
+FWeaponVoiceHandle UWeaponAudioSubsystem::StartLoop(EWeaponKind Kind, USoundBase* Sound, USceneComponent* AttachTo, const AActor* Shooter)
+{
+	return AttachTo ? Play(Kind, Sound, AttachTo->GetComponentLocation(), Shooter, AttachTo) : FWeaponVoiceHandle();
+}
+
+void UWeaponAudioSubsystem::StopLoop(FWeaponVoiceHandle& Handle, USoundBase* EndSound, const AActor* Shooter)
+{
+	if (!Handle.IsValid())
+		return;
+
+	const FWeaponVoice& Voice = Voices[Handle.Index];
+	const bool bOwnsVoice = Voice.Serial == Handle.Serial;
+	Handle = FWeaponVoiceHandle();
+
+	//Stolen in the meantime, the voice plays someone else's sound now
+	if (!bOwnsVoice)
+		return;
+
+	const FVector Location = Voice.Component->GetComponentLocation();
+	Voice.Component->Stop();
+
+	if (EndSound)
+	{
+		PlayOneShot(Voice.Kind, EndSound, Location, Shooter);
+	}
+}
+
+bool UWeaponAudioSubsystem::UsesLoop(const FWeaponDefinition& Definition, int32 BurstLength) const
+{
+	return BurstLength >= LoopBurstLength && Definition.FireLoopSound.IsValid();
+}
+
+FWeaponAudioStats UWeaponAudioSubsystem::GetStats() const
+{
+	FWeaponAudioStats Result = Stats;
+	Result.Active = 0;
+	for (const FWeaponVoice& Voice : Voices)
+	{
+		Result.Active += Voice.Component && Voice.Component->IsPlaying() ? 1 : 0;
+	}
+	return Result;
+}
+
+void UWeaponAudioSubsystem::DumpStats() const
+{
+	const FWeaponAudioStats Current = GetStats();
+	UE_LOG(LogCharacterBR, Log, TEXT("Weapon audio: requested %d, played %d, culled %d, stolen %d, active %d of %d voices"),
+		Current.Requested, Current.Played, Current.Culled, Current.Stolen, Current.Active, Voices.Num());
+}
+
+FWeaponVoiceHandle UWeaponAudioSubsystem::Play(EWeaponKind Kind, USoundBase* Sound, const FVector& Location, const AActor* Shooter, USceneComponent* AttachTo)
+{
+	if (!Sound)
+		return FWeaponVoiceHandle();
+
+	++Stats.Requested;
+
+	float Priority;
+	const int32 Index = GetPriority(Location, Shooter, Priority) ? AcquireVoice(Kind, Priority) : INDEX_NONE;
+	if (Index == INDEX_NONE)
+	{
+		++Stats.Culled;
+		return FWeaponVoiceHandle();
+	}
+
+	FWeaponVoice& Voice = Voices[Index];
+	Voice.Priority = Priority;
+	Voice.Kind = Kind;
+	++Voice.Serial;
+
+	UAudioComponent* Component = Voice.Component;
+	if (AttachTo)
+	{
+		Component->AttachToComponent(AttachTo, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+	}
+	else
+	{
+		Component->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+		Component->SetWorldLocation(Location);
+	}
+
+	Component->SetSound(Sound);
+	Component->Play();
+	++Stats.Played;
+
+	FWeaponVoiceHandle Handle;
+	Handle.Index = Index;
+	Handle.Serial = Voice.Serial;
+	return Handle;
+}
+
+bool UWeaponAudioSubsystem::GetPriority(const FVector& Location, const AActor* Shooter, float& OutPriority) const
+{
+	float NearestSquared = MAX_flt;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (!PlayerController || !PlayerController->IsLocalController())
+			continue;
+
+		FVector ListenerLocation, FrontDir, RightDir;
+		PlayerController->GetAudioListenerPosition(ListenerLocation, FrontDir, RightDir);
+		NearestSquared = FMath::Min(NearestSquared, FVector::DistSquared(ListenerLocation, Location));
+	}
+
+	//No listener on a dedicated server, nothing to play
+	if (NearestSquared > FMath::Square(CullDistance))
+		return false;
+
+	OutPriority = 1.f - FMath::Sqrt(NearestSquared) / CullDistance;
+
+	//A local player's own weapon is never stolen by someone else's
+	const APawn* ShooterPawn = Cast<APawn>(Shooter);
+	if (ShooterPawn && ShooterPawn->IsLocallyControlled())
+	{
+		OutPriority += 1.f;
+	}
+	return true;
+}
+
+int32 UWeaponAudioSubsystem::AcquireVoice(EWeaponKind Kind, float Priority)
+{
+	int32 Free = INDEX_NONE;
+	int32 Lowest = INDEX_NONE;
+	int32 LowestOfKind = INDEX_NONE;
+	int32 Active = 0;
+	int32 ActiveOfKind = 0;
+
+	for (int32 Index = 0; Index < Voices.Num(); ++Index)
+	{
+		const FWeaponVoice& Voice = Voices[Index];
+		if (!Voice.Component->IsPlaying())
+		{
+			Free = Free == INDEX_NONE ? Index : Free;
+			continue;
+		}
+
+		++Active;
+		if (Lowest == INDEX_NONE || Voice.Priority < Voices[Lowest].Priority)
+			Lowest = Index;
+
+		if (Voice.Kind == Kind)
+		{
+			++ActiveOfKind;
+			if (LowestOfKind == INDEX_NONE || Voice.Priority < Voices[LowestOfKind].Priority)
+				LowestOfKind = Index;
+		}
+	}
+
+	const bool bKindFull = ActiveOfKind >= MaxVoicesPerKind;
+	if (!bKindFull && Active < MaxVoices)
+	{
+		if (Free != INDEX_NONE)
+			return Free;
+
+		if (Voices.Num() < PoolSize)
+			return CreateVoice();
+	}
+
+	const int32 Victim = bKindFull ? LowestOfKind : Lowest;
+	if (Victim == INDEX_NONE || Voices[Victim].Priority >= Priority)
+		return INDEX_NONE;
+
+	Voices[Victim].Component->Stop();
+	++Stats.Stolen;
+	return Victim;
+}
+
+int32 UWeaponAudioSubsystem::CreateVoice()
+{
+	UWorld* World = GetWorld();
+
+	if (!LoadedAttenuation)
+	{
+		LoadedAttenuation = Attenuation.LoadSynchronous();
+	}
+
+	UAudioComponent* Component = NewObject<UAudioComponent>(World->GetWorldSettings());
+	Component->bAutoActivate = false;
+	Component->bAutoDestroy = false;
+	Component->bAllowSpatialization = true;
+	Component->AttenuationSettings = LoadedAttenuation;
+	Component->RegisterComponentWithWorld(World);
+
+	FWeaponVoice& Voice = Voices.AddDefaulted_GetRef();
+	Voice.Component = Component;
+	return Voices.Num() - 1;
+}
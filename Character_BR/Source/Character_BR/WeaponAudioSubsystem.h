@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WeaponDefinition.h"
+#include "WeaponAudioSubsystem.generated.h"
+
+class UAudioComponent;
+
+USTRUCT(BlueprintType)
+struct FWeaponAudioStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio")
+	int32 Requested = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio")
+	int32 Played = 0;
+
+	/** Requests dropped for distance or because every voice had a higher priority */
+	UPROPERTY(BlueprintReadOnly, Category = "Audio")
+	int32 Culled = 0;
+
+	/** Voices cut short to play a request with a higher priority */
+	UPROPERTY(BlueprintReadOnly, Category = "Audio")
+	int32 Stolen = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Audio")
+	int32 Active = 0;
+};
+
+/** Identifies a voice until it is stopped or stolen */
+USTRUCT(BlueprintType)
+struct FWeaponVoiceHandle
+{
+	GENERATED_BODY()
+
+	int32 Index = INDEX_NONE;
+
+	uint32 Serial = 0;
+
+	FORCEINLINE bool IsValid() const { return Index != INDEX_NONE; }
+};
+
+USTRUCT()
+struct FWeaponVoice
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	UAudioComponent* Component = nullptr;
+
+	float Priority = 0.f;
+
+	EWeaponKind Kind = EWeaponKind::EWK_AssaultRifle;
+
+	uint32 Serial = 0;
+};
+
+/**
+ * Plays weapon sounds on a fixed pool of audio components instead of spawning one per shot.
+ * Voices are limited per weapon kind and overall; requests beyond the listeners' cull distance are dropped,
+ * and when the limit is reached the quietest voice is stolen if the new one has a higher priority.
+ * Long bursts play the looping cue of the weapon instead of one cue per shot.
+ * Use WeaponAudio.Stats to print the counters.
+ */
+UCLASS(Config = Game)
+class CHARACTER_BR_API UWeaponAudioSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UWeaponAudioSubsystem();
+
+	virtual void Deinitialize() override;
+
+	FWeaponVoiceHandle PlayOneShot(EWeaponKind Kind, USoundBase* Sound, const FVector& Location, const AActor* Shooter);
+
+	/** Starts a looping cue following AttachTo, it plays until StopLoop */
+	FWeaponVoiceHandle StartLoop(EWeaponKind Kind, USoundBase* Sound, USceneComponent* AttachTo, const AActor* Shooter);
+
+	/** Stops the loop if it still owns its voice and plays EndSound where it was */
+	void StopLoop(FWeaponVoiceHandle& Handle, USoundBase* EndSound, const AActor* Shooter);
+
+	/** True when bursts of BurstLength rounds should play the looping cue */
+	bool UsesLoop(const FWeaponDefinition& Definition, int32 BurstLength) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Audio")
+	FWeaponAudioStats GetStats() const;
+
+	void DumpStats() const;
+
+protected:
+
+	/** Audio components created at most */
+	UPROPERTY(Config)
+	int32 PoolSize;
+
+	UPROPERTY(Config)
+	int32 MaxVoices;
+
+	UPROPERTY(Config)
+	int32 MaxVoicesPerKind;
+
+	/** Requests farther than this from every listener are dropped */
+	UPROPERTY(Config)
+	float CullDistance;
+
+	/** Shortest burst that plays the looping cue */
+	UPROPERTY(Config)
+	int32 LoopBurstLength;
+
+	UPROPERTY(Config)
+	TSoftObjectPtr<class USoundAttenuation> Attenuation;
+
+private:
+
+	FWeaponVoiceHandle Play(EWeaponKind Kind, USoundBase* Sound, const FVector& Location, const AActor* Shooter, USceneComponent* AttachTo);
+
+	/** Priority from the distance to the nearest listener, false when out of range */
+	bool GetPriority(const FVector& Location, const AActor* Shooter, float& OutPriority) const;
+
+	/** A free voice, a new one, or a stolen one with a lower priority */
+	int32 AcquireVoice(EWeaponKind Kind, float Priority);
+
+	int32 CreateVoice();
+
+	UPROPERTY(Transient)
+	TArray<FWeaponVoice> Voices;
+
+	UPROPERTY(Transient)
+	USoundAttenuation* LoadedAttenuation;
+
+	FWeaponAudioStats Stats;
+};
@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "Engine/DeveloperSettings.h"
+#include "Weapon.h"
+#include "WeaponDefinition.generated.h"
+
+/** Stats, animations and sounds of one kind of weapon, a row of the weapon table */
+USTRUCT(BlueprintType)
+struct FWeaponDefinition : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon")
+	EWeaponKind WeaponKind = EWeaponKind::EWK_AssaultRifle;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Ammo")
+	int32 MagazineSize = 30;
+
+	/** Rounds fired by one trigger pull */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Fire")
+	int32 BurstCount = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Fire")
+	float RoundsPerMinute = 600.f;
+
+	/** Damage of each pellet */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Fire")
+	float Damage = 25.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Fire")
+	int32 PelletCount = 1;
+
+	/** Half angle of the pellet cone (degrees) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Fire")
+	float SpreadAngle = 0.f;
+
+	/** Reach of hitscan shots */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Fire")
+	float Range = 10000.f;
+
+	/** Speed of fired rounds, 0 fires hitscan shots */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Projectile")
+	float MuzzleSpeed = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Projectile")
+	float ProjectileDrag = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Projectile")
+	float ProjectileLifetime = 3.f;
+
+	/** Camera kick per shot */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Fire")
+	float Recoil = 0.2f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Ammo")
+	float ReloadTime = 2.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon")
+	bool bCanAim = false;
+
+	/** Fired with the trigger, and keeps the character facing the camera in third person. Cleared for weapons that are only carried */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Fire")
+	bool bCanFire = true;
+
+	/** Character montages, the character Blueprint's montages are used when empty */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Animation")
+	TSoftObjectPtr<UAnimMontage> FireMontage;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Animation")
+	TSoftObjectPtr<UAnimMontage> ReloadMontage;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Sound")
+	TSoftObjectPtr<class USoundBase> FireSound;
+
+	/** Played instead of FireSound through long bursts, FireEndSound closes it */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Sound")
+	TSoftObjectPtr<USoundBase> FireLoopSound;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Sound")
+	TSoftObjectPtr<USoundBase> FireEndSound;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Sound")
+	TSoftObjectPtr<USoundBase> ReloadSound;
+
+	FORCEINLINE float GetFireInterval() const { return 60.f / FMath::Max(RoundsPerMinute, 1.f); }
+
+	/** Montages and sounds to stream in while a weapon of this kind is carried */
+	void GetAssetPaths(TArray<FSoftObjectPath>& OutPaths) const
+	{
+		for (const FSoftObjectPath& Path : { FireMontage.ToSoftObjectPath(), ReloadMontage.ToSoftObjectPath(), FireSound.ToSoftObjectPath(),
+			FireLoopSound.ToSoftObjectPath(), FireEndSound.ToSoftObjectPath(), ReloadSound.ToSoftObjectPath() })
+		{
+			if (!Path.IsNull())
+				OutPaths.AddUnique(Path);
+		}
+	}
+};
+
+/** Project settings of the weapon definitions */
+UCLASS(Config = Game, DefaultConfig, meta = (DisplayName = "Weapons"))
+class CHARACTER_BR_API UWeaponSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Rows of FWeaponDefinition, one per weapon kind. Kinds without a row keep the built-in stats. */
+	UPROPERTY(Config, EditAnywhere, Category = "Weapons", meta = (RequiredAssetDataTags = "RowStructure=WeaponDefinition"))
+	TSoftObjectPtr<UDataTable> WeaponTable;
+};
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "WeaponDefinitionSubsystem.h"
+
+void UWeaponDefinitionSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Definitions.SetNum((int32)EWeaponKind::EWK_MAX);
+	for (int32 Kind = 0; Kind < Definitions.Num(); ++Kind)
+	{
+		Definitions[Kind].WeaponKind = (EWeaponKind)Kind;
+		InitBuiltIn(Definitions[Kind]);
+	}
+
+	const UDataTable* WeaponTable = GetDefault<UWeaponSettings>()->WeaponTable.LoadSynchronous();
+	if (!WeaponTable)
+		return;
+
+	WeaponTable->ForeachRow<FWeaponDefinition>(TEXT("UWeaponDefinitionSubsystem"), [this](const FName& Key, const FWeaponDefinition& Row)
+	{
+		if (Definitions.IsValidIndex((int32)Row.WeaponKind))
+		{
+			Definitions[(int32)Row.WeaponKind] = Row;
+		}
+	});
+}
+
+void UWeaponDefinitionSubsystem::Deinitialize()
+{
+	Definitions.Reset();
+
+	Super::Deinitialize();
+}
+
+void UWeaponDefinitionSubsystem::InitBuiltIn(FWeaponDefinition& Definition)
+{
+	auto Cue = [](const TCHAR* Name)
+	{
+		return TSoftObjectPtr<USoundBase>(FSoftObjectPath(FString::Printf(TEXT("/Game/Character/MilitaryWeapDark/Sound/%s.%s"), Name, FCString::Strrchr(Name, TEXT('/')) + 1)));
+	};
+
+	switch (Definition.WeaponKind)
+	{
+	case EWeaponKind::EWK_AssaultRifle:
+		Definition.BurstCount = 3;
+		Definition.bCanAim = true;
+		Definition.FireSound = Cue(TEXT("Rifle/RifleB_Fire_Cue"));
+		Definition.FireLoopSound = Cue(TEXT("Rifle/RifleB_FireLoop_Cue"));
+		Definition.FireEndSound = Cue(TEXT("Rifle/RifleB_FireEnd_Cue"));
+		Definition.ReloadSound = Cue(TEXT("Rifle/Rifle_Reload_Cue"));
+		break;
+	case EWeaponKind::EWk_HandGun:
+		Definition.BurstCount = 1;
+		Definition.FireSound = Cue(TEXT("Pistol/PistolB_Fire_Cue"));
+		Definition.ReloadSound = Cue(TEXT("Pistol/Pistol_ReloadInsert_Cue"));
+		break;
+	case EWeaponKind::EWK_Shotgun:
+		Definition.MagazineSize = 6;
+		Definition.RoundsPerMinute = 70.f;
+		Definition.Damage = 12.f;
+		Definition.PelletCount = 8;
+		Definition.SpreadAngle = 6.f;
+		Definition.Range = 3000.f;
+		Definition.Recoil = 0.6f;
+		Definition.ReloadTime = 3.f;
+		Definition.FireSound = Cue(TEXT("Shotgun/ShotgunB_Fire_Cue"));
+		Definition.ReloadSound = Cue(TEXT("Shotgun/Shotgun_Reload_Cue"));
+		break;
+	case EWeaponKind::EWK_SniperRifle:
+		Definition.MagazineSize = 5;
+		Definition.RoundsPerMinute = 40.f;
+		Definition.Damage = 90.f;
+		Definition.MuzzleSpeed = 90000.f;
+		Definition.ProjectileDrag = 0.000002f;
+		Definition.Recoil = 1.f;
+		Definition.ReloadTime = 3.f;
+		Definition.bCanAim = true;
+		Definition.FireSound = Cue(TEXT("SniperRifle/SniperRifleB_Fire_Cue"));
+		Definition.ReloadSound = Cue(TEXT("SniperRifle/SniperRifle_Reload_Cue"));
+		break;
+	case EWeaponKind::EWK_RocketLauncher:
+		Definition.MagazineSize = 1;
+		Definition.RoundsPerMinute = 30.f;
+		Definition.Damage = 120.f;
+		Definition.MuzzleSpeed = 4000.f;
+		Definition.ProjectileLifetime = 6.f;
+		Definition.Recoil = 0.8f;
+		Definition.ReloadTime = 3.5f;
+		Definition.FireSound = Cue(TEXT("RocketLauncher/RocketLauncherB_Fire_Cue"));
+		Definition.ReloadSound = Cue(TEXT("RocketLauncher/RocketLauncher_Reload_Cue"));
+		break;
+	default:
+		break;
+	}
+}
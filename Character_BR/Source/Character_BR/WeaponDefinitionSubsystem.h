@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "WeaponDefinition.h"
+#include "WeaponDefinitionSubsystem.generated.h"
+
+/**
+ * Resolves the weapon table once per game instance into an array indexed by EWeaponKind,
+ * so looking up the definition of a weapon is a plain array access.
+ */
+UCLASS()
+class CHARACTER_BR_API UWeaponDefinitionSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	FORCEINLINE const FWeaponDefinition& Get(EWeaponKind Kind) const { return Definitions[FMath::Min((int32)Kind, Definitions.Num() - 1)]; }
+
+	UFUNCTION(BlueprintCallable, Category = "Weapon")
+	FWeaponDefinition GetDefinition(EWeaponKind Kind) const { return Get(Kind); }
+
+private:
+
+	/** Stats the weapons had before the table existed, used for kinds without a row */
+	static void InitBuiltIn(FWeaponDefinition& Definition);
+
+	UPROPERTY(Transient)
+	TArray<FWeaponDefinition> Definitions;
+};